@@ -214,27 +214,84 @@ create trigger tr1_unnumbered_loop
   end;
 
 --
--- Associates an item with a particular loop in the scope of a given container
+-- Interns normalized data names, so that other tables can refer to them by
+-- compact integer ID instead of repeating the full name in every row and in
+-- every index.  Rows are never deleted from this table; a name that no longer
+-- belongs to any loop simply goes unreferenced.
+--
+create table item_name (
+  id integer primary key,
+  name varchar(80) not null,
+
+  unique (name)
+);
+
+--
+-- Associates an item with a particular loop in the scope of a given container.
+-- 'item_num' records the item's position among its loop's items, increasing
+-- in the order in which the items were added to the loop, so that the loop's
+-- items are presented in that order rather than in the order of their
+-- interned name IDs.  Numbers left unused by removed items are not reused.
 --
 create table loop_item (
   container_id integer not null,
-  name varchar(80) not null,
+  name_id integer not null,
   name_orig varchar(80) not null,
   loop_num integer not null,
+  item_num integer not null,
   
-  primary key (container_id, name),
+  primary key (container_id, name_id),
+  foreign key (name_id)
+    references item_name(id),
   foreign key (container_id, loop_num)
     references loop(container_id, loop_num)
     on delete cascade
 );
 
-create index ix1_loop_item
-  on loop_item (container_id, loop_num);
+--
+-- This index supports queries by loop, presenting each loop's items in order.
+--
+create unique index ix1_loop_item
+  on loop_item (container_id, loop_num, item_num);
+
+--
+-- This index serves as the parent key for item_value's loop-qualified
+-- reference to loop_item.
+--
+create unique index ix2_loop_item
+  on loop_item (container_id, loop_num, name_id);
 
 --
--- Represents a single data value; particularly, the one for item 'name' in
--- packet number 'row_num' of the appropriate loop in the container
--- identified by 'container_id'.
+-- Presents loop items with their normalized names, and provides a place to
+-- hang an "instead of" trigger that interns names as needed when loop items
+-- are inserted via this view.
+--
+create view named_loop_item as
+  select li.container_id as container_id, n.name as name, li.name_orig as name_orig, li.loop_num as loop_num
+  from loop_item li
+    join item_name n on n.id = li.name_id;
+
+create trigger tr1_named_loop_item
+  instead of insert on named_loop_item
+  begin
+    insert or ignore into item_name(name)
+      values (NEW.name);
+    insert into loop_item(container_id, name_id, name_orig, loop_num, item_num)
+      values (NEW.container_id,
+        (select id from item_name where name = NEW.name),
+        NEW.name_orig,
+        NEW.loop_num,
+        (select coalesce(max(item_num), 0) + 1 from loop_item
+          where container_id = NEW.container_id and loop_num = NEW.loop_num));
+  end;
+
+--
+-- Represents a single data value; particularly, the one for the item whose
+-- interned name is identified by 'name_id', in packet number 'row_num' of loop
+-- number 'loop_num' in the container identified by 'container_id'.  The loop
+-- number is determined by the item (via table loop_item), but it is recorded
+-- here as well so that each loop's values can be stored contiguously, in
+-- packet order.
 --
 -- The 'kind' column encodes the data type of the value:
 -- 0 = CHARACTER
@@ -243,13 +300,16 @@ create index ix1_loop_item
 -- 3 = TABLE
 -- 4 = N/A
 -- 5 = UNKNOWN
--- Only when the kind is one of the last two may 'val' be null
+-- 'val' is null for kinds 0, 4, and 5, and only for those
 --
 -- val_text records a text representation of CHARACTER and NUMBER values,
--- whereas val records a parsed value specific to the value kind: a copy of
--- the value text for kind 0, a parsed double value for kind 1, or a
--- serialized list or table for kinds 2 and 3, respectively.  Both val and
--- val_text are NULL for kinds 4 and 5.
+-- whereas val records a parsed value specific to the value kind: a parsed
+-- double value for kind 1, or a serialized list or table for kinds 2 and 3,
+-- respectively.  For kind 0, the value text is the whole value, and it is
+-- recorded only in val_text, so that long character values are not stored
+-- twice.  Queries comparing values should therefore consult val_text for
+-- kind 0 and val for kind 1.  Both val and val_text are NULL for kinds 4 and
+-- 5.
 -- 
 -- For kind 1, val_digits and su_digits record decimal digit-string
 -- representations of the value and its standard uncertainty, with the
@@ -296,14 +356,18 @@ create index ix1_loop_item
 --    perform extra joins, especially outer joins.
 -- 5. Selection predicates pertaining to the contents of list or table values
 --    do NOT need to be readily supported by this table.
+-- 6. Iterating over a loop's packets in packet order must not require sorting.
+--    The table is therefore clustered on its primary key, which orders values
+--    by loop, then by packet, then by item.
 --
 create table item_value (
   container_id integer not null,
-  name varchar(80) not null,
+  loop_num integer not null,
+  name_id integer not null,
   row_num integer not null,
   kind integer(1),
   quoted integer(1),
-  -- specific to kinds 0 - 3:
+  -- specific to kinds 1 - 3:
   val numeric,
   -- specific to kinds 0 and 1:
   val_text varchar(80),
@@ -312,16 +376,39 @@ create table item_value (
   su_digits varchar(15),
   scale integer(4),
   
-  primary key (container_id, name, row_num),
-  foreign key (container_id, name)
-    references loop_item(container_id, name)
+  primary key (container_id, loop_num, row_num, name_id),
+  foreign key (container_id, loop_num, name_id)
+    references loop_item(container_id, loop_num, name_id)
     on delete cascade,
   check (row_num > 0),
-  check (case when (val is null) then kind in (4, 5) else kind in (0, 1, 2, 3) end),
+  check (case when (val is null) then kind in (0, 4, 5) else kind in (1, 2, 3) end),
   check ((val_text is null) = (kind not in (0, 1))),
   check (case when (kind = 1) then (scale is not null)
         and (length(val_digits) > 0) and (val_digits not glob '*[^0-9]*')
         and ((su_digits is null) or ((length(su_digits) > 0) and (su_digits not glob '*[^0-9]*')))
       else (coalesce(val_digits, su_digits, scale) is null) end)
-);
+) without rowid;
+
+--
+-- This index supports queries by item name, as well as the foreign key
+-- reference to loop_item.
+--
+create index ix1_item_value
+  on item_value (container_id, name_id, loop_num);
+
+
+--
+-- Without statistics, SQLite's query planner prefers a partial range scan of
+-- item_value's primary key over a search of ix1_item_value for lookups by item
+-- name, including those performed by the foreign key's cascading deletes.  The
+-- following records nominal statistics reflecting the typical shape of CIF data
+-- (many values per loop, few per item and packet) so that each index is used
+-- for the queries it is meant to serve.
+--
+analyze;
+
+insert into sqlite_stat1 (tbl, idx, stat)
+  values ('item_value', 'item_value', '1000000 10000 1000 10 1'),
+    ('item_value', 'ix1_item_value', '1000000 10000 100 100');
 
+analyze sqlite_master;
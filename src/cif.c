@@ -27,6 +27,7 @@
 #include "internal/compat.h"
 
 #include <stddef.h>
+#include <stdlib.h>
 #include <sqlite3.h>
 
 /* For UChar: */
@@ -43,12 +44,27 @@
 
 #define INIT_STMT(cif, stmt_name) cif->stmt_name##_stmt = NULL
 
+/* schema actions for cif_open_db() */
+#define SCHEMA_INSTALL           0
+#define SCHEMA_VERIFY            1
+#define SCHEMA_VERIFY_OR_INSTALL 2
+
 static int cif_create_callback(void *context, int n_columns, char **column_texts, char **column_names);
+static int cif_open_db(const char *db_name, int open_flags, const char *setup_sql, const unsigned char *image,
+        size_t image_size, int schema_action, cif_tp **cif);
+static int load_image(sqlite3 *db, const unsigned char *image, size_t image_size);
+static int install_schema(sqlite3 *db);
+static int query_int(sqlite3 *db, const char *sql, int *value);
 static int walk_container(cif_container_tp *container, int depth, cif_handler_tp *handler, void *context);
 static int walk_loops(cif_container_tp *container, cif_handler_tp *handler, void *context);
 static int walk_loop(cif_loop_tp *loop, cif_handler_tp *handler, void *context);
 static int walk_packet(cif_packet_tp *packet, cif_handler_tp *handler, void *context);
 static int walk_item(UChar *name, cif_value_tp *value, cif_handler_tp *handler, void *context);
+static void cache_name(cif_tp *cif, int id, const UChar *name);
+static void clear_name_cache(cif_tp *cif);
+static void validate_name_cache(cif_tp *cif);
+static int create_tempfile_cif(cif_tp **cif);
+static int create_memory_cif(cif_tp **cif);
 
 
 #ifdef DEBUG
@@ -170,6 +186,59 @@ const char cif_errlist[][80] = {
 
 const int cif_nerr = (sizeof(cif_errlist) / sizeof(cif_errlist[0]));
 
+/*
+ * The storage backends available for managed CIFs, indexed by CIF_STORAGE_* code.  Entry 0, for CIF_STORAGE_DEFAULT,
+ * is never used directly.  Each backend is known by a name, by which it can be selected as the default at run time
+ * (see default_storage()), and provides a function that creates a new, empty managed CIF in its kind of storage.
+ */
+static const struct storage_backend_s {
+    const char *name;                /* the backend name recognized in the CIF_STORAGE environment variable */
+    int (*create)(cif_tp **cif);     /* creates a new managed CIF in this backend's storage */
+} storage_backends[] = {
+    /* CIF_STORAGE_DEFAULT  */ { NULL, NULL },
+    /* CIF_STORAGE_TEMPFILE */ { "tempfile", create_tempfile_cif },
+    /* CIF_STORAGE_MEMORY   */ { "memory", create_memory_cif }
+};
+
+/*
+ * Creates a managed CIF in a private, temporary SQLite database that may spill to an anonymous file
+ */
+static int create_tempfile_cif(cif_tp **cif) {
+    return cif_open_db("", SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL, NULL, 0, SCHEMA_INSTALL, cif);
+}
+
+/*
+ * Creates a managed CIF in an in-memory SQLite database whose journal and temporary storage also reside in memory
+ */
+static int create_memory_cif(cif_tp **cif) {
+    return cif_open_db(":memory:", SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, MEMORY_STORAGE_SQL, NULL, 0,
+            SCHEMA_INSTALL, cif);
+}
+
+/*
+ * Determines the backend code that CIF_STORAGE_DEFAULT stands for.  If the CIF_STORAGE environment variable names one
+ * of the backends then that backend is the default; otherwise the default is chosen at build time.
+ */
+static int default_storage(void) {
+    const char *name = getenv("CIF_STORAGE");
+
+    if (name != NULL) {
+        int storage;
+
+        for (storage = CIF_STORAGE_DEFAULT + 1; storage < (int) ARRAY_LENGTH(storage_backends); storage += 1) {
+            if (strcmp(name, storage_backends[storage].name) == 0) {
+                return storage;
+            }
+        }
+    }
+
+#ifdef SQLITE_MEMORY_ONLY
+    return CIF_STORAGE_MEMORY;
+#else
+    return CIF_STORAGE_TEMPFILE;
+#endif
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -183,14 +252,219 @@ int cif_get_api_version(char **version) {
 }
 
 int cif_create(cif_tp **cif) {
+    return cif_create_with_storage(cif, CIF_STORAGE_DEFAULT);
+}
+
+int cif_create_with_storage(cif_tp **cif, int storage) {
+    if (storage == CIF_STORAGE_DEFAULT) {
+        storage = default_storage();
+    }
+    if ((cif == NULL) || (storage < 0) || (storage >= (int) ARRAY_LENGTH(storage_backends))) {
+        return CIF_ARGUMENT_ERROR;
+    }
+
+    return storage_backends[storage].create(cif);
+}
+
+int cif_open(const char *path, int flags, cif_tp **cif) {
+    if ((path == NULL) || (cif == NULL) || ((flags & ~(CIF_OPEN_CREATE | CIF_OPEN_READONLY)) != 0)
+            || ((flags & CIF_OPEN_CREATE) && (flags & CIF_OPEN_READONLY))) {
+        return CIF_ARGUMENT_ERROR;
+    } else if (flags & CIF_OPEN_READONLY) {
+        return cif_open_db(path, SQLITE_OPEN_READONLY, NULL, NULL, 0, SCHEMA_VERIFY, cif);
+    } else if (flags & CIF_OPEN_CREATE) {
+        return cif_open_db(path, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL, NULL, 0,
+                SCHEMA_VERIFY_OR_INSTALL, cif);
+    } else {
+        return cif_open_db(path, SQLITE_OPEN_READWRITE, NULL, NULL, 0, SCHEMA_VERIFY, cif);
+    }
+}
+
+int cif_save_as(cif_tp *cif, const char *path) {
+    FAILURE_HANDLING;
+    sqlite3 *dest;
+
+    if ((cif == NULL) || (path == NULL)) {
+        return CIF_ARGUMENT_ERROR;
+    } else if (sqlite3_get_autocommit(cif->db) == 0) {
+        /* the saved copy would include uncommitted changes */
+        return CIF_MISUSE;
+    }
+
+    if (DEBUG_WRAP2(sqlite3_open_v2(path, &dest, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX,
+            NULL)) == SQLITE_OK) {
+        sqlite3_backup *backup = sqlite3_backup_init(dest, "main", cif->db, "main");
+
+        if (backup != NULL) {
+            /* copy all pages in one step; the source is not modified meanwhile */
+            int step_result = sqlite3_backup_step(backup, -1);
+
+            if ((sqlite3_backup_finish(backup) == SQLITE_OK) && (step_result == SQLITE_DONE)) {
+                SET_RESULT(CIF_OK);
+            }
+        }
+    }
+
+    /* the handle must be closed even if opening failed */
+    if (DEBUG_WRAP2(sqlite3_close(dest)) != SQLITE_OK) {
+        SET_RESULT(CIF_ERROR);
+    }
+
+    FAILURE_TERMINUS;
+}
+
+int cif_serialize(cif_tp *cif, unsigned char **bytes, size_t *length) {
+#ifndef HAVE_SQLITE3_SERIALIZE
+    return ((cif == NULL) || (bytes == NULL) || (length == NULL)) ? CIF_ARGUMENT_ERROR : CIF_NOT_SUPPORTED;
+#else
+    sqlite3_int64 size;
+    unsigned char *image;
+    unsigned char *copy;
+
+    if ((cif == NULL) || (bytes == NULL) || (length == NULL)) {
+        return CIF_ARGUMENT_ERROR;
+    } else if (sqlite3_get_autocommit(cif->db) == 0) {
+        /* the image would include uncommitted changes */
+        return CIF_MISUSE;
+    }
+
+    image = sqlite3_serialize(cif->db, "main", &size, 0);
+    if (image == NULL) {
+        return CIF_ERROR;
+    }
+
+    /* transfer the image to memory that the caller can release via free() */
+    copy = (unsigned char *) malloc((size_t) size);
+    if (copy != NULL) {
+        memcpy(copy, image, (size_t) size);
+    }
+    sqlite3_free(image);
+
+    if (copy == NULL) {
+        return CIF_MEMORY_ERROR;
+    } else {
+        *bytes = copy;
+        *length = (size_t) size;
+        return CIF_OK;
+    }
+#endif
+}
+
+int cif_deserialize(const unsigned char *bytes, size_t length, cif_tp **cif) {
+    if ((bytes == NULL) || (cif == NULL)) {
+        return CIF_ARGUMENT_ERROR;
+    }
+#ifndef HAVE_SQLITE3_SERIALIZE
+    return CIF_NOT_SUPPORTED;
+#else
+    return cif_open_db(":memory:", SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, MEMORY_STORAGE_SQL, bytes, length,
+            SCHEMA_VERIFY, cif);
+#endif
+}
+
+/*
+ * Replaces the contents of the main database of the specified connection with a copy of the specified serialized
+ * database image.  The connection thereafter owns the copy, and may grow it as the database is modified.
+ */
+static int load_image(sqlite3 *db, const unsigned char *image, size_t image_size) {
+#ifndef HAVE_SQLITE3_SERIALIZE
+    return CIF_NOT_SUPPORTED;
+#else
+    /* an empty image is allowed, and yields an empty database */
+    unsigned char *copy = (unsigned char *) sqlite3_malloc64((sqlite3_uint64) ((image_size > 0) ? image_size : 1));
+    int object_count;
+
+    if (copy == NULL) {
+        return CIF_MEMORY_ERROR;
+    }
+    memcpy(copy, image, image_size);
+
+    /* with SQLITE_DESERIALIZE_FREEONCLOSE, SQLite frees the copy even if this call fails */
+    if (DEBUG_WRAP(db, sqlite3_deserialize(db, "main", copy, (sqlite3_int64) image_size, (sqlite3_int64) image_size,
+            SQLITE_DESERIALIZE_FREEONCLOSE | SQLITE_DESERIALIZE_RESIZEABLE)) != SQLITE_OK) {
+        return CIF_ERROR;
+    }
+
+    /* reading the schema fails if the image is not a database at all */
+    return (query_int(db, COUNT_SCHEMA_OBJECTS_SQL, &object_count) == CIF_OK) ? CIF_OK : CIF_ENVIRONMENT_ERROR;
+#endif
+}
+
+/*
+ * Retrieves the integer value in the first column of the first row of the results of the specified query
+ */
+static int query_int(sqlite3 *db, const char *sql, int *value) {
+    sqlite3_stmt *stmt;
+    int result = CIF_ERROR;
+
+    if (DEBUG_WRAP(db, sqlite3_prepare_v2(db, sql, -1, &stmt, NULL)) == SQLITE_OK) {
+        if (DEBUG_WRAP(db, sqlite3_step(stmt)) == SQLITE_ROW) {
+            *value = sqlite3_column_int(stmt, 0);
+            result = CIF_OK;
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    return result;
+}
+
+/*
+ * Installs the CIF schema in the specified database, which must not already contain any schema objects
+ */
+static int install_schema(sqlite3 *db) {
+    FAILURE_HANDLING;
+
+    if (BEGIN(db) == SQLITE_OK) {
+        const char * const *stmt_p;
+
+        /* Execute each statement in the 'schema_statements' array */
+        for (stmt_p = schema_statements; *stmt_p; stmt_p += 1) {
+            if (DEBUG_WRAP(db, sqlite3_exec(db, *stmt_p, NULL, NULL, NULL)) != SQLITE_OK) {
+#ifdef DEBUG
+                fprintf(stderr, "Error occurs in DDL statement %d:\n%s\n",
+                        (int)(stmt_p - schema_statements), *stmt_p);
+#endif
+                DEFAULT_FAIL(hard);
+            }
+        }
+
+        /* record the schema version, by which the database can later be recognized */
+        if ((DEBUG_WRAP(db, sqlite3_exec(db, SET_SCHEMA_VERSION_SQL, NULL, NULL, NULL)) == SQLITE_OK)
+                && (COMMIT(db) == SQLITE_OK)) {
+            return CIF_OK;
+        }
+
+        FAILURE_HANDLER(hard):
+        ROLLBACK(db);  /* ignore any error */
+    }
+
+    FAILURE_TERMINUS;
+}
+
+/*
+ * Opens the specified SQLite database, ensures that it carries the CIF schema, and wraps a new managed CIF around it.
+ *
+ * db_name: the name of the database, in the form expected by sqlite3_open_v2()
+ * open_flags: the sqlite3_open_v2() flags with which to open the database, exclusive of the threading and cache mode
+ *     flags, which are always chosen by this function
+ * setup_sql: SQL with which to configure the new connection, or NULL if none is needed
+ * image: a serialized database image with which to replace the contents of the opened database, or NULL to use the
+ *     database as found
+ * image_size: the number of bytes in the image; ignored when image is NULL
+ * schema_action: SCHEMA_INSTALL to install the schema unconditionally, which is appropriate only for new, empty
+ *     databases; SCHEMA_VERIFY to require the database to carry the current schema version already; or
+ *     SCHEMA_VERIFY_OR_INSTALL to install the schema if the database is empty, and otherwise to verify it
+ */
+static int cif_open_db(const char *db_name, int open_flags, const char *setup_sql, const unsigned char *image,
+        size_t image_size, int schema_action, cif_tp **cif) {
     FAILURE_HANDLING;
     cif_tp *temp;
-    if (cif == NULL) return CIF_ARGUMENT_ERROR;
 
     temp = (cif_tp *) malloc(sizeof(cif_tp));
     if (temp == NULL) {
         SET_RESULT(CIF_MEMORY_ERROR);
     } else {
+        temp->db = NULL;
         if (
                 /*
                  * Per the SQLite docs, it is recommended and safe, albeit currently
@@ -199,7 +473,7 @@ int cif_create(cif_tp **cif) {
                 (DEBUG_WRAP2(sqlite3_initialize()) == SQLITE_OK)
 
                 /*
-                 * Open a connection to a temporary SQLite database.  The database will
+                 * Open a connection to the SQLite database.  A new database will
                  * use UTF-8 as its default character encoding (and also the function
                  * assumes the filename to be encoded in UTF-8).
                  *
@@ -208,15 +482,10 @@ int cif_create(cif_tp **cif) {
                  * also sufficient performance improvement to slightly outweigh the
                  * cost of transcoding into and out of the database.
                  */
-                && (DEBUG_WRAP2(sqlite3_open_v2(
-#ifdef SQLITE_MEMORY_ONLY
-                        ":memory:",
-#else
-                        "",
-#endif
-                        &(temp->db), SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX
-                        | SQLITE_OPEN_PRIVATECACHE, NULL)) == SQLITE_OK)) {
+                && (DEBUG_WRAP2(sqlite3_open_v2(db_name, &(temp->db),
+                        open_flags | SQLITE_OPEN_NOMUTEX | SQLITE_OPEN_PRIVATECACHE, NULL)) == SQLITE_OK)) {
             int fks_enabled = 0;
+            int image_result = ((image == NULL) ? CIF_OK : load_image(temp->db, image, image_size));
 
 #ifdef PERFORM_QUERY_PROFILING
             static struct qp_s query_params;
@@ -229,25 +498,35 @@ int cif_create(cif_tp **cif) {
 
             /* Any other DB setup / configuration needed in the future should go here */
 
-            if (DEBUG_WRAP(temp->db, sqlite3_exec(temp->db, ENABLE_FKS_SQL, cif_create_callback, &fks_enabled, NULL))
-                    == SQLITE_OK) {
+            if (image_result != CIF_OK) {
+                SET_RESULT(image_result);
+            } else if (((setup_sql == NULL)
+                        || (DEBUG_WRAP(temp->db, sqlite3_exec(temp->db, setup_sql, NULL, NULL, NULL)) == SQLITE_OK))
+                    && (DEBUG_WRAP(temp->db, sqlite3_exec(temp->db, ENABLE_FKS_SQL, cif_create_callback, &fks_enabled,
+                            NULL)) == SQLITE_OK)) {
                 if (fks_enabled == 0) {
                     SET_RESULT(CIF_ENVIRONMENT_ERROR);
-                } else if (BEGIN(temp->db) == SQLITE_OK) {
-                    const char * const *stmt_p;
-
-                    /* Execute each statement in the 'schema_statements' array */
-                    for (stmt_p = schema_statements; *stmt_p; stmt_p += 1) {
-                        if (DEBUG_WRAP(temp->db, sqlite3_exec(temp->db, *stmt_p, NULL, NULL, NULL)) != SQLITE_OK) {
-#ifdef DEBUG
-                            fprintf(stderr, "Error occurs in DDL statement %d:\n%s\n",
-                                    (int)(stmt_p - schema_statements), *stmt_p);
-#endif
-                            DEFAULT_FAIL(hard);
-                        }
+                } else {
+                    int version;
+                    int object_count;
+                    int schema_ok = CIF_FALSE;
+
+                    if (schema_action == SCHEMA_INSTALL) {
+                        schema_ok = (install_schema(temp->db) == CIF_OK);
+                    } else if ((query_int(temp->db, GET_SCHEMA_VERSION_SQL, &version) != CIF_OK)
+                            || (query_int(temp->db, COUNT_SCHEMA_OBJECTS_SQL, &object_count) != CIF_OK)) {
+                        /* typically, the file exists but is not an SQLite database */
+                        SET_RESULT(CIF_ENVIRONMENT_ERROR);
+                    } else if ((object_count == 0) && (schema_action == SCHEMA_VERIFY_OR_INSTALL)) {
+                        schema_ok = (install_schema(temp->db) == CIF_OK);
+                    } else if ((object_count == 0) || (version != SCHEMA_VERSION)) {
+                        /* the database does not carry the current CIF schema */
+                        SET_RESULT(CIF_ENVIRONMENT_ERROR);
+                    } else {
+                        schema_ok = CIF_TRUE;
                     }
 
-                    if (COMMIT(temp->db) == SQLITE_OK) {
+                    if (schema_ok) {
                         /* The database is set up; now initialize the other fields of the cif object */
                         INIT_STMT(temp, create_block);
                         INIT_STMT(temp, get_block);
@@ -278,6 +557,17 @@ int cif_create(cif_tp **cif) {
                         INIT_STMT(temp, insert_value);
                         INIT_STMT(temp, update_value);
                         INIT_STMT(temp, remove_packet);
+                        INIT_STMT(temp, get_name_id);
+                        INIT_STMT(temp, get_item_name);
+                        INIT_STMT(temp, get_loop_name_ids);
+                        INIT_STMT(temp, get_column_values);
+                        INIT_STMT(temp, aggregate_values);
+                        temp->loop_item_generation = 0;
+                        temp->names_by_name = NULL;
+                        temp->names_by_id = NULL;
+                        temp->names_generation = 0;
+                        temp->user_transaction = CIF_FALSE;
+                        temp->open_iterators = 0;
 
 #ifdef DEBUG
                         sqlite3_trace(temp->db, debug_sql, NULL);
@@ -288,13 +578,11 @@ int cif_create(cif_tp **cif) {
                         return CIF_OK;
                     }
                 }
-
-                FAILURE_HANDLER(hard):
-                ROLLBACK(temp->db);  /* ignore any error */
             }
-
-            DEBUG_WRAP(temp->db, sqlite3_close(temp->db)); /* ignore any error */
         }
+
+        /* the connection must be closed even if opening it failed; closing a NULL connection is harmless */
+        DEBUG_WRAP2(sqlite3_close(temp->db)); /* ignore any error */
         free(temp);
     }
 
@@ -307,6 +595,8 @@ int cif_destroy(cif_tp *cif) {
     /* ensure that there is no open transaction; will fail harmlessly if there already is none */
     ROLLBACK(cif->db);
 
+    clear_name_cache(cif);
+
     /* Clean up any outstanding prepared statements */
     while ((stmt = sqlite3_next_stmt(cif->db, NULL))) {
         DEBUG_WRAP(cif->db,sqlite3_finalize(stmt));
@@ -323,12 +613,308 @@ int cif_destroy(cif_tp *cif) {
     }
 }
 
+int cif_begin(cif_tp *cif) {
+    if (cif == NULL) {
+        return CIF_INVALID_HANDLE;
+    } else if (sqlite3_get_autocommit(cif->db) == 0) {
+        /* a user transaction, packet iteration, or bulk load is already underway */
+        return CIF_MISUSE;
+    } else if (BEGIN(cif->db) != SQLITE_OK) {
+        return CIF_ERROR;
+    } else {
+        cif->user_transaction = CIF_TRUE;
+        return CIF_OK;
+    }
+}
+
+int cif_commit(cif_tp *cif) {
+    int result = CIF_OK;
+
+    if (cif == NULL) {
+        return CIF_INVALID_HANDLE;
+    } else if ((!cif->user_transaction) || (cif->open_iterators > 0)) {
+        return CIF_MISUSE;
+    }
+
+    cif->user_transaction = CIF_FALSE;
+    if (sqlite3_get_autocommit(cif->db) != 0) {
+        /* SQLite has already rolled back the transaction in response to an earlier error */
+        result = CIF_ERROR;
+        cif->loop_item_generation += 1;
+    } else if (COMMIT(cif->db) != SQLITE_OK) {
+        result = CIF_ERROR;
+        (void) ROLLBACK(cif->db);
+        cif->loop_item_generation += 1;
+    }
+
+    return result;
+}
+
+int cif_rollback(cif_tp *cif) {
+    int result = CIF_OK;
+
+    if (cif == NULL) {
+        return CIF_INVALID_HANDLE;
+    } else if ((!cif->user_transaction) || (cif->open_iterators > 0)) {
+        return CIF_MISUSE;
+    }
+
+    cif->user_transaction = CIF_FALSE;
+    if ((sqlite3_get_autocommit(cif->db) == 0) && (ROLLBACK(cif->db) != SQLITE_OK)) {
+        result = CIF_ERROR;
+    }
+    /* items added during the transaction are gone now */
+    cif->loop_item_generation += 1;
+
+    return result;
+}
+
+int cif_bulk_load_begin(cif_tp *cif, int *active) {
+    *active = CIF_FALSE;
+
+    if (sqlite3_get_autocommit(cif->db) == 0) {
+        /* the caller already has a transaction open, which the load will simply join */
+        return CIF_OK;
+    }
+
+    /* foreign key enforcement cannot be changed inside a transaction, so it is switched off first */
+    if (DEBUG_WRAP(cif->db, sqlite3_exec(cif->db, DISABLE_FKS_SQL, NULL, NULL, NULL)) == SQLITE_OK) {
+        if (BEGIN(cif->db) == SQLITE_OK) {
+            *active = CIF_TRUE;
+            return CIF_OK;
+        }
+        (void) DEBUG_WRAP(cif->db, sqlite3_exec(cif->db, ENABLE_FKS_SQL, NULL, NULL, NULL));
+    }
+
+    return CIF_ERROR;
+}
+
+int cif_bulk_load_end(cif_tp *cif, int result) {
+    if (result == CIF_OK) {
+        sqlite3_stmt *check_stmt;
+
+        /* perform any deferred cascading deletions, then verify referential integrity */
+        if ((DEBUG_WRAP(cif->db, sqlite3_exec(cif->db, CASCADE_CONTAINER_DELETES_SQL, NULL, NULL, NULL)) != SQLITE_OK)
+                || (DEBUG_WRAP(cif->db, sqlite3_exec(cif->db, CASCADE_LOOP_DELETES_SQL, NULL, NULL, NULL))
+                        != SQLITE_OK)
+                || (DEBUG_WRAP(cif->db, sqlite3_prepare_v2(cif->db, CHECK_FKS_SQL, -1, &check_stmt, NULL))
+                        != SQLITE_OK)) {
+            result = CIF_ERROR;
+        } else {
+            /* the check produces one row for each violation it finds */
+            if (DEBUG_WRAP(cif->db, sqlite3_step(check_stmt)) != SQLITE_DONE) {
+                result = CIF_ERROR;
+            }
+            sqlite3_finalize(check_stmt);
+        }
+    }
+
+    if ((result == CIF_OK) && (COMMIT(cif->db) != SQLITE_OK)) {
+        result = CIF_ERROR;
+    }
+    if (result != CIF_OK) {
+        /* ignore any error */
+        (void) ROLLBACK(cif->db);
+        cif->loop_item_generation += 1;
+    }
+
+    if (DEBUG_WRAP(cif->db, sqlite3_exec(cif->db, ENABLE_FKS_SQL, NULL, NULL, NULL)) != SQLITE_OK) {
+        result = CIF_ERROR;
+    }
+
+    return result;
+}
+
+int cif_create_value_index(cif_tp *cif, const UChar *item_name) {
+    FAILURE_HANDLING;
+    NESTTX_HANDLING;
+    UChar *norm_name;
+    int result;
+
+    if (cif == NULL) {
+        return CIF_INVALID_HANDLE;
+    } else if (item_name == NULL) {
+        return CIF_INVALID_ITEMNAME;
+    } else if ((result = cif_normalize_item_name(item_name, -1, &norm_name, CIF_INVALID_ITEMNAME)) != CIF_OK) {
+        return result;
+    }
+
+    if (BEGIN_NESTTX(cif->db) == SQLITE_OK) {
+        sqlite3_stmt *intern_stmt;
+        int name_id;
+
+        /* the name must be interned for the index to refer to it by ID */
+        if (DEBUG_WRAP(cif->db, sqlite3_prepare_v2(cif->db, INTERN_NAME_SQL, -1, &intern_stmt, NULL)) == SQLITE_OK) {
+            int step_result = SQLITE_ERROR;
+
+            if (sqlite3_bind_text16(intern_stmt, 1, norm_name, -1, SQLITE_STATIC) == SQLITE_OK) {
+                step_result = DEBUG_WRAP(cif->db, sqlite3_step(intern_stmt));
+            }
+            sqlite3_finalize(intern_stmt);
+
+            if ((step_result == SQLITE_DONE) && ((result = cif_get_name_id(cif, norm_name, &name_id)) != CIF_OK)) {
+                SET_RESULT(result);
+            } else if (step_result == SQLITE_DONE) {
+                /* room for the statement text, plus up to two decimal digits per byte of each ID */
+                char sql[sizeof(CREATE_NUMB_INDEX_SQL) + sizeof(CREATE_TEXT_INDEX_SQL) + 8 * sizeof(int)];
+
+                sprintf(sql, CREATE_NUMB_INDEX_SQL ";" CREATE_TEXT_INDEX_SQL, name_id, name_id, name_id, name_id);
+                if ((DEBUG_WRAP(cif->db, sqlite3_exec(cif->db, sql, NULL, NULL, NULL)) == SQLITE_OK)
+                        && (COMMIT_NESTTX(cif->db) == SQLITE_OK)) {
+                    free(norm_name);
+                    return CIF_OK;
+                }
+            }
+        }
+
+        /* ignore any error */
+        (void) ROLLBACK_NESTTX(cif);
+    }
+
+    free(norm_name);
+    FAILURE_TERMINUS;
+}
+
+/* All uthash fatal errors arise from memory allocation failure */
+#undef uthash_fatal
+#define uthash_fatal(msg) FAIL(soft, CIF_MEMORY_ERROR)
+
+/*
+ * Records the specified ID / name pair in the specified CIF's name cache, which must be current.  The name is copied.
+ * Failure to cache a name is harmless to callers, which can always fall back to querying the database.
+ */
+static void cache_name(cif_tp *cif, int id, const UChar *name) {
+    FAILURE_HANDLING;
+    struct name_id_s *entry = (struct name_id_s *) malloc(sizeof(struct name_id_s));
+
+    if (entry != NULL) {
+        entry->id = id;
+        entry->name = cif_u_strdup(name);
+        if (entry->name != NULL) {
+            HASH_ADD_KEYPTR(hh, cif->names_by_name, entry->name, U_BYTES(entry->name), entry);
+            HASH_ADD(hh_id, cif->names_by_id, id, sizeof(int), entry);
+            return;
+        }
+        free(entry);
+    }
+    return;
+
+    FAILURE_HANDLER(soft):
+    /* the hash tables may be inconsistent; abandon them (leaking their contents) rather than risk traversing them */
+    cif->names_by_name = NULL;
+    cif->names_by_id = NULL;
+    (void) _error_code;
+}
+
+/*
+ * Releases all entries of the specified CIF's name cache
+ */
+static void clear_name_cache(cif_tp *cif) {
+    struct name_id_s *entry;
+    struct name_id_s *temp;
+
+    HASH_CLEAR(hh_id, cif->names_by_id);
+    HASH_ITER(hh, cif->names_by_name, entry, temp) {
+        HASH_DELETE(hh, cif->names_by_name, entry);
+        free(entry->name);
+        free(entry);
+    }
+}
+
+/*
+ * Discards the specified CIF's name cache if it may be stale
+ */
+static void validate_name_cache(cif_tp *cif) {
+    if (cif->names_generation != cif->loop_item_generation) {
+        clear_name_cache(cif);
+        cif->names_generation = cif->loop_item_generation;
+    }
+}
+
+int cif_get_name_id(cif_tp *cif, const UChar *name, int *id) {
+    FAILURE_HANDLING;
+    struct name_id_s *entry;
+
+    validate_name_cache(cif);
+    HASH_FIND(hh, cif->names_by_name, name, U_BYTES(name), entry);
+    if (entry != NULL) {
+        *id = entry->id;
+        return CIF_OK;
+    } else {
+        STEP_HANDLING;
+
+        PREPARE_STMT(cif, get_name_id, GET_NAME_ID_SQL);
+
+        if (sqlite3_bind_text16(cif->get_name_id_stmt, 1, name, -1, SQLITE_STATIC) == SQLITE_OK) {
+            switch (STEP_STMT(cif, get_name_id)) {
+                case SQLITE_DONE:
+                    /* the name is not interned, so it does not belong to any loop */
+                    return CIF_NOSUCH_ITEM;
+                case SQLITE_ROW:
+                    *id = sqlite3_column_int(cif->get_name_id_stmt, 0);
+                    if (sqlite3_reset(cif->get_name_id_stmt) == SQLITE_OK) {
+                        cache_name(cif, *id, name);
+                        return CIF_OK;
+                    }
+                    break;
+                /* default: do nothing */
+            }
+        }
+
+        DROP_STMT(cif, get_name_id);
+    }
+
+    FAILURE_TERMINUS;
+}
+
+int cif_get_item_name(cif_tp *cif, int id, const UChar **name) {
+    FAILURE_HANDLING;
+    struct name_id_s *entry;
+
+    validate_name_cache(cif);
+    HASH_FIND(hh_id, cif->names_by_id, &id, sizeof(int), entry);
+    if (entry != NULL) {
+        *name = entry->name;
+        return CIF_OK;
+    } else {
+        STEP_HANDLING;
+
+        PREPARE_STMT(cif, get_item_name, GET_ITEM_NAME_SQL);
+
+        if (sqlite3_bind_int(cif->get_item_name_stmt, 1, id) == SQLITE_OK) {
+            switch (STEP_STMT(cif, get_item_name)) {
+                case SQLITE_DONE:
+                    return CIF_NOSUCH_ITEM;
+                case SQLITE_ROW:
+                    /* the column value will be freed automatically by SQLite */
+                    cache_name(cif, id, (const UChar *) sqlite3_column_text16(cif->get_item_name_stmt, 0));
+                    if (sqlite3_reset(cif->get_item_name_stmt) == SQLITE_OK) {
+                        HASH_FIND(hh_id, cif->names_by_id, &id, sizeof(int), entry);
+                        if (entry != NULL) {
+                            *name = entry->name;
+                            return CIF_OK;
+                        }
+                        /* the name could not be cached, but the caller relies on the cache to hold it */
+                        return CIF_MEMORY_ERROR;
+                    }
+                    break;
+                /* default: do nothing */
+            }
+        }
+
+        DROP_STMT(cif, get_item_name);
+    }
+
+    FAILURE_TERMINUS;
+}
+
 int cif_create_block(cif_tp *cif, const UChar *code, cif_block_tp **block) {
     return code ? cif_create_block_internal(cif, code, 0, block) : CIF_ARGUMENT_ERROR;
 }
 
 int cif_create_block_internal(cif_tp *cif, const UChar *code, int lenient, cif_block_tp **block) {
     FAILURE_HANDLING;
+    NESTTX_HANDLING;
     cif_block_tp *temp;
     int result;
 
@@ -365,7 +951,7 @@ int cif_create_block_internal(cif_tp *cif, const UChar *code, int lenient, cif_b
             if (temp->code_orig == NULL) {
                 SET_RESULT(CIF_MEMORY_ERROR);
             } else {
-                if(BEGIN(cif->db) == SQLITE_OK) {
+                if(BEGIN_NESTTX(cif->db) == SQLITE_OK) {
                     if(DEBUG_WRAP2(sqlite3_exec(cif->db, "insert into container(id) values (null)", NULL, NULL, NULL))
                             == SQLITE_OK) {
                         temp->id = sqlite3_last_insert_rowid(cif->db);
@@ -384,7 +970,7 @@ int cif_create_block_internal(cif_tp *cif, const UChar *code, int lenient, cif_b
                                     /* rollback the transaction and clean up, ignoring any further error */
                                     FAIL(soft, CIF_DUP_BLOCKCODE);
                                 case SQLITE_DONE:
-                                    if (COMMIT(cif->db) == SQLITE_OK) {
+                                    if (COMMIT_NESTTX(cif->db) == SQLITE_OK) {
                                         ASSIGN_TEMP_PTR(temp, block, cif_container_free);
                                         return CIF_OK;
                                     }
@@ -398,7 +984,7 @@ int cif_create_block_internal(cif_tp *cif, const UChar *code, int lenient, cif_b
                     }
                     FAILURE_HANDLER(soft):
                     /* rollback the transaction, ignoring any further error */
-                    ROLLBACK(cif->db);
+                    ROLLBACK_NESTTX(cif);
                 } /* else failed to begin a transaction */
             } /* else failed to dup the original code */
         }
@@ -117,8 +117,11 @@
  * The CIF API provides a handful of functions having resource management relevance that do not fit the general pattern:
  * @li Though it does not have "create" in its name, the cif_parse() function operates as an object creation function
  *         when its last argument is a pointer to NULL.
- * @li The creation function for loop packet iterators is cif_loop_get_packets() .  Its cleanup functions are
- *         cif_pktitr_close() and cif_pktitr_abort() .
+ * @li The creation functions for loop packet iterators are cif_loop_get_packets() , cif_loop_get_packets_for() ,
+ *         cif_loop_select() , and cif_loop_join() .  Their cleanup functions are cif_pktitr_close() and cif_pktitr_abort() .
+ * @li The functions cif_predicate_create_and() and cif_predicate_create_or() assume responsibility for the predicates
+ *         passed to them (on success), so that a whole predicate tree is released via one call to
+ *         cif_predicate_free() on its root.
  * @li The function cif_value_clean() is unusual in that it releases internal resources held by its argument without
  *         releasing the argument itself (converting it to a kind of value that does not require dynamically-allocated
  *         internal resources).
@@ -602,6 +605,44 @@
  */
 #define CIF_SCALARS (&cif_uchar_nul)
 
+/**
+ * @brief The storage backend code requesting the library's default storage for a new managed CIF
+ *
+ * If the @c CIF_STORAGE environment variable is set to the name of a backend -- @c tempfile for
+ * @c CIF_STORAGE_TEMPFILE or @c memory for @c CIF_STORAGE_MEMORY -- then that backend is the default.  Otherwise the
+ * default is @c CIF_STORAGE_MEMORY if the library was built with @c SQLITE_MEMORY_ONLY defined, else
+ * @c CIF_STORAGE_TEMPFILE .
+ */
+#define CIF_STORAGE_DEFAULT  0
+
+/**
+ * @brief The storage backend code requesting that a new managed CIF be held in a private, temporary database that
+ *        resides in memory until it grows large, and thereafter spills to an anonymous temporary file
+ *
+ * This is the most suitable backend for CIFs too large to hold comfortably in memory.
+ */
+#define CIF_STORAGE_TEMPFILE 1
+
+/**
+ * @brief The storage backend code requesting that a new managed CIF be held entirely in memory
+ *
+ * This backend never performs file I/O, and it keeps its transaction journal and temporary indexes in memory as well.
+ * It is the most suitable backend for programs that parse, transform, and write CIF data in one process.
+ */
+#define CIF_STORAGE_MEMORY   2
+
+/**
+ * @brief A flag for @c cif_open() requesting that the database be created, with an empty CIF, if it does not already
+ *        exist
+ */
+#define CIF_OPEN_CREATE   1
+
+/**
+ * @brief A flag for @c cif_open() requesting that the database be opened for reading only.  Attempts to modify a CIF
+ *        opened this way fail.
+ */
+#define CIF_OPEN_READONLY 2
+
 /**
  * @brief A static Unicode NUL character; a pointer to this variable constitutes an empty Unicode string.
  */
@@ -660,6 +701,18 @@ typedef struct cif_packet_s cif_packet_tp;
  */
 typedef struct cif_pktitr_s cif_pktitr_tp;
 
+/**
+ * @brief An opaque data structure representing a condition on the values in a loop packet, by which
+ *         @c cif_loop_select() chooses the packets to iterate
+ */
+typedef struct cif_predicate_s cif_predicate_tp;
+
+/**
+ * @brief An opaque data structure encapsulating the state of a pull-style read of CIF text via
+ *         @c cif_reader_next()
+ */
+typedef struct cif_reader_s cif_reader_tp;
+
 /**
  * @brief The type of all data value objects
  */
@@ -717,6 +770,149 @@ typedef enum cif_quoted {
     CIF_QUOTED = 1
 } cif_quoted_tp;
 
+/**
+ * @brief The type used for codes representing the comparison a simple predicate performs between an item's value
+ *     and a constant
+ */
+typedef enum cif_compare {
+
+    /**
+     * @brief the comparison is satisfied if the value is equal to the constant
+     */
+    CIF_CMP_EQ = 0,
+
+    /**
+     * @brief the comparison is satisfied if the value is not equal to the constant
+     */
+    CIF_CMP_NE = 1,
+
+    /**
+     * @brief the comparison is satisfied if the value is less than the constant
+     */
+    CIF_CMP_LT = 2,
+
+    /**
+     * @brief the comparison is satisfied if the value is less than or equal to the constant
+     */
+    CIF_CMP_LE = 3,
+
+    /**
+     * @brief the comparison is satisfied if the value is greater than the constant
+     */
+    CIF_CMP_GT = 4,
+
+    /**
+     * @brief the comparison is satisfied if the value is greater than or equal to the constant
+     */
+    CIF_CMP_GE = 5
+} cif_compare_tp;
+
+/**
+ * @brief Summary statistics of the values of one loop item, as computed by @c cif_loop_aggregate()
+ *
+ * The statistics @c min , @c max , @c sum , and @c mean cover only the numeric ( @c CIF_NUMB_KIND ) values, and
+ * disregard their standard uncertainties.  They are all zero if there are no numeric values.
+ */
+typedef struct cif_aggregate_s {
+
+    /** @brief The number of numeric values */
+    size_t numb_count;
+
+    /** @brief The number of unknown ( @c CIF_UNK_KIND ) values */
+    size_t unk_count;
+
+    /** @brief The number of not-applicable ( @c CIF_NA_KIND ) values */
+    size_t na_count;
+
+    /** @brief The number of character, list, and table values */
+    size_t other_count;
+
+    /** @brief The least of the numeric values */
+    double min;
+
+    /** @brief The greatest of the numeric values */
+    double max;
+
+    /** @brief The sum of the numeric values */
+    double sum;
+
+    /** @brief The arithmetic mean of the numeric values */
+    double mean;
+} cif_aggregate_tp;
+
+/**
+ * @brief The type used for codes representing the kinds of events reported by @c cif_reader_next()
+ */
+typedef enum cif_event_kind {
+
+    /** @brief The start of a data block; the event's @c name is the block code */
+    CIF_BLOCK_EVENT = 0,
+
+    /** @brief The start of a save frame; the event's @c name is the frame code */
+    CIF_FRAME_EVENT = 1,
+
+    /** @brief The end of the innermost open save frame */
+    CIF_FRAME_END_EVENT = 2,
+
+    /** @brief The start of a loop; the event's @c item_names are the loop's data names */
+    CIF_LOOP_START_EVENT = 3,
+
+    /** @brief The end of the current loop */
+    CIF_LOOP_END_EVENT = 4,
+
+    /** @brief The start of a loop packet; one item event follows for each of the loop's data names */
+    CIF_PACKET_EVENT = 5,
+
+    /** @brief A data value, either of a single-valued item or of the current packet's item named by @c name */
+    CIF_ITEM_EVENT = 6
+} cif_event_kind_tp;
+
+/**
+ * @brief An event reported by @c cif_reader_next()
+ *
+ * All pointers belong to the reader, and the data they reference remain valid only until the next call to
+ * @c cif_reader_next() or @c cif_reader_close() for the same reader.  Members not relevant to the event's kind are
+ * NULL or zero.
+ */
+typedef struct cif_event_s {
+
+    /** @brief The kind of event */
+    cif_event_kind_tp kind;
+
+    /** @brief The NUL-terminated block code, frame code, or data name associated with the event, if any */
+    const UChar *name;
+
+    /** @brief For loop start events, the NULL-terminated array of the loop's data names */
+    UChar **item_names;
+
+    /**
+     * @brief For item events, the text of the value, not NUL-terminated; NULL for list and table values and for
+     *         values synthesized during error recovery
+     *
+     * This is borrowed directly from the reader's input buffer, without delimiters, except that the contents of text
+     * fields are first decoded according to the line-folding and text-prefix protocols, as applicable.
+     */
+    const UChar *text;
+
+    /** @brief The number of UChar code units in @c text */
+    size_t text_length;
+
+    /**
+     * @brief For item events, the kind of the value: @c CIF_CHAR_KIND for all values presented as @c text other
+     *         than an unquoted question mark ( @c CIF_UNK_KIND ) or period ( @c CIF_NA_KIND ), or else
+     *         @c CIF_LIST_KIND , @c CIF_TABLE_KIND , or (for synthetic values) @c CIF_UNK_KIND
+     *
+     * Unquoted @c CIF_CHAR_KIND values may represent numbers; @c cif_value_parse_numb() can interpret them.
+     */
+    cif_kind_tp value_kind;
+
+    /** @brief For item events, whether the value was quoted or presented as a text field */
+    cif_quoted_tp quoted;
+
+    /** @brief For item events with list or table values, the parsed value */
+    cif_value_tp *value;
+} cif_event_tp;
+
 /**
  * @brief A set of functions defining a handler interface for directing and taking appropriate action in response
  *     to a traversal of a CIF.
@@ -1059,6 +1255,23 @@ struct cif_parse_opts_s {
      *         parser itself, and may be @c NULL.
      */
     void *user_data;
+
+    /**
+     * @brief If non-zero, the parsed data are loaded into the target CIF in bulk-load mode.
+     *
+     * Ordinarily, each data value, loop packet, block, and frame parsed is recorded in a separate transaction.  In
+     * bulk-load mode the whole parse is instead performed in a single transaction, and enforcement of the storage
+     * layer's referential integrity constraints is suspended while the data are loaded.  Those constraints are
+     * verified once, at the end of the parse.  This can substantially speed parsing of large CIFs.
+     *
+     * In bulk-load mode a parse is all-or-nothing: if it fails, then the target CIF is left as it was before the parse
+     * began.  If the target CIF already has a transaction open when the parse starts, then the parsed data are instead
+     * recorded as part of that transaction, and this option has no further effect.  It also has no effect on a
+     * syntax-only parse.
+     *
+     * The default is 0.
+     */
+    int bulk_load;
 };
 
 /**
@@ -1210,6 +1423,132 @@ CIF_INTFUNC_DECL(cif_parse, (
         cif_tp **cif
         ));
 
+/**
+ * @brief Parses a CIF from the specified in-memory bytes.
+ *
+ * This function parses exactly as @c cif_parse() does, including its detection of the character encoding, but it
+ * takes its input from a buffer instead of from a stream.  The bytes are decoded in place, without being copied, and
+ * they are not modified.  This is more efficient than wrapping the buffer in a stream for @c cif_parse() .
+ *
+ * @param[in] bytes a pointer to the first of the bytes to parse; may be NULL only if @p length is zero.  The bytes
+ *         belong to the caller.
+ *
+ * @param[in] length the number of bytes to parse
+ *
+ * @param[in] options a pointer to a @c struct @c cif_parse_opts_s object describing options to use while parsing, or
+ *         @c NULL to use default values for all options
+ *
+ * @param[in,out] cif controls the disposition of the parsed data, exactly as for @c cif_parse()
+ *
+ * @return Returns @c CIF_OK on a successful parse, even if the results are discarded, or an error code on failure:
+ *         @c CIF_ARGUMENT_ERROR if @p bytes is NULL but @p length is not zero, or otherwise typically
+ *         @c CIF_ERROR .  In the event of a failure, a new CIF object may still be created and returned via the
+ *         @c cif argument, or the provided CIF object may still be modified.
+ */
+CIF_INTFUNC_DECL(cif_parse_buffer, (
+        const void *bytes,
+        size_t length,
+        struct cif_parse_opts_s *options,
+        cif_tp **cif
+        ));
+
+/**
+ * @brief Parses the CIF stored in the file at the specified path.
+ *
+ * This function parses exactly as @c cif_parse() does, but it opens and closes the input file itself.  Where the
+ * system supports it, a regular file is mapped into memory and decoded directly from the mapping, as if by
+ * @c cif_parse_buffer() .  That avoids copying its contents through @c stdio buffers and lets the operating system
+ * schedule read-ahead for the whole file, which is considerably more efficient for large inputs.  Inputs that cannot
+ * be mapped are read via @c cif_parse().
+ *
+ * @param[in] path the path to the file to parse; must not be NULL
+ *
+ * @param[in] options a pointer to a @c struct @c cif_parse_opts_s object describing options to use while parsing, or
+ *         @c NULL to use default values for all options
+ *
+ * @param[in,out] cif controls the disposition of the parsed data, exactly as for @c cif_parse()
+ *
+ * @return Returns @c CIF_OK on a successful parse, even if the results are discarded, or an error code on failure:
+ *         @c CIF_ARGUMENT_ERROR if @p path is NULL, or otherwise typically @c CIF_ERROR , including if the file
+ *         cannot be opened.  In the event of a failure, a new CIF object may still be created and returned via the
+ *         @c cif argument, or the provided CIF object may still be modified.
+ */
+CIF_INTFUNC_DECL(cif_parse_file, (
+        const char *path,
+        struct cif_parse_opts_s *options,
+        cif_tp **cif
+        ));
+
+/**
+ * @brief Opens a pull-style reader on the CIF text in the specified stream.
+ *
+ * The reader presents the structure and contents of the CIF as a sequence of events, one per call to
+ * @c cif_reader_next() , instead of recording them in a managed CIF or reporting them to handler callbacks.  It holds
+ * only the current token and the data names of the current loop, so inputs of any size are read in bounded memory,
+ * and no storage is used at all.
+ *
+ * The character encoding and CIF version are determined as for @c cif_parse() .  The options' error, whitespace,
+ * keyword, and data name callbacks are honored, but its @c handler and @c bulk_load are ignored.  As in
+ * @c cif_parse() 's syntax-only mode, semantic errors such as duplicate data names or block codes are not detected.
+ *
+ * @param[in,out] stream a @c FILE @c * from which to read the raw CIF data, open in binary mode; the caller retains
+ *         ownership, but the stream must remain open until the reader is closed
+ *
+ * @param[in] options a pointer to a @c struct @c cif_parse_opts_s object describing options to use while reading,
+ *         or @c NULL to use default values for all options.  The options are copied as needed, so the options
+ *         object need not outlive this call.
+ *
+ * @param[out] reader the location where a handle on the new reader should be recorded; on success, the caller is
+ *         responsible for eventually releasing it via @c cif_reader_close()
+ *
+ * @return Returns @c CIF_OK on success, @c CIF_ARGUMENT_ERROR if @p stream or @p reader is NULL, or another error
+ *         code (typically @c CIF_ERROR ) on failure
+ */
+CIF_INTFUNC_DECL(cif_reader_open, (
+        FILE *stream,
+        struct cif_parse_opts_s *options,
+        cif_reader_tp **reader
+        ));
+
+/**
+ * @brief Reads CIF text until the next event, and describes that event.
+ *
+ * Data blocks, save frames, and loops start with @c CIF_BLOCK_EVENT , @c CIF_FRAME_EVENT , and
+ * @c CIF_LOOP_START_EVENT events, respectively.  Single-valued items are each reported by one @c CIF_ITEM_EVENT .  In
+ * a loop, each packet is reported by a @c CIF_PACKET_EVENT followed by one @c CIF_ITEM_EVENT per data name, in header
+ * order, and the loop concludes with a @c CIF_LOOP_END_EVENT .  Each save frame concludes with a
+ * @c CIF_FRAME_END_EVENT .  Data blocks end only where another begins or the input ends.
+ *
+ * Errors in the input are reported to the reader's error callback, and recovered from as @c cif_parse() does if the
+ * callback returns @c CIF_OK .  In particular, a partial final packet is completed with synthetic unknown values.
+ *
+ * @param[in,out] reader a handle on the reader to advance; must not be NULL
+ *
+ * @param[out] event a pointer to an event object in which to record the event; must not be NULL.  The data to which
+ *         it then refers belong to the reader, and remain valid only until the reader is next advanced or closed.
+ *
+ * @return Returns @c CIF_OK if an event is recorded, @c CIF_FINISHED if the input is exhausted,
+ *         @c CIF_ARGUMENT_ERROR if either argument is NULL, or an error code returned by the error callback or
+ *         describing a failure to read the input.
+ */
+CIF_INTFUNC_DECL(cif_reader_next, (
+        cif_reader_tp *reader,
+        cif_event_tp *event
+        ));
+
+/**
+ * @brief Releases the resources held by the specified reader, which is thereafter invalid.
+ *
+ * The reader's stream is not closed.
+ *
+ * @param[in,out] reader a handle on the reader to close; if NULL then this function does nothing
+ *
+ * @return Returns @c CIF_OK
+ */
+CIF_INTFUNC_DECL(cif_reader_close, (
+        cif_reader_tp *reader
+        ));
+
 /**
  * @brief Allocates a parse options structure and initializes it with default values.
  *
@@ -1340,6 +1679,122 @@ CIF_INTFUNC_DECL(cif_create, (
         cif_tp **cif
         ));
 
+/**
+ * @brief Creates a new, empty, managed CIF that uses the specified storage backend.
+ *
+ * This function differs from @c cif_create() only in allowing the caller to choose how the managed CIF's data are
+ * stored.  Every backend is an SQLite database, differing only in where the database resides and how its connection
+ * is configured, so all backends support all features of this API and behave identically apart from performance.
+ *
+ * @param[out] cif a pointer to the location where a handle on the managed CIF should be recorded; must not be NULL.
+ *         The initial value of @p *cif is ignored, and is overwritten on success.
+ * @param[in] storage one of the @c CIF_STORAGE_* backend codes, such as @c CIF_STORAGE_MEMORY
+ *
+ * @return Returns @c CIF_OK on success, @c CIF_ARGUMENT_ERROR if @p storage is not a recognized backend code, or
+ *         another error code (typically @c CIF_ERROR ) on failure.
+ */
+CIF_INTFUNC_DECL(cif_create_with_storage, (
+        cif_tp **cif,
+        int storage
+        ));
+
+/**
+ * @brief Opens a managed CIF stored persistently in the specified database file.
+ *
+ * The file must be one previously written by @c cif_save_as() or created by this function, by a version of this
+ * library that uses the same database schema.  Changes to the CIF are stored in the file as they are made; the file is
+ * not otherwise affected by destroying the returned handle via @c cif_destroy() .
+ *
+ * If the function succeeds then the caller assumes responsibility for releasing the resources associated with the
+ * managed CIF via the @c cif_destroy() function.
+ *
+ * @param[in] path the name of the database file, encoded in UTF-8; must not be NULL
+ * @param[in] flags a bitwise OR of zero or more of @c CIF_OPEN_CREATE and @c CIF_OPEN_READONLY , which are mutually
+ *         exclusive
+ * @param[out] cif a pointer to the location where a handle on the managed CIF should be recorded; must not be NULL.
+ *         The initial value of @p *cif is ignored, and is overwritten on success.
+ *
+ * @return Returns @c CIF_OK on success, @c CIF_ARGUMENT_ERROR if the arguments are invalid, @c CIF_ENVIRONMENT_ERROR
+ *         if the file is not a database of the expected schema version, or another error code (typically
+ *         @c CIF_ERROR ) on failure, including if the file does not exist and @c CIF_OPEN_CREATE is not specified.
+ */
+CIF_INTFUNC_DECL(cif_open, (
+        const char *path,
+        int flags,
+        cif_tp **cif
+        ));
+
+/**
+ * @brief Writes a copy of the specified managed CIF to the specified database file, from which it can later be
+ *        reopened via @c cif_open() .
+ *
+ * Any existing contents of the file are replaced.  The CIF itself is not affected, and it remains associated with its
+ * original storage.
+ *
+ * @param[in] cif a handle on the managed CIF to save; must not be NULL.  Must not be in the midst of a packet
+ *         iteration or transaction.
+ * @param[in] path the name of the database file to write, encoded in UTF-8; must not be NULL
+ *
+ * @return Returns @c CIF_OK on success, @c CIF_ARGUMENT_ERROR if an argument is NULL, @c CIF_MISUSE if a packet
+ *         iteration or transaction is in progress, or another error code (typically @c CIF_ERROR ) on failure.
+ */
+CIF_INTFUNC_DECL(cif_save_as, (
+        cif_tp *cif,
+        const char *path
+        ));
+
+/**
+ * @brief Records an image of the specified managed CIF, in a single contiguous block of memory, from which a copy of
+ *        the CIF can later be restored via @c cif_deserialize() .
+ *
+ * The image is a complete database in the same format that @c cif_save_as() writes, so it may also be written to a
+ * file and opened via @c cif_open() .  The CIF itself is not affected.
+ *
+ * If the function succeeds then the caller assumes responsibility for freeing the image when it is no longer needed.
+ *
+ * @param[in] cif a handle on the managed CIF to serialize; must not be NULL.  Must not be in the midst of a packet
+ *         iteration or transaction.
+ * @param[out] bytes a pointer to the location where a pointer to the image should be recorded; must not be NULL.
+ *         The initial value of @p *bytes is ignored, and is overwritten on success.
+ * @param[out] length a pointer to the location where the length of the image, in bytes, should be recorded; must not
+ *         be NULL.  The initial value of @p *length is ignored, and is overwritten on success.
+ *
+ * @return Returns @c CIF_OK on success, @c CIF_ARGUMENT_ERROR if an argument is NULL, @c CIF_MISUSE if a packet
+ *         iteration or transaction is in progress, @c CIF_NOT_SUPPORTED if the underlying SQLite library was built
+ *         without serialization support, or another error code (typically @c CIF_ERROR ) on failure.
+ */
+CIF_INTFUNC_DECL(cif_serialize, (
+        cif_tp *cif,
+        unsigned char **bytes,
+        size_t *length
+        ));
+
+/**
+ * @brief Creates a new managed CIF, held in memory, from an image previously recorded by @c cif_serialize() or
+ *        written by @c cif_save_as() .
+ *
+ * The image is copied; the caller retains ownership of it, and may free or modify it as soon as this function
+ * returns.  Loading an image is much faster than parsing the corresponding CIF text.
+ *
+ * If the function succeeds then the caller assumes responsibility for releasing the resources associated with the
+ * managed CIF via the @c cif_destroy() function.
+ *
+ * @param[in] bytes a pointer to the start of the image; must not be NULL
+ * @param[in] length the length of the image, in bytes
+ * @param[out] cif a pointer to the location where a handle on the managed CIF should be recorded; must not be NULL.
+ *         The initial value of @p *cif is ignored, and is overwritten on success.
+ *
+ * @return Returns @c CIF_OK on success, @c CIF_ARGUMENT_ERROR if an argument is NULL, @c CIF_ENVIRONMENT_ERROR if
+ *         the image is not a database of the expected schema version, @c CIF_NOT_SUPPORTED if the underlying SQLite
+ *         library was built without serialization support, or another error code (typically @c CIF_ERROR ) on
+ *         failure.
+ */
+CIF_INTFUNC_DECL(cif_deserialize, (
+        const unsigned char *bytes,
+        size_t length,
+        cif_tp **cif
+        ));
+
 /**
  * @brief Removes the specified managed CIF, releasing all resources it holds.
  *
@@ -1357,6 +1812,86 @@ CIF_INTFUNC_DECL(cif_destroy, (
         cif_tp *cif
         ));
 
+/**
+ * @brief Begins a transaction on the specified managed CIF, grouping all subsequent modifications to it into one
+ *        atomic unit until the transaction is ended via @c cif_commit() or @c cif_rollback() .
+ *
+ * While the transaction is open, the library's own functions join it instead of committing their changes
+ * individually, so batching many modifications in one transaction is typically much faster than making them
+ * separately.  A function that fails inside the transaction still reverts its own partial changes, leaving the
+ * transaction open and the effects of earlier functions intact.  Packet iterations may be performed inside the
+ * transaction, but each must be closed or aborted before the transaction ends.  Destroying the CIF while a transaction
+ * is open rolls the transaction back.
+ *
+ * Transactions do not nest.
+ *
+ * @param[in] cif a handle on the managed CIF on which to begin a transaction; must not be NULL
+ *
+ * @return Returns @c CIF_OK on success, @c CIF_MISUSE if a transaction or packet iteration is already underway on
+ *         the CIF, or another error code (typically @c CIF_ERROR ) on failure.
+ */
+CIF_INTFUNC_DECL(cif_begin, (
+        cif_tp *cif
+        ));
+
+/**
+ * @brief Ends the transaction begun on the specified managed CIF via @c cif_begin() , making its changes permanent.
+ *
+ * If the changes cannot be committed then they are rolled back instead, and the transaction is ended anyway.
+ *
+ * @param[in] cif a handle on the managed CIF whose transaction is to be committed; must not be NULL
+ *
+ * @return Returns @c CIF_OK on success, @c CIF_MISUSE if no transaction begun via @c cif_begin() is open on the CIF
+ *         or if a packet iterator is still open on it, or another error code (typically @c CIF_ERROR ) if the
+ *         changes were rolled back instead of being committed.
+ */
+CIF_INTFUNC_DECL(cif_commit, (
+        cif_tp *cif
+        ));
+
+/**
+ * @brief Ends the transaction begun on the specified managed CIF via @c cif_begin() , reverting all changes made to
+ *        the CIF within it.
+ *
+ * @param[in] cif a handle on the managed CIF whose transaction is to be rolled back; must not be NULL
+ *
+ * @return Returns @c CIF_OK on success, @c CIF_MISUSE if no transaction begun via @c cif_begin() is open on the CIF
+ *         or if a packet iterator is still open on it, or another error code (typically @c CIF_ERROR ) on failure.
+ */
+CIF_INTFUNC_DECL(cif_rollback, (
+        cif_tp *cif
+        ));
+
+/**
+ * @brief Indexes the values of the specified item throughout the specified managed CIF, so that selections by those
+ *        values are efficient.
+ *
+ * Predicates that compare the item's values with constants, such as those used with @c cif_loop_select(), are
+ * ordinarily evaluated by examining every packet of the item's loop.  After this function has been called for an
+ * item, such comparisons, whether for equality or for ranges of numeric or character values, instead look up the
+ * matching packets directly.  The index covers the item in every data block and save frame of the CIF, including
+ * loops created after the index, and it is maintained automatically as values are added, modified, and removed.  It
+ * is stored with the CIF, so it persists in CIFs saved via @c cif_save_as() or @c cif_serialize() .
+ *
+ * Indexes carry a cost in the time needed to modify the indexed item's values and in the storage needed for the CIF,
+ * so they are not created by default.  Calling this function for an item that is already indexed has no effect.
+ * The item need not yet be present in the CIF.
+ *
+ * @param[in] cif a handle on the managed CIF in which to index the item's values; must not be NULL
+ *
+ * @param[in] item_name the name of the item whose values are to be indexed, as a NUL-terminated Unicode string;
+ *         must not be NULL.  Item names are matched in caseless and Unicode-normalized form.
+ *
+ * @return @c CIF_OK on success or an error code on failure, normally one of:
+ *        @li @c CIF_INVALID_HANDLE if @p cif is NULL;
+ *        @li @c CIF_INVALID_ITEMNAME if @p item_name is not a valid item name; or
+ *        @li @c CIF_ERROR in most other cases
+ */
+CIF_INTFUNC_DECL(cif_create_value_index, (
+        cif_tp *cif,
+        const UChar *item_name
+        ));
+
 /*
  * There is no cif_clean() or cif_free() -- these would inherently cause
  * resource leakage if they did anything less than cif_destroy() does.
@@ -1928,7 +2463,9 @@ CIF_INTFUNC_DECL(cif_loop_set_category, (
  * @brief Retrieves the item names belonging to the specified loop.
  *
  * The resulting name list takes the form of a NULL-terminated array of NUL-terminated Unicode strings.  The caller
- * assumes responsibility for freeing the individual names and the array containing them.
+ * assumes responsibility for freeing the individual names and the array containing them.  The names are provided in
+ * the order in which the items were added to the loop, which is also the order in which @c cif_pktitr_next_row()
+ * reports the loop's values when iterating over all of them.
  *
  * @param[in] loop a handle on the loop whose item names are requested
  *
@@ -1995,6 +2532,35 @@ CIF_INTFUNC_DECL(cif_loop_add_packet, (
         cif_packet_tp *packet
         ));
 
+/**
+ * @brief Adds a sequence of packets to the specified loop.
+ *
+ * The effect is the same as adding each of the given packets, in order, via @c cif_loop_add_packet(), except that
+ * either all the packets are added or none are.  The same requirements apply to each packet as apply to the packet
+ * passed to @c cif_loop_add_packet().  Adding many packets via one call to this function is considerably more
+ * efficient than adding them one at a time.  The caller retains ownership of the packets and their contents.
+ *
+ * @param[in] loop a handle on the loop to which to add the packets; must be non-NULL and valid
+ *
+ * @param[in] packets a pointer to an array of @p count pointers to the packet objects specifying the values for the
+ *         new packets; must be non-NULL, even if @p count is zero
+ *
+ * @param[in] count the number of packets to add
+ *
+ * @return Returns @c CIF_OK on success, or a characteristic error code on failure, normally one of:
+ *         @li @c CIF_ARGUMENT_ERROR if @p packets is NULL or @p count exceeds @c INT_MAX
+ *         @li @c CIF_INVALID_PACKET if any of the packets is NULL or contains no items
+ *         @li @c CIF_WRONG_LOOP if any packet specifies any items that do not belong to the target loop
+ *         @li @c CIF_RESERVED_LOOP if the target loop is the scalar loop, and it would thereby acquire more than
+ *                one packet
+ *         @li @c CIF_ERROR in most other cases
+ */
+CIF_INTFUNC_DECL(cif_loop_add_packets, (
+        cif_loop_tp *loop,
+        cif_packet_tp **packets,
+        size_t count
+        ));
+
 /**
  * @brief Creates an iterator over the packets in the specified loop.
  *
@@ -2004,7 +2570,9 @@ CIF_INTFUNC_DECL(cif_loop_add_packet, (
  * whether they will be retained if the iterator is aborted or closed unsuccessfully.  As a result of these constraints,
  * users are advised to maintain as few active iterators as feasible for any given CIF, to minimize non-iterator
  * operations performed while any iterator is active on the same target CIF, and to close or abort iterators as
- * soon as possible after they cease to be required.
+ * soon as possible after they cease to be required.  This implementation supports only one active iterator per
+ * managed CIF at a time; this function and the others that create packet iterators fail with code @c CIF_MISUSE
+ * while another iterator on the same CIF is active.
  *
  * @param[in] loop a handle on the loop whose packets are requested; must be non-NULL and valid
  *
@@ -2012,7 +2580,8 @@ CIF_INTFUNC_DECL(cif_loop_add_packet, (
  *
  * @return @c CIF_OK on success or an error code on failure, normally one of:
  *         @li @c CIF_INVALID_HANDLE if the loop handle represents a loop that does not (any longer) exist;
- *         @li @c CIF_EMPTY_LOOP if the target loop contains no packets; or
+ *         @li @c CIF_EMPTY_LOOP if the target loop contains no packets;
+ *         @li @c CIF_MISUSE if another packet iterator is active on the same CIF; or
  *         @li @c CIF_ERROR in most other cases
  */
 CIF_INTFUNC_DECL(cif_loop_get_packets, (
@@ -2020,6 +2589,308 @@ CIF_INTFUNC_DECL(cif_loop_get_packets, (
         cif_pktitr_tp **iterator
         ));
 
+/**
+ * @brief Creates an iterator over the packets in the specified loop that provides values only for selected items.
+ *
+ * This function works exactly as @c cif_loop_get_packets() does, except that the values of items not named in
+ * @p item_names are neither retrieved from the managed CIF nor included in the packets the iterator provides.  When
+ * only a few of a wide loop's items are needed, this avoids reading most of the loop's data.  The packets provided
+ * by @c cif_pktitr_next_row() are likewise restricted to the selected items, which it reports in the same relative
+ * order in which @c cif_loop_get_names() lists them.
+ *
+ * The iterator supports @c cif_pktitr_update_packet() for the selected items only; packets providing values for any
+ * other items are rejected with code @c CIF_WRONG_LOOP .  @c cif_pktitr_remove_packet() removes the whole current
+ * packet, including the values of items that were not selected.
+ *
+ * @param[in] loop a handle on the loop whose packets are requested; must be non-NULL and valid
+ *
+ * @param[in] item_names a NULL-terminated array of the names of the items whose values are requested; must contain
+ *         at least one name, and each name must belong to the loop.  Names that differ only after normalization
+ *         designate the same item, and naming an item more than once is not an error.
+ *
+ * @param[in,out] iterator the location where a pointer to the iterator object should be written; must not be NULL
+ *
+ * @return @c CIF_OK on success or an error code on failure, normally one of:
+ *         @li @c CIF_INVALID_HANDLE if the loop handle represents a loop that does not (any longer) exist;
+ *         @li @c CIF_ARGUMENT_ERROR if @p item_names is NULL or empty;
+ *         @li @c CIF_INVALID_ITEMNAME if one of the specified names is not a valid item name;
+ *         @li @c CIF_WRONG_LOOP if one of the specified items does not belong to the loop;
+ *         @li @c CIF_EMPTY_LOOP if the target loop contains no packets; or
+ *         @li @c CIF_ERROR in most other cases
+ */
+CIF_INTFUNC_DECL(cif_loop_get_packets_for, (
+        cif_loop_tp *loop,
+        UChar *item_names[],
+        cif_pktitr_tp **iterator
+        ));
+
+/**
+ * @brief Creates an iterator over those packets of the specified loop that satisfy the specified predicate.
+ *
+ * This function works exactly as @c cif_loop_get_packets() does, except that the iterator skips packets that do
+ * not satisfy @p predicate .  The predicate is evaluated by the managed CIF's storage engine, so packets that do not
+ * satisfy it are never read.  The packets that are provided are the same, and in the same order, as those that
+ * @c cif_loop_get_packets() would provide for the same loop and that satisfy the predicate.  If no packets satisfy
+ * the predicate then the iterator is created successfully, but @c cif_pktitr_next_packet() returns
+ * @c CIF_FINISHED on the first call.
+ *
+ * The predicate belongs to the caller; it may be released or reused as soon as this function returns.
+ *
+ * @param[in] loop a handle on the loop whose packets are requested; must be non-NULL and valid
+ *
+ * @param[in] predicate the condition that the iterated packets must satisfy; must not be NULL.  All the items it
+ *         refers to must belong to the loop.
+ *
+ * @param[in,out] iterator the location where a pointer to the iterator object should be written; must not be NULL
+ *
+ * @return @c CIF_OK on success or an error code on failure, normally one of:
+ *         @li @c CIF_INVALID_HANDLE if the loop handle represents a loop that does not (any longer) exist;
+ *         @li @c CIF_ARGUMENT_ERROR if @p predicate is NULL;
+ *         @li @c CIF_WRONG_LOOP if the predicate refers to an item that does not belong to the loop; or
+ *         @li @c CIF_ERROR in most other cases
+ */
+CIF_INTFUNC_DECL(cif_loop_select, (
+        cif_loop_tp *loop,
+        const cif_predicate_tp *predicate,
+        cif_pktitr_tp **iterator
+        ));
+
+/**
+ * @brief Creates an iterator over the packets formed by joining the packets of two loops on a key item of each.
+ *
+ * Each packet provided by the iterator merges one packet of @p left_loop with one packet of @p right_loop whose
+ * value for @p right_item equals the left packet's value for @p left_item .  The iterator provides one packet for
+ * each such pair, ordered first by the left loop's packet order and then by the right loop's, and each of its
+ * packets contains all the items of both loops.  Character values match character values having exactly the same
+ * text, and numbers match numbers having the same numeric value; values of other kinds never match, nor do numbers
+ * match character values.  Character keys are compared as stored, code unit by code unit: unlike item names and
+ * block codes, they are not normalized or case-folded, so values that differ only in Unicode normalization form or
+ * in case do not match.  The join is performed by the managed CIF's storage engine in a single query, so packets
+ * that do not match are never read.  If no packets match then the iterator is created successfully, but
+ * @c cif_pktitr_next_packet() returns @c CIF_FINISHED on the first call.
+ *
+ * The two loops must belong to the same CIF and must not have any items in common, so a loop cannot be joined to
+ * itself.  Joined packets do not correspond to stored packets, so the resulting iterator cannot be used to update
+ * or remove packets: @c cif_pktitr_update_packet() and @c cif_pktitr_remove_packet() fail on it with code
+ * @c CIF_NOT_SUPPORTED .  Otherwise, it behaves as one obtained from @c cif_loop_get_packets() .
+ *
+ * @param[in] left_loop a handle on the loop whose packets are to be joined from the left; must be non-NULL and valid
+ *
+ * @param[in] left_item the name of the key item of @p left_loop ; must not be NULL
+ *
+ * @param[in] right_loop a handle on the loop whose packets are to be joined from the right; must be non-NULL and
+ *         valid
+ *
+ * @param[in] right_item the name of the key item of @p right_loop ; must not be NULL
+ *
+ * @param[in,out] iterator the location where a pointer to the iterator object should be written; must not be NULL
+ *
+ * @return @c CIF_OK on success or an error code on failure, normally one of:
+ *         @li @c CIF_INVALID_HANDLE if either loop handle represents a loop that does not (any longer) exist;
+ *         @li @c CIF_ARGUMENT_ERROR if @p iterator is NULL or the loops belong to different CIFs;
+ *         @li @c CIF_INVALID_ITEMNAME if either key item name is not a valid item name;
+ *         @li @c CIF_WRONG_LOOP if either key item does not belong to its loop;
+ *         @li @c CIF_DUP_ITEMNAME if the loops have an item in common;
+ *         @li @c CIF_MISUSE if another packet iterator is active on the same CIF; or
+ *         @li @c CIF_ERROR in most other cases
+ */
+CIF_INTFUNC_DECL(cif_loop_join, (
+        cif_loop_tp *left_loop,
+        const UChar *left_item,
+        cif_loop_tp *right_loop,
+        const UChar *right_item,
+        cif_pktitr_tp **iterator
+        ));
+
+/**
+ * @brief Retrieves the numeric values of one item of the specified loop, in packet order, as arrays of @c double .
+ *
+ * This is a much cheaper alternative to iterating over the loop's packets when only one item's numeric values are
+ * needed: the values are copied directly from storage into the result arrays, without creating any value objects.
+ * Packets are presented in the same order in which @c cif_loop_get_packets() iterates over them.  For each packet,
+ * the corresponding element of @p kinds records the kind of the item's value; where that is @c CIF_NUMB_KIND , the
+ * corresponding elements of @p values and @p sus record the number and its standard uncertainty (zero for exact
+ * numbers), as @c cif_value_get_number() and @c cif_value_get_su() would report them.  For values of all other
+ * kinds, including character values that could be interpreted as numbers, both are set to zero.
+ *
+ * On success, the caller assumes responsibility for freeing the result arrays, even if @p *count is zero.
+ *
+ * @param[in] loop a handle on the loop from which to retrieve values; must be non-NULL and valid
+ * @param[in] item_name the name of the item whose values are requested, as a NUL-terminated Unicode string; must not
+ *         be NULL
+ * @param[out] values the location where a pointer to an array of the numeric values should be recorded; must not be
+ *         NULL
+ * @param[out] sus the location where a pointer to an array of the standard uncertainties of the values should be
+ *         recorded, or NULL if they are not wanted
+ * @param[out] kinds the location where a pointer to an array of the kinds of the values should be recorded, or NULL if
+ *         they are not wanted
+ * @param[out] count the location where the number of elements in each result array (the number of packets in the
+ *         loop) should be recorded; must not be NULL
+ *
+ * @return @c CIF_OK on success or an error code on failure, normally one of:
+ *         @li @c CIF_INVALID_HANDLE if the loop handle represents a loop that does not (any longer) exist;
+ *         @li @c CIF_INVALID_ITEMNAME if @p item_name is not a valid item name;
+ *         @li @c CIF_WRONG_LOOP if the named item does not belong to the loop;
+ *         @li @c CIF_ARGUMENT_ERROR if @p values or @p count is NULL;
+ *         @li @c CIF_MEMORY_ERROR if the result arrays cannot be allocated; or
+ *         @li @c CIF_ERROR in most other cases
+ */
+CIF_INTFUNC_DECL(cif_loop_get_column_doubles, (
+        cif_loop_tp *loop,
+        const UChar *item_name,
+        double **values,
+        double **sus,
+        cif_kind_tp **kinds,
+        size_t *count
+        ));
+
+/**
+ * @brief Computes summary statistics of the values of one item of the specified loop.
+ *
+ * This is a much cheaper alternative to iterating over the loop's packets or retrieving the item's values via
+ * @c cif_loop_get_column_doubles() when only the item's count, range, sum, or mean are needed: the statistics are
+ * computed by the managed CIF's storage engine, directly from the stored numbers.  The values of every kind are
+ * counted, but only numeric values contribute to the other statistics; in particular, character values that could be
+ * interpreted as numbers do not.
+ *
+ * @param[in] loop a handle on the loop whose values are to be summarized; must be non-NULL and valid
+ * @param[in] item_name the name of the item whose values are to be summarized, as a NUL-terminated Unicode string;
+ *         must not be NULL
+ * @param[out] aggregate a pointer to the structure in which to record the statistics; must not be NULL.  Its contents
+ *         are modified only on success.
+ *
+ * @return @c CIF_OK on success or an error code on failure, normally one of:
+ *         @li @c CIF_INVALID_HANDLE if the loop handle represents a loop that does not (any longer) exist;
+ *         @li @c CIF_INVALID_ITEMNAME if @p item_name is not a valid item name;
+ *         @li @c CIF_WRONG_LOOP if the named item does not belong to the loop;
+ *         @li @c CIF_ARGUMENT_ERROR if @p aggregate is NULL; or
+ *         @li @c CIF_ERROR in most other cases
+ */
+CIF_INTFUNC_DECL(cif_loop_aggregate, (
+        cif_loop_tp *loop,
+        const UChar *item_name,
+        cif_aggregate_tp *aggregate
+        ));
+
+/**
+ * @}
+ *
+ * @defgroup predicate_funcs Functions for constructing packet predicates
+ *
+ * @{
+ *
+ * A predicate, used with @c cif_loop_select(), is a tree whose leaves compare the value of one loop item with a
+ * constant, and whose interior nodes combine the results of their two children by logical conjunction or
+ * disjunction.  Numeric comparisons are satisfied only by numeric values ( @c CIF_NUMB_KIND ), and compare the
+ * values' numeric magnitudes, disregarding their standard uncertainties.  Character comparisons are satisfied only by
+ * character and numeric values, and compare those values' text, codepoint by codepoint.  No comparison is
+ * satisfied by a list, table, unknown, or not-applicable value, not even a @c CIF_CMP_NE comparison.
+ */
+
+/**
+ * @brief Creates a predicate comparing the numeric value of the specified item with a constant.
+ *
+ * @param[in,out] predicate the location where a pointer to the new predicate should be recorded; must not be NULL.
+ *         The caller becomes responsible for the new predicate, which should be released via @c cif_predicate_free()
+ *         when no longer needed, unless responsibility for it is transferred to another predicate.
+ *
+ * @param[in] item_name the name of the item whose value is compared; must not be NULL
+ *
+ * @param[in] comparison the comparison to perform, as "value comparison constant"
+ *
+ * @param[in] value the constant with which values are compared
+ *
+ * @return @c CIF_OK on success or an error code on failure, normally one of:
+ *         @li @c CIF_INVALID_ITEMNAME if @p item_name is not a valid item name;
+ *         @li @c CIF_ARGUMENT_ERROR if @p comparison is not a valid comparison code; or
+ *         @li @c CIF_MEMORY_ERROR if memory cannot be allocated for the predicate
+ */
+CIF_INTFUNC_DECL(cif_predicate_create_numb, (
+        cif_predicate_tp **predicate,
+        const UChar *item_name,
+        cif_compare_tp comparison,
+        double value
+        ));
+
+/**
+ * @brief Creates a predicate comparing the text of the specified item's value with a constant string.
+ *
+ * @param[in,out] predicate the location where a pointer to the new predicate should be recorded; must not be NULL.
+ *         The caller becomes responsible for the new predicate, which should be released via @c cif_predicate_free()
+ *         when no longer needed, unless responsibility for it is transferred to another predicate.
+ *
+ * @param[in] item_name the name of the item whose value is compared; must not be NULL
+ *
+ * @param[in] comparison the comparison to perform, as "value comparison constant"
+ *
+ * @param[in] text the NUL-terminated Unicode string with which values are compared; must not be NULL.  Ownership of
+ *         this string is not transferred by passing it to this function.
+ *
+ * @return @c CIF_OK on success or an error code on failure, normally one of:
+ *         @li @c CIF_INVALID_ITEMNAME if @p item_name is not a valid item name;
+ *         @li @c CIF_ARGUMENT_ERROR if @p comparison is not a valid comparison code or @p text is NULL; or
+ *         @li @c CIF_MEMORY_ERROR if memory cannot be allocated for the predicate
+ */
+CIF_INTFUNC_DECL(cif_predicate_create_char, (
+        cif_predicate_tp **predicate,
+        const UChar *item_name,
+        cif_compare_tp comparison,
+        const UChar *text
+        ));
+
+/**
+ * @brief Creates a predicate satisfied by packets that satisfy both of two other predicates.
+ *
+ * On success, the new predicate assumes responsibility for @p left and @p right , which are released when it is.
+ * On failure, responsibility for them remains with the caller.
+ *
+ * @param[in,out] predicate the location where a pointer to the new predicate should be recorded; must not be NULL
+ *
+ * @param[in] left the first of the predicates to combine; must not be NULL
+ *
+ * @param[in] right the second of the predicates to combine; must not be NULL, and must not be the same object as
+ *         @p left or any part of it
+ *
+ * @return @c CIF_OK on success, @c CIF_ARGUMENT_ERROR if either operand is NULL, or @c CIF_MEMORY_ERROR if memory
+ *         cannot be allocated for the predicate
+ */
+CIF_INTFUNC_DECL(cif_predicate_create_and, (
+        cif_predicate_tp **predicate,
+        cif_predicate_tp *left,
+        cif_predicate_tp *right
+        ));
+
+/**
+ * @brief Creates a predicate satisfied by packets that satisfy either or both of two other predicates.
+ *
+ * On success, the new predicate assumes responsibility for @p left and @p right , which are released when it is.
+ * On failure, responsibility for them remains with the caller.
+ *
+ * @param[in,out] predicate the location where a pointer to the new predicate should be recorded; must not be NULL
+ *
+ * @param[in] left the first of the predicates to combine; must not be NULL
+ *
+ * @param[in] right the second of the predicates to combine; must not be NULL, and must not be the same object as
+ *         @p left or any part of it
+ *
+ * @return @c CIF_OK on success, @c CIF_ARGUMENT_ERROR if either operand is NULL, or @c CIF_MEMORY_ERROR if memory
+ *         cannot be allocated for the predicate
+ */
+CIF_INTFUNC_DECL(cif_predicate_create_or, (
+        cif_predicate_tp **predicate,
+        cif_predicate_tp *left,
+        cif_predicate_tp *right
+        ));
+
+/**
+ * @brief Releases the specified predicate, together with all the predicates it combines.
+ *
+ * @param[in,out] predicate a pointer to the predicate to release; if NULL then this function does nothing
+ */
+CIF_VOIDFUNC_DECL(cif_predicate_free, (
+        cif_predicate_tp *predicate
+        ));
+
 /**
  * @}
  *
@@ -2126,6 +2997,71 @@ CIF_INTFUNC_DECL(cif_pktitr_next_packet, (
         cif_packet_tp **packet
         ));
 
+/**
+ * @brief Advances a packet iterator to the next packet, if any, and records that packet's values in a caller-provided
+ *         array of value handles.
+ *
+ * This is a lighter-weight alternative to @c cif_pktitr_next_packet() for reading large loops.  Instead of building a
+ * packet keyed by item name, it records each value in the element of @p row corresponding to the value's item.  The
+ * row has one element for each of the iterator's items, in the order in which @c cif_pktitr_get_names() lists them:
+ * @li for an iterator obtained from @c cif_loop_get_packets() or @c cif_loop_select() , all the items of the loop,
+ *         in the same order in which @c cif_loop_get_names() lists them;
+ * @li for an iterator obtained from @c cif_loop_get_packets_for() , only the selected items, in that same relative
+ *         order; and
+ * @li for an iterator obtained from @c cif_loop_join() , all the items of the left loop in that order, followed by
+ *         all the items of the right loop in that order.
+ *
+ * Any element of @p row that is NULL on entry is set to a new value object, which becomes the responsibility of the
+ * caller; value objects already present are cleaned and reused.  Passing the same array on each call therefore
+ * allocates value objects only for the first packet, and no item names are looked up or converted at all.  Items for
+ * which the packet has no value are reported as unknown-value (@c CIF_UNK_KIND ) values.
+ *
+ * The packet read this way becomes the iterator's current packet exactly as if it had been read via
+ * @c cif_pktitr_next_packet() , so it may subsequently be updated or removed via the iterator.
+ *
+ * If no more packets are available from the iterator's loop then @c CIF_FINISHED is returned.
+ *
+ * @param[in,out] iterator a pointer to the packet iterator from which the next packet is requested
+ *
+ * @param[in,out] row an array of value handles with one element for each of the iterator's items, as described
+ *         above; must not be NULL.  Each element must be either NULL or a handle on a value object owned by the
+ *         caller.
+ *
+ * @return On success returns @c CIF_OK if the iterator successfully advanced, @c CIF_FINISHED if there were no
+ *         more packets available.  Returns @c CIF_ARGUMENT_ERROR if @p row is NULL, or another error code on
+ *         failure (typically @c CIF_ERROR ), in which case the contents of the values in @p row are undefined (but
+ *         valid)
+ */
+CIF_INTFUNC_DECL(cif_pktitr_next_row, (
+        cif_pktitr_tp *iterator,
+        cif_value_tp **row
+        ));
+
+/**
+ * @brief Retrieves the names of the items for which the specified packet iterator provides values.
+ *
+ * The names are provided in the order in which @c cif_pktitr_next_row() records the items' values, so the number of
+ * names is the number of elements that function requires of its @p row argument, and the name at each index
+ * identifies the item whose values are recorded at the same index of the row.  The names are in normalized form,
+ * as are the names of the packets provided by @c cif_pktitr_next_packet() .
+ *
+ * It is the caller's responsibility to release the resulting array, but its elements @b MUST @b NOT be modified or
+ * freed.  They belong to the iterator, and remain valid until it is closed or aborted.
+ *
+ * @param[in] iterator a pointer to the packet iterator whose item names are requested; must be a non-NULL pointer to
+ *         an active iterator
+ *
+ * @param[in,out] names the location where a pointer to the array of names should be written; must not be NULL.  The
+ *         array will be NULL-terminated.
+ *
+ * @return Returns @c CIF_OK on success, @c CIF_ARGUMENT_ERROR if @p names is NULL, or an error code (typically
+ *         @c CIF_MEMORY_ERROR ) on failure
+ */
+CIF_INTFUNC_DECL(cif_pktitr_get_names, (
+        cif_pktitr_tp *iterator,
+        const UChar ***names
+        ));
+
 /**
  * @brief Updates the last packet iterated by the specified iterator with the values from the provided packet.
  *
@@ -2144,6 +3080,7 @@ CIF_INTFUNC_DECL(cif_pktitr_next_packet, (
  *         @li @c CIF_MISUSE if the iterator has no current packet (because it has not yet provided one, or because the
  *              one most recently provided has been removed
  *         @li @c CIF_WRONG_LOOP if the packet provides an item that does not belong to the iterator's loop
+ *         @li @c CIF_NOT_SUPPORTED if the iterator was created by @c cif_loop_join()
  *         @li @c CIF_ERROR in most other cases
  */
 CIF_INTFUNC_DECL(cif_pktitr_update_packet, (
@@ -2163,6 +3100,7 @@ CIF_INTFUNC_DECL(cif_pktitr_update_packet, (
  *         of:
  *         @li @c CIF_MISUSE if the iterator has no current packet (because it has not yet provided one, or because the
  *              one most recently provided has been removed via this function
+ *         @li @c CIF_NOT_SUPPORTED if the iterator was created by @c cif_loop_join()
  *         @li @c CIF_ERROR in most other cases
  */
 CIF_INTFUNC_DECL(cif_pktitr_remove_packet, (
@@ -24,6 +24,14 @@
 #include "config.h"
 #endif
 
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MMAP)
+#define MAP_INPUT_FILES
+#ifndef _POSIX_C_SOURCE
+/* expose the POSIX file mapping interfaces, which strict ISO C modes otherwise hide */
+#define _POSIX_C_SOURCE 200112L
+#endif
+#endif
+
 #include "internal/compat.h"
 
 #include <stdio.h>
@@ -34,6 +42,13 @@
 #include <unistd.h>
 #endif
 
+#ifdef MAP_INPUT_FILES
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#endif
+
 #include <unicode/ustring.h>
 #include <unicode/ustdio.h>
 #include <unicode/ucsdet.h>
@@ -72,6 +87,8 @@ typedef struct {
     unsigned char *buffer_position;
     unsigned char *buffer_limit;
     UConverter *converter;
+    const struct scanner_s *scanner;  /* the scanner consuming the characters, to which errors are reported */
+    UChar pending_trail;              /* a trail surrogate decoded but not yet delivered, or 0 if there is none */
     /*
      *   0 if EOF has not yet been detected;
      * < 0 if EOF has been detected, but data may not all have been converted;
@@ -138,6 +155,11 @@ static const char header_type[2][10] = { "\ndata_%S\n", "\nsave_%S\n" };
 static void ustream_to_unicode_callback(const void *context, UConverterToUnicodeArgs *args, const char *codeUnits,
         int32_t length, UConverterCallbackReason reason, UErrorCode *error_code);
 static ssize_t ustream_read_chars(void *char_source, UChar *dest, ssize_t count, int *error_code);
+static ssize_t utf8_read_chars(void *char_source, UChar *dest, ssize_t count, int *error_code);
+static int ustream_refill(uchar_stream_t *ustream, size_t retained);
+static int parse_ustream(uchar_stream_t *ustream, struct cif_parse_opts_s *options, cif_tp **cifp);
+static int open_ustream(uchar_stream_t *ustream, struct cif_parse_opts_s *options, struct scanner_s *scanner,
+        int *not_utf8);
 
 /*
  * CIF handler functions used by write_cif()
@@ -271,7 +293,7 @@ static cif_handler_tp DEFAULT_CIF_HANDLER = { NULL, NULL, NULL, NULL, NULL, NULL
 
 /* The CIF parsing options used when none are provided by the caller */
 static struct cif_parse_opts_s DEFAULT_OPTIONS =
-        { 0, NULL, 0, 0, 0, 1, NULL, NULL, &DEFAULT_CIF_HANDLER, NULL, NULL, NULL, cif_parse_error_die, NULL };
+        { 0, NULL, 0, 0, 0, 1, NULL, NULL, &DEFAULT_CIF_HANDLER, NULL, NULL, NULL, cif_parse_error_die, NULL, 0 };
 
 /* The length of the basic magic code identifying many CIFs (including all well-formed CIF 2.0 CIFs): "#\#CIF_" */
 #define MAGIC_LENGTH 7
@@ -287,6 +309,9 @@ static const char CIF2_UTF8_MAGIC[MAGIC_LENGTH + MAGIC_EXTRA + 1] = "\x23\x5c\x2
 
 static const char UTF8[6] = "UTF-8";
 
+/* The maximum number of initial bytes to examine for a Unicode signature; more than any signature requires */
+#define SIGNATURE_SCAN_LENGTH 4096
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -357,15 +382,271 @@ int cif_write_options_create(struct cif_write_opts_s **opts) {
  */
 #define BUFFER_SIZE  4096
 int cif_parse(FILE *stream, struct cif_parse_opts_s *options, cif_tp **cifp) {
-    FAILURE_HANDLING;
     unsigned char buffer[BUFFER_SIZE];
-    size_t count;
-    cif_tp *cif;
-    const char *encoding_name;
     uchar_stream_t ustream;
-    UErrorCode error_code = U_ZERO_ERROR;
-    int cif_version;
+
+    /* character source */
+    ustream.byte_stream = stream;
+    ustream.byte_buffer = buffer;
+    ustream.buffer_size = BUFFER_SIZE;
+    ustream.buffer_position = buffer;
+    ustream.buffer_limit = buffer;
+    ustream.eof_status = 0;
+
+    if ((options == NULL) || (options->force_default_encoding == 0)) {
+        /* read the initial bytes from which to guess the character encoding */
+        size_t count = fread(buffer, 1, BUFFER_SIZE, stream);  /* returns a short count only if there isn't enough data */
+
+        if ((count < BUFFER_SIZE) && ferror(stream)) {
+            return CIF_ERROR;
+        }
+        ustream.buffer_limit = buffer + count;
+    }
+
+    return parse_ustream(&ustream, options, cifp);
+}
+#undef BUFFER_SIZE
+
+/*
+ * Parses a CIF from the specified bytes.  The bytes serve directly as the converter's input buffer, so they are
+ * neither copied nor read through a stream; they are never modified.
+ */
+int cif_parse_buffer(const void *bytes, size_t length, struct cif_parse_opts_s *options, cif_tp **cifp) {
+    uchar_stream_t ustream;
+
+    if ((bytes == NULL) && (length > 0)) {
+        return CIF_ARGUMENT_ERROR;
+    }
+
+    /* the buffer holds the whole input, so no byte stream is needed */
+    ustream.byte_stream = NULL;
+    ustream.byte_buffer = (unsigned char *) bytes;  /* casts away const, but the bytes are only read */
+    ustream.buffer_size = length;
+    ustream.buffer_position = ustream.byte_buffer;
+    ustream.buffer_limit = ustream.byte_buffer + length;
+    ustream.eof_status = -1;
+
+    return parse_ustream(&ustream, options, cifp);
+}
+
+/*
+ * Parses a CIF from the file at the specified path.  Where the system supports it, the file is mapped into memory and
+ * converted directly from the mapping, so that its bytes are neither read through stdio nor copied into an
+ * intermediate buffer.  Files that cannot be mapped, such as pipes and empty files, are instead read as streams via
+ * cif_parse().
+ */
+int cif_parse_file(const char *path, struct cif_parse_opts_s *options, cif_tp **cifp) {
+    FILE *stream;
+    int result;
+#ifdef MAP_INPUT_FILES
+    int fd;
+    struct stat file_stat;
+#endif
+
+    if (path == NULL) {
+        return CIF_ARGUMENT_ERROR;
+    }
+
+#ifdef MAP_INPUT_FILES
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return CIF_ERROR;
+    }
+
+    if ((fstat(fd, &file_stat) == 0) && S_ISREG(file_stat.st_mode) && (file_stat.st_size > 0)
+            && ((off_t) (size_t) file_stat.st_size == file_stat.st_size)) {
+        size_t size = (size_t) file_stat.st_size;
+        void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mapping != MAP_FAILED) {
+            /* the mapping remains valid after the descriptor is closed */
+            close(fd);
+
+#ifdef HAVE_POSIX_MADVISE
+            /* the input is consumed front to back exactly once, so aggressive read-ahead is appropriate */
+            (void) posix_madvise(mapping, size, POSIX_MADV_SEQUENTIAL);
+#endif
+
+            result = cif_parse_buffer(mapping, size, options, cifp);
+            (void) munmap(mapping, size);
+
+            return result;
+        }
+    }
+
+    /* fall back to parsing the file as a stream */
+    stream = fdopen(fd, "rb");
+    if (stream == NULL) {
+        close(fd);
+        return CIF_ERROR;
+    }
+#else
+    stream = fopen(path, "rb");
+    if (stream == NULL) {
+        return CIF_ERROR;
+    }
+#endif
+
+    result = cif_parse(stream, options, cifp);
+    fclose(stream);
+
+    return result;
+}
+
+/* the number of bytes a reader buffers from its stream at a time */
+#define READER_BUFFER_SIZE  4096
+/*
+ * Opens a pull reader on the specified stream.  The reader's character source and that source's byte buffer are
+ * allocated together, and both, like the reader's scanner, stay at fixed addresses for the life of the reader, as the
+ * character conversion callbacks require.
+ */
+int cif_reader_open(FILE *stream, struct cif_parse_opts_s *options, cif_reader_tp **reader) {
+    FAILURE_HANDLING;
+    struct cif_reader_s *temp;
+    uchar_stream_t *ustream;
+    int not_utf8;
+    int result;
+
+    if ((stream == NULL) || (reader == NULL)) {
+        return CIF_ARGUMENT_ERROR;
+    }
+
+    if (options == NULL) {
+        options = &DEFAULT_OPTIONS;
+    }
+
+    temp = (struct cif_reader_s *) calloc(1, sizeof(struct cif_reader_s));
+    if (temp == NULL) {
+        return CIF_MEMORY_ERROR;
+    }
+    /* explicitly initialize the pointer members on which cleanup relies */
+    temp->scanner.buffer = NULL;
+    temp->loop_names = NULL;
+    temp->name = NULL;
+    temp->value = NULL;
+
+    ustream = (uchar_stream_t *) malloc(sizeof(uchar_stream_t) + READER_BUFFER_SIZE);
+    if (ustream == NULL) {
+        free(temp);
+        return CIF_MEMORY_ERROR;
+    }
+
+    /* character source */
+    ustream->byte_stream = stream;
+    ustream->byte_buffer = (unsigned char *) (ustream + 1);
+    ustream->buffer_size = READER_BUFFER_SIZE;
+    ustream->buffer_position = ustream->byte_buffer;
+    ustream->buffer_limit = ustream->byte_buffer;
+    ustream->eof_status = 0;
+    ustream->converter = NULL;
+    temp->scanner.char_source = ustream;
+
+    if (options->force_default_encoding == 0) {
+        /* read the initial bytes from which to guess the character encoding */
+        size_t count = fread(ustream->byte_buffer, 1, READER_BUFFER_SIZE, stream);
+
+        if ((count < READER_BUFFER_SIZE) && ferror(stream)) {
+            DEFAULT_FAIL(soft);
+        }
+        ustream->buffer_limit = ustream->byte_buffer + count;
+    }
+
+    if ((result = open_ustream(ustream, options, &temp->scanner, &not_utf8)) != CIF_OK) {
+        FAIL(soft, result);
+    } else if (ustream->converter == NULL) {
+        /* empty input */
+        temp->finished = CIF_TRUE;
+    } else if ((result = cif_reader_start(temp, not_utf8, options->extra_ws_chars, options->extra_eol_chars))
+            != CIF_OK) {
+        FAIL(soft, result);
+    }
+
+    *reader = temp;
+    return CIF_OK;
+
+    FAILURE_HANDLER(soft):
+    if (ustream->converter != NULL) {
+        ucnv_close(ustream->converter);
+    }
+    free(ustream);
+    cif_reader_free(temp);
+
+    FAILURE_TERMINUS;
+}
+#undef READER_BUFFER_SIZE
+
+int cif_reader_close(cif_reader_tp *reader) {
+    if (reader != NULL) {
+        uchar_stream_t *ustream = (uchar_stream_t *) reader->scanner.char_source;
+
+        if (ustream->converter != NULL) {
+            ucnv_close(ustream->converter);
+        }
+        free(ustream);
+        cif_reader_free(reader);
+    }
+
+    return CIF_OK;
+}
+
+/*
+ * Formats the CIF data represented by the 'cif' handle to the specified
+ * output.
+ */
+int cif_write(FILE *stream, struct cif_write_opts_s *options, cif_tp *cif) {
+    cif_handler_tp handler = {
+        write_cif_start,
+        write_cif_end,
+        write_container_start,
+        write_container_end,
+        write_container_start,
+        write_container_end,
+        write_loop_start,
+        write_loop_end,
+        write_packet_start,
+        write_packet_end,
+        write_item
+    };
+    UFILE *u_stream;
+    int result;
+
+    if (options && (options->cif_version == 1)) {
+        u_stream = u_finit(stream, NULL, NULL);
+    } else {
+        u_stream = u_finit(stream, "C", "UTF_8");
+    }
+
+    if (u_stream != NULL) {
+        CONTEXT_S context;
+
+        CONTEXT_INITIALIZE(context, u_stream);
+        if (options && (options->cif_version == 1)) {
+            context.version = 1;
+        }
+        result = cif_walk(cif, &handler, &context);
+
+        /* TODO: handle errors */
+        u_fclose(u_stream);
+        return result;
+    } else {
+        return CIF_ERROR;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/*
+ * Parses a CIF from the specified character source, whose byte buffer initially holds the first bytes of the input.
+ * Unless the options force use of the default encoding, the character encoding is guessed from those bytes, and the
+ * input is taken to be empty if there are none.  The source's converter is managed by this function, but all other
+ * members of the source must be initialized by the caller.
+ */
+static int parse_ustream(uchar_stream_t *ustream, struct cif_parse_opts_s *options, cif_tp **cifp) {
+    cif_tp *cif;
     struct scanner_s scanner;
+    int not_utf8;
     int result;
 
     if (options == NULL) {
@@ -380,6 +661,33 @@ int cif_parse(FILE *stream, struct cif_parse_opts_s *options, cif_tp **cifp) {
         return result;
     }
 
+    result = open_ustream(ustream, options, &scanner, &not_utf8);
+    if ((result == CIF_OK) && (ustream->converter != NULL)) {
+        /* perform the actual parse */
+        result = cif_parse_internal(&scanner, not_utf8, options->extra_ws_chars, options->extra_eol_chars, cif);
+        ucnv_close(ustream->converter);
+    } /* else an error, or an empty input and therefore an empty CIF */
+
+    return result;
+}
+
+/*
+ * Chooses the character encoding and initial CIF version for the specified character source, opens its converter,
+ * and prepares the specified scanner to read from it according to the specified (non-NULL) options.  The scanner's
+ * buffer is not touched.  On success, the caller is responsible for closing the source's converter, unless it is left
+ * NULL to signal that the input is empty.  The flag pointed to by not_utf8 is set to indicate whether the chosen
+ * encoding is other than UTF-8.
+ */
+static int open_ustream(uchar_stream_t *ustream, struct cif_parse_opts_s *options, struct scanner_s *scanner,
+        int *not_utf8) {
+    FAILURE_HANDLING;
+    size_t count;
+    const char *encoding_name;
+    UErrorCode error_code = U_ZERO_ERROR;
+    int cif_version;
+
+    ustream->converter = NULL;
+
     if (options->prefer_cif2 > 19) {
         cif_version = 2;
     } else if (options->prefer_cif2 < 0) {
@@ -397,19 +705,18 @@ int cif_parse(FILE *stream, struct cif_parse_opts_s *options, cif_tp **cifp) {
     } else {
         /* attempt to guess the character encoding based on the first few bytes of the stream */
 
-        char *char_buffer = (char *) buffer;
+        char *char_buffer = (char *) ustream->buffer_position;
 
-        count = fread(char_buffer, 1, BUFFER_SIZE, stream);  /* returns a short count only if there isn't enough data */
-        if ((count < BUFFER_SIZE) && ferror(stream)) {
-            DEFAULT_FAIL(early);
-        } else if (count == 0) {
+        count = (size_t) (ustream->buffer_limit - ustream->buffer_position);
+        if (count == 0) {
             /* simplest possible case: empty file --> empty CIF */
             return CIF_OK;
         } else {
             int32_t sig_length;
 
             /* Look for a Unicode signature (a BOM encoded at the beginning of the stream) */
-            encoding_name = ucnv_detectUnicodeSignature(char_buffer, count, &sig_length, &error_code);
+            encoding_name = ucnv_detectUnicodeSignature(char_buffer, (int32_t) MIN(count, SIGNATURE_SCAN_LENGTH),
+                    &sig_length, &error_code);
             if (U_FAILURE(error_code)) {
                 /* TODO: verify that ICU's idea of failure is what we really want here */
                 DEFAULT_FAIL(early);
@@ -451,109 +758,55 @@ int cif_parse(FILE *stream, struct cif_parse_opts_s *options, cif_tp **cifp) {
 
     /* encoding identified, or knowingly defaulted */
 
-    ustream.converter = ucnv_open(encoding_name, &error_code); /* XXX: is any other customization needed? */
+    ustream->converter = ucnv_open(encoding_name, &error_code); /* XXX: is any other customization needed? */
     if (U_SUCCESS(error_code)) {
-        const char *converter_name = ucnv_getName(ustream.converter, &error_code);  /* belongs to ustream.converter */
+        const char *converter_name = ucnv_getName(ustream->converter, &error_code);  /* belongs to ustream->converter */
 
-        ucnv_setToUCallBack(ustream.converter, ustream_to_unicode_callback, &scanner, NULL, NULL, &error_code);
+        ucnv_setToUCallBack(ustream->converter, ustream_to_unicode_callback, scanner, NULL, NULL, &error_code);
 
         if (U_FAILURE(error_code)) {
-            result = CIF_ERROR;
+            ucnv_close(ustream->converter);
+            ustream->converter = NULL;
+            return CIF_ERROR;
         } else {
             /* XXX: this test is probably too simplistic: */
-            int not_utf8 = strcmp("UTF-8", converter_name);
+            *not_utf8 = strcmp("UTF-8", converter_name);
 
             /* set up those properties of the scanner that derive from caller input */
 
             /* character source */
-            ustream.byte_stream = stream;
-            ustream.byte_buffer = buffer;
-            ustream.buffer_size = BUFFER_SIZE;
-            ustream.buffer_position = buffer;
-            ustream.buffer_limit = buffer + count;
-            ustream.eof_status = 0;
-            ustream.last_error = 0; /* this is a _user_ error code, not necessarily a CIF code */
+            ustream->scanner = scanner;
+            ustream->pending_trail = 0;
+            ustream->last_error = 0; /* this is a _user_ error code, not necessarily a CIF code */
 
             /* scanner details */
-            scanner.char_source = &ustream;
-            scanner.read_func = ustream_read_chars;
-            scanner.at_eof = CIF_FALSE;
-            scanner.cif_version = cif_version;
-            scanner.line_unfolding = MIN(options->line_folding_modifier, 1);
-            scanner.prefix_removing = MIN(options->text_prefixing_modifier, 1);
-            scanner.max_frame_depth = MIN(options->max_frame_depth, 1);
-            scanner.handler = ((options->handler == NULL) ? DEFAULT_OPTIONS.handler : options->handler);
-            scanner.error_callback
+            scanner->char_source = ustream;
+            /* UTF-8, the CIF 2.0 encoding, is decoded inline instead of via the ICU converter */
+            scanner->read_func = (*not_utf8 ? ustream_read_chars : utf8_read_chars);
+            scanner->at_eof = CIF_FALSE;
+            scanner->cif_version = cif_version;
+            scanner->line_unfolding = MIN(options->line_folding_modifier, 1);
+            scanner->prefix_removing = MIN(options->text_prefixing_modifier, 1);
+            scanner->max_frame_depth = MIN(options->max_frame_depth, 1);
+            scanner->bulk_load = options->bulk_load;
+            scanner->handler = ((options->handler == NULL) ? DEFAULT_OPTIONS.handler : options->handler);
+            scanner->error_callback
                     = ((options->error_callback == NULL) ? DEFAULT_OPTIONS.error_callback : options->error_callback);
-            scanner.whitespace_callback = ((options->whitespace_callback == NULL) ? DEFAULT_OPTIONS.whitespace_callback
-                    : options->whitespace_callback);
-            scanner.keyword_callback = ((options->keyword_callback == NULL) ? DEFAULT_OPTIONS.keyword_callback
+            scanner->whitespace_callback = ((options->whitespace_callback == NULL)
+                    ? DEFAULT_OPTIONS.whitespace_callback : options->whitespace_callback);
+            scanner->keyword_callback = ((options->keyword_callback == NULL) ? DEFAULT_OPTIONS.keyword_callback
                     : options->keyword_callback);
-            scanner.dataname_callback = ((options->dataname_callback == NULL) ? DEFAULT_OPTIONS.dataname_callback
+            scanner->dataname_callback = ((options->dataname_callback == NULL) ? DEFAULT_OPTIONS.dataname_callback
                     : options->dataname_callback);
-            scanner.user_data = options->user_data;  /* may be NULL */
+            scanner->user_data = options->user_data;  /* may be NULL */
 
-            /* perform the actual parse */
-            result = cif_parse_internal(&scanner, not_utf8, options->extra_ws_chars, options->extra_eol_chars, cif);
+            return CIF_OK;
         }
-
-        ucnv_close(ustream.converter);
-
-        return result;
     }
 
     FAILURE_HANDLER(early):
     FAILURE_TERMINUS;
 }
-#undef BUFFER_SIZE
-
-/*
- * Formats the CIF data represented by the 'cif' handle to the specified
- * output.
- */
-int cif_write(FILE *stream, struct cif_write_opts_s *options, cif_tp *cif) {
-    cif_handler_tp handler = {
-        write_cif_start,
-        write_cif_end,
-        write_container_start,
-        write_container_end,
-        write_container_start,
-        write_container_end,
-        write_loop_start,
-        write_loop_end,
-        write_packet_start,
-        write_packet_end,
-        write_item
-    };
-    UFILE *u_stream;
-    int result;
-
-    if (options && (options->cif_version == 1)) {
-        u_stream = u_finit(stream, NULL, NULL);
-    } else {
-        u_stream = u_finit(stream, "C", "UTF_8");
-    }
-
-    if (u_stream != NULL) {
-        CONTEXT_S context;
-
-        CONTEXT_INITIALIZE(context, u_stream);
-        if (options && (options->cif_version == 1)) {
-            context.version = 1;
-        }
-        result = cif_walk(cif, &handler, &context);
-
-        /* TODO: handle errors */
-        u_fclose(u_stream);
-        return result;
-    } else {
-        return CIF_ERROR;
-    }
-}
-
-#ifdef __cplusplus
-}
-#endif
 
 static ssize_t ustream_read_chars(void *char_source, UChar *dest, ssize_t count, int *error_code) {
     uchar_stream_t *ustream = (uchar_stream_t *) char_source;
@@ -613,6 +866,168 @@ static ssize_t ustream_read_chars(void *char_source, UChar *dest, ssize_t count,
     }
 }
 
+/*
+ * Reads characters from a UTF-8 character source, decoding and validating its bytes directly instead of via its ICU
+ * converter.  Otherwise behaves as ustream_read_chars() does, including in reporting malformed byte sequences to the
+ * scanner's error callback and substituting a replacement character for each one if the callback so permits.
+ */
+static ssize_t utf8_read_chars(void *char_source, UChar *dest, ssize_t count, int *error_code) {
+    uchar_stream_t *ustream = (uchar_stream_t *) char_source;
+    UChar *dest_pos = dest;
+    UChar *dest_limit = dest + count;
+
+    if (count <= 0) {
+        return 0;
+    } else if (ustream->pending_trail != 0) {
+        /* the second half of a surrogate pair that did not fit in the previous destination */
+        *(dest_pos++) = ustream->pending_trail;
+        ustream->pending_trail = 0;
+    }
+
+    while (dest_pos < dest_limit) {
+        unsigned char *pos = ustream->buffer_position;
+        unsigned char *limit = ustream->buffer_limit;
+        size_t available;
+        size_t needed;
+        size_t consumed;
+        UChar32 c;
+
+        /* ASCII characters, which predominate in most CIFs, decode to themselves */
+        while ((pos < limit) && (*pos < 0x80) && (dest_pos < dest_limit)) {
+            *(dest_pos++) = (UChar) *(pos++);
+        }
+        ustream->buffer_position = pos;
+        available = (size_t) (limit - pos);
+
+        if (dest_pos >= dest_limit) {
+            break;
+        } else if (available == 0) {
+            if (ustream->eof_status != 0) {
+                /* end of the character stream */
+                ustream->eof_status = 1;
+                break;
+            } else if (dest_pos > dest) {
+                /* deliver the characters already decoded before reading more bytes */
+                break;
+            } else if (ustream_refill(ustream, 0) != 0) {
+                *error_code = CIF_ERROR;
+                return -1;
+            }
+            continue;
+        }
+
+        /* determine the length of the sequence from its lead byte; 0 means the byte cannot start a sequence */
+        c = *pos;
+        if ((c >= 0xC2) && (c <= 0xDF)) {
+            needed = 2;
+            c &= 0x1F;
+        } else if ((c >= 0xE0) && (c <= 0xEF)) {
+            needed = 3;
+            c &= 0x0F;
+        } else if ((c >= 0xF0) && (c <= 0xF4)) {
+            needed = 4;
+            c &= 0x07;
+        } else {
+            needed = 0;
+        }
+
+        if ((needed > available) && (ustream->eof_status == 0)) {
+            /* the sequence continues past the buffered bytes */
+            if (dest_pos > dest) {
+                break;
+            } else if (ustream_refill(ustream, available) != 0) {
+                *error_code = CIF_ERROR;
+                return -1;
+            }
+            continue;
+        }
+
+        /*
+         * Accumulate continuation bytes, stopping at the first that is not valid.  The allowed range of the first
+         * one depends on the lead byte, so as to exclude overlong forms, surrogates, and code points past U+10FFFF.
+         */
+        for (consumed = 1; (consumed < needed) && (consumed < available); consumed += 1) {
+            unsigned char trail = pos[consumed];
+            unsigned char low = 0x80;
+            unsigned char high = 0xBF;
+
+            if (consumed == 1) {
+                switch (*pos) {
+                    case 0xE0:
+                        low = 0xA0;
+                        break;
+                    case 0xED:
+                        high = 0x9F;
+                        break;
+                    case 0xF0:
+                        low = 0x90;
+                        break;
+                    case 0xF4:
+                        high = 0x8F;
+                        break;
+                }
+            }
+            if ((trail < low) || (trail > high)) {
+                break;
+            }
+            c = (c << 6) | (trail & 0x3F);
+        }
+        ustream->buffer_position = pos + consumed;
+
+        if (consumed == needed) {
+            if (c < 0x10000) {
+                *(dest_pos++) = (UChar) c;
+            } else {
+                *(dest_pos++) = U16_LEAD(c);
+                if (dest_pos < dest_limit) {
+                    *(dest_pos++) = U16_TRAIL(c);
+                } else {
+                    ustream->pending_trail = U16_TRAIL(c);
+                }
+            }
+        } else {
+            /* a malformed sequence; it is consumed together with its valid prefix, if any */
+            const struct scanner_s *scanner = ustream->scanner;
+
+            ustream->last_error = scanner->error_callback(CIF_INVALID_CHAR, scanner->line, scanner->column, NULL, 0,
+                    scanner->user_data);
+            if (ustream->last_error != 0) {
+                *error_code = ustream->last_error;
+                return -1;
+            }
+            *(dest_pos++) = ((scanner->cif_version >= 2) ? REPL_CHAR : REPL1_CHAR);
+        }
+    }
+
+    return dest_pos - dest;
+}
+
+/*
+ * Refills the byte buffer of the specified character source from its byte stream, first moving the last 'retained'
+ * unconsumed bytes to the beginning of the buffer.  Returns 0 on success, or -1 if an I/O error occurs.
+ */
+static int ustream_refill(uchar_stream_t *ustream, size_t retained) {
+    size_t bytes_read;
+
+    memmove(ustream->byte_buffer, ustream->buffer_position, retained);
+    bytes_read = fread(ustream->byte_buffer + retained, 1, ustream->buffer_size - retained, ustream->byte_stream);
+    if (bytes_read < ustream->buffer_size - retained) {
+        if (ferror(ustream->byte_stream) != 0) {
+            /* I/O error */
+            return -1;
+        } else {
+            /* end-of-file encountered */
+            ustream->eof_status = -1;
+        }
+    }
+
+    /* record the boundaries of the valid buffered bytes */
+    ustream->buffer_position = ustream->byte_buffer;
+    ustream->buffer_limit = ustream->byte_buffer + retained + bytes_read;
+
+    return 0;
+}
+
 /*
  * An ICU converter callback for the to-Unicode direction that wraps a CIF API error callback
  */
@@ -175,6 +175,8 @@ static int cif_container_create_loop_internal(
 
             TRACELINE;
             temp->names = NULL;
+            temp->item_set = NULL;
+            temp->item_set_generation = container->cif->loop_item_generation;
 
             /* begin a transaction */
             if (BEGIN_NESTTX(cif->db) == SQLITE_OK) {
@@ -273,7 +275,7 @@ static int cif_container_create_loop_internal(
                 FAILURE_HANDLER(soft):
                 /* rollback the transaction */
                 TRACELINE;
-                ROLLBACK_NESTTX(cif->db);
+                ROLLBACK_NESTTX(cif);
             }
         }
         cif_loop_free(temp);
@@ -301,6 +303,8 @@ static int cif_container_get_item_loop_internal (
     loop->container = container;
     loop->category = NULL;
     loop->names = NULL;
+    loop->item_set = NULL;
+    loop->item_set_generation = container->cif->loop_item_generation;
 
     if ((sqlite3_bind_text16(cif->get_item_loop_stmt, 2, name, -1, SQLITE_STATIC) == SQLITE_OK)
            && (sqlite3_bind_int64(cif->get_item_loop_stmt, 1, container->id) == SQLITE_OK)) {
@@ -390,6 +394,7 @@ int cif_container_create_frame(cif_container_tp *container, const UChar *code, c
 
 int cif_container_create_frame_internal(cif_container_tp *container, const UChar *code, int lenient, cif_frame_tp **frame) {
     FAILURE_HANDLING;
+    NESTTX_HANDLING;
     cif_frame_tp *temp;
     struct cif_s *cif;
 
@@ -432,7 +437,7 @@ int cif_container_create_frame_internal(cif_container_tp *container, const UChar
             if (temp->code_orig == NULL) {
                 SET_RESULT(CIF_MEMORY_ERROR);
             } else {
-                if(BEGIN(cif->db) == SQLITE_OK) {
+                if(BEGIN_NESTTX(cif->db) == SQLITE_OK) {
                     TRACELINE;
                     if(sqlite3_exec(cif->db, "insert into container(id) values (null)", NULL, NULL, NULL)
                             == SQLITE_OK) {
@@ -458,7 +463,7 @@ int cif_container_create_frame_internal(cif_container_tp *container, const UChar
                                     (void) sqlite3_reset(cif->create_frame_stmt);
                                     FAIL(soft, CIF_DUP_FRAMECODE);
                                 case SQLITE_DONE:
-                                    if (COMMIT(cif->db) == SQLITE_OK) {
+                                    if (COMMIT_NESTTX(cif->db) == SQLITE_OK) {
                                         ASSIGN_TEMP_PTR(temp, frame, cif_container_free);
                                         return CIF_OK;
                                     }
@@ -474,7 +479,7 @@ int cif_container_create_frame_internal(cif_container_tp *container, const UChar
                     }
                     FAILURE_HANDLER(soft):
                     /* rollback the transaction, ignoring any further error */
-                    ROLLBACK(cif->db);
+                    ROLLBACK_NESTTX(cif);
                 } /* else failed to begin a transaction */
             } /* else failed to dup the original code */
         } /* else failed to normalize the code */
@@ -674,6 +679,7 @@ int cif_container_destroy(
         PREPARE_STMT(cif, destroy_container, DESTROY_CONTAINER_SQL);
         if ((sqlite3_bind_int64(cif->destroy_container_stmt, 1, container->id) == SQLITE_OK) 
                 && (STEP_STMT(cif, destroy_container) == SQLITE_DONE)) {
+            cif->loop_item_generation += 1;
             cif_container_free(container);
             return (sqlite3_changes(cif->db) <= 0) ? CIF_INVALID_HANDLE : CIF_OK;
         }
@@ -792,6 +798,8 @@ int cif_container_get_category_loop(
             SET_RESULT(CIF_MEMORY_ERROR);
         } else {
             temp->names = NULL;
+            temp->item_set = NULL;
+            temp->item_set_generation = container->cif->loop_item_generation;
             if ((sqlite3_bind_int64(cif->get_cat_loop_stmt, 1, container->id) == SQLITE_OK)
                     && (sqlite3_bind_text16(cif->get_cat_loop_stmt, 2, category, -1, SQLITE_STATIC) == SQLITE_OK)) {
                 STEP_HANDLING;
@@ -846,6 +854,8 @@ int cif_container_get_item_loop(
         temp->container = container;
         temp->category = NULL;
         temp->names = NULL;
+        temp->item_set = NULL;
+        temp->item_set_generation = container->cif->loop_item_generation;
 
         result = cif_normalize_item_name(item_name, -1, &name, CIF_INVALID_ITEMNAME);
         if (result == CIF_INVALID_ITEMNAME) {
@@ -921,6 +931,8 @@ int cif_container_get_all_loops(cif_container_tp *container, cif_loop_tp ***loop
                                 temp->container = container;
                                 temp->loop_num = sqlite3_column_int(cif->get_all_loops_stmt, 0);
                                 temp->names = NULL;
+                                temp->item_set = NULL;
+                                temp->item_set_generation = container->cif->loop_item_generation;
                                 GET_COLUMN_STRING(cif->get_all_loops_stmt, 1, temp->category, HANDLER_LABEL(hard));
                                 loop_count += 1;
                             }
@@ -948,7 +960,8 @@ int cif_container_get_all_loops(cif_container_tp *container, cif_loop_tp ***loop
                                 }
                                 temp_loops[loop_count] = NULL;
                                 *loops = temp_loops;
-                                ROLLBACK_NESTTX(cif->db);
+                                /* no changes were made; releasing rather than rolling back keeps the caches valid */
+                                (void) COMMIT_NESTTX(cif->db);
                                 return CIF_OK;
                             }
                     }
@@ -968,7 +981,7 @@ int cif_container_get_all_loops(cif_container_tp *container, cif_loop_tp ***loop
             SET_RESULT(result);
         }
 
-        ROLLBACK_NESTTX(cif->db);
+        ROLLBACK_NESTTX(cif);
     }
 
     FAILURE_TERMINUS;
@@ -988,6 +1001,7 @@ int cif_container_prune(cif_container_tp *container) {
 
         switch (STEP_STMT(cif, prune_container)) {
             case SQLITE_DONE:
+                cif->loop_item_generation += 1;
                 return CIF_OK;
             case SQLITE_MISUSE:
                 FAIL(soft, CIF_MISUSE);
@@ -1129,13 +1143,13 @@ int cif_container_get_value(
     FAILURE_TERMINUS;
 }
 
-/* Not safe to be called by other library functions */
 int cif_container_set_value(
         cif_container_tp *container,
         const UChar *name_orig,
         cif_value_tp *val
         ) {
     FAILURE_HANDLING;
+    NESTTX_HANDLING;
     cif_loop_tp item_loop;
     UChar *name;
     sqlite3 *db = container->cif->db;
@@ -1148,7 +1162,7 @@ int cif_container_set_value(
     if (result != CIF_OK) {
         SET_RESULT(result);
     } else {
-        if (BEGIN(db) == SQLITE_OK) {
+        if (BEGIN_NESTTX(db) == SQLITE_OK) {
             cif_value_tp temp_val;
 
             if (val == NULL) {
@@ -1168,12 +1182,12 @@ int cif_container_set_value(
                 /* default: do nothing */
             }
 
-            if ((result == CIF_OK) && (COMMIT(db) != SQLITE_OK)) {
+            if ((result == CIF_OK) && (COMMIT_NESTTX(db) != SQLITE_OK)) {
                 result = CIF_ERROR;
             }
 
             if (result != CIF_OK) {
-                (void) ROLLBACK(db);
+                (void) ROLLBACK_NESTTX(container->cif);
             }
 
             SET_RESULT(result);
@@ -1185,12 +1199,12 @@ int cif_container_set_value(
     FAILURE_TERMINUS;  /* and success terminus, too */
 }
 
-/* not safe to be called by other library functions */
 int cif_container_remove_item(
         cif_container_tp *container,
         const UChar *item_name
         ) {
     FAILURE_HANDLING;
+    NESTTX_HANDLING;
     cif_tp *cif;
     UChar *normalized_name;
     int result;
@@ -1223,14 +1237,14 @@ int cif_container_remove_item(
          * thing to do.  Among other things, if the library ever is extended to provide concurrent access support then
          * this will already be up to it.
          */
-        if (BEGIN(cif->db) == SQLITE_OK) {
+        if (BEGIN_NESTTX(cif->db) == SQLITE_OK) {
             STEP_HANDLING;
             int loop_num;
 
             switch (STEP_STMT(cif, get_loop_size)) {
                 case SQLITE_DONE:
-                    /* The container does not have the specified item */
-                    ROLLBACK(cif->db);
+                    /* The container does not have the specified item; nothing was changed */
+                    (void) COMMIT_NESTTX(cif->db);
                     FAIL(soft, CIF_NOSUCH_ITEM);
                 case SQLITE_ROW:
                     size = sqlite3_column_int(cif->get_loop_size_stmt, 1);
@@ -1255,14 +1269,15 @@ int cif_container_remove_item(
                             DEFAULT_FAIL(hard);
                         }
                     }
-                    if (COMMIT(cif->db) == SQLITE_OK) {
+                    if (COMMIT_NESTTX(cif->db) == SQLITE_OK) {
+                        cif->loop_item_generation += 1;
                         return CIF_OK;
                     }
                     /* fall through */
                 /* default: do nothing */
             }
             FAILURE_HANDLER(hard):
-            ROLLBACK(cif->db);
+            ROLLBACK_NESTTX(cif);
         }
     }
 
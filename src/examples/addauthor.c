@@ -97,7 +97,8 @@ int main(int argc, char *argv[]) {
     CHECK_CALL(cif_value_init_char(value, name), "Set the name in the packet");
     /* responsibility for 'name' passes to the value, which in turn belongs to the packet */
 
-    /* add the specified author to each block */
+    /* add the specified author to each block, committing all the changes together */
+    CHECK_CALL(cif_begin(cif), "begin a transaction");
     for (current_block = all_blocks; *current_block; current_block += 1) {
         cif_loop_tp *author_loop;
         int result = cif_container_get_item_loop(*current_block, authorname_name, &author_loop);
@@ -130,6 +131,7 @@ int main(int argc, char *argv[]) {
         /* don't clean up the packet just yet -- it may be re-used */
     }
     free(all_blocks);
+    CHECK_CALL(cif_commit(cif), "commit the changes");
 
     /* no more need for the packet */
     cif_packet_free(packet);
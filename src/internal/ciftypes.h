@@ -101,6 +101,15 @@
  */
 typedef int (*name_normalizer_f)(const UChar *name, int32_t namelen, UChar **normalized_name, int invalidityCode);
 
+/* an interned item name, as cached by a CIF */
+
+struct name_id_s {
+    int id;
+    UChar *name;            /* the normalized name; owned */
+    UT_hash_handle hh;      /* for hashing by name */
+    UT_hash_handle hh_id;   /* for hashing by ID */
+};
+
 /* a whole CIF */
 
 struct cif_s {
@@ -134,6 +143,32 @@ struct cif_s {
    sqlite3_stmt *insert_value_stmt;
    sqlite3_stmt *update_value_stmt;
    sqlite3_stmt *remove_packet_stmt;
+   sqlite3_stmt *get_name_id_stmt;
+   sqlite3_stmt *get_item_name_stmt;
+   sqlite3_stmt *get_loop_name_ids_stmt;
+   sqlite3_stmt *get_column_values_stmt;
+   sqlite3_stmt *aggregate_values_stmt;
+
+   /*
+    * Incremented whenever items may have been removed from any loop (including by rolling back a transaction),
+    * invalidating the item sets cached by loop handles
+    */
+   unsigned int loop_item_generation;
+
+   /*
+    * A cache of the mapping between interned item names and their IDs, in both directions.  The two hash tables share
+    * their entries.  Because rolling back a transaction may un-intern names, the cache is discarded whenever
+    * loop_item_generation moves away from the value recorded in names_generation.
+    */
+   struct name_id_s *names_by_name;
+   struct name_id_s *names_by_id;
+   unsigned int names_generation;
+
+   /* whether the current transaction, if any, was begun via cif_begin() */
+   int user_transaction;
+
+   /* the number of packet iterators currently open on this CIF */
+   int open_iterators;
 };
 
 /* data containers block and frame */
@@ -146,6 +181,11 @@ struct cif_container_s {
     sqlite_int64 parent_id;
 };
 
+struct set_element_s {
+    /* no data payload */
+    UT_hash_handle hh;
+};
+
 /* loops */
 
 struct cif_loop_s {
@@ -153,13 +193,8 @@ struct cif_loop_s {
     int loop_num;
     UChar *category;
     UChar **names;
-};
-
-/* loop packets */
-
-struct set_element_s {
-    /* no data payload */
-    UT_hash_handle hh;
+    struct set_element_s *item_set;    /* normalized names of items known to belong to the loop; keys are owned */
+    unsigned int item_set_generation;  /* the CIF's loop_item_generation as of when item_set was last valid */
 };
 
 struct entry_s;
@@ -186,12 +221,33 @@ struct cif_packet_s {
 struct cif_pktitr_s {
     sqlite3_stmt *stmt;
     cif_loop_tp *loop;
-    UChar **item_names;              /* must record _normalized_ names */
+    cif_loop_tp *right_loop;         /* joins only: the loop whose packets are merged with those of 'loop' */
+    UChar **item_names;              /* must record _normalized_ names, in order of their positions in the loop */
+    int *item_ids;                   /* the IDs of the items named by 'item_names', in the same order */
+    struct entry_s **entries;        /* scratch space: the entries of the packet being read, parallel to 'item_ids' */
     struct set_element_s *name_set;  /* a set representation of 'item_names' */
     int previous_row_num;
     int finished;
+    int top_tx;                      /* nonzero if the iteration holds a transaction of its own, not a savepoint */
 };
 
+/*
+ * A predicate is a binary tree whose leaves compare one item's values with a constant, and whose interior nodes
+ * combine their children's results
+ */
+struct cif_predicate_s {
+    int op;                          /* a cif_compare_tp code for leaves, or PREDICATE_AND or PREDICATE_OR */
+    cif_kind_tp kind;                /* leaves only: CIF_NUMB_KIND or CIF_CHAR_KIND, the kind of comparison */
+    UChar *name;                     /* leaves only: the _normalized_ name of the compared item */
+    double number;                   /* numeric leaves only: the constant */
+    UChar *text;                     /* character leaves only: the constant */
+    struct cif_predicate_s *left;    /* interior nodes only: the first operand */
+    struct cif_predicate_s *right;   /* interior nodes only: the second operand */
+};
+
+#define PREDICATE_AND 100
+#define PREDICATE_OR  101
+
 /* values */
 
 /* IMPORTANT: the order of the members of the following value structures is significant. */
@@ -215,8 +271,18 @@ typedef struct numb_value_s {
     char *digits;
     char *su_digits;
     int scale;
+    /*
+     * binary forms of the value and its su, computed from the digit strings on demand.  Each is valid only if the
+     * corresponding NUMB_*_CACHED flag is set in 'cached'; anything that changes the digits or scale must clear them.
+     */
+    double d_value;
+    double d_su;
+    int cached;
 } cif_numb_tp;
 
+#define NUMB_VALUE_CACHED 1
+#define NUMB_SU_CACHED    2
+
 struct list_element_s;
 
 typedef struct list_value_s {
@@ -301,6 +367,7 @@ struct scanner_s {
     /* character classification tables */
     unsigned int char_class[CHAR_TABLE_MAX];
     unsigned int meta_class[LAST_CLASS + 1];
+    int printables_plain;   /* true if no printable ASCII character is classified as whitespace or end-of-line */
 
     /* character source */
     void *char_source;
@@ -314,6 +381,7 @@ struct scanner_s {
     int line_unfolding;
     int prefix_removing;
     int max_frame_depth;
+    int bulk_load;
 
     /* user callback support */
     cif_handler_tp *handler;
@@ -339,5 +407,30 @@ struct scanner_s {
     int skip_depth;
 };
 
+/*
+ * Tracks the state of a pull-style read of a CIF, as performed via cif_reader_next().  Only the grammatical context
+ * needed to classify the next token is retained; nothing read is recorded.
+ */
+struct cif_reader_s {
+    struct scanner_s scanner;  /* the scanner; its character source belongs to the reader */
+    int finished;              /* whether the end of the input has been reported */
+    int in_block;              /* whether a data block (possibly an anonymous one, for error recovery) is open */
+    int frame_depth;           /* the number of save frames currently open */
+
+    /* loop state */
+    UChar **loop_names;        /* the NULL-terminated data names of the current loop, or NULL if not in a loop body */
+    size_t loop_capacity;      /* the number of elements for which space is allocated in loop_names */
+    int column_count;          /* the number of data names of the current loop */
+    int column_index;          /* the index of the data name to which the next loop value belongs */
+    int packet_open;           /* whether the start of the current packet has been reported */
+    int have_packets;          /* whether the current loop has had at least one complete packet */
+    int partial_packet;        /* whether the current packet is being completed with synthetic values */
+
+    /* event data owned by the reader */
+    UChar *name;               /* the most recent block code, frame code, or data name reported */
+    size_t name_capacity;      /* the number of UChar units allocated for the name */
+    cif_value_tp *value;       /* the most recent decoded text field, list, or table value */
+};
+
 #endif /* INTERNAL_CIFTYPES_H */
 
@@ -32,8 +32,49 @@
 #ifndef INTERNAL_SQL_H
 #define INTERNAL_SQL_H
 
+/*
+ * Expands to a scalar subquery for the ID of the interned item name given by the specified parameter (a string
+ * literal such as "?" or "?2").  The subquery evaluates to NULL if the name is not interned.
+ */
+#define NAME_ID(param) "(select id from item_name where name = " param ")"
+
+/*
+ * The version of the database schema defined by cif_schema.sql, as recorded in the user_version of each database
+ * carrying it.  It must be incremented whenever the schema changes, and the two macros must agree.
+ */
+#define SCHEMA_VERSION 2
+#define SET_SCHEMA_VERSION_SQL "pragma user_version = 2"
+
+#define GET_SCHEMA_VERSION_SQL "pragma user_version"
+
+#define COUNT_SCHEMA_OBJECTS_SQL "select count(*) from sqlite_master"
+
 #define ENABLE_FKS_SQL "pragma foreign_keys = 'on'; pragma foreign_keys"
 
+#define DISABLE_FKS_SQL "pragma foreign_keys = 'off'"
+
+/*
+ * Apply the effects of the schema's 'on delete cascade' foreign key actions, which are not performed while foreign
+ * key enforcement is disabled.  The statements are ordered so that each deletion can make orphans only of rows
+ * handled by a later statement, so CASCADE_CONTAINER_DELETES_SQL must be executed before CASCADE_LOOP_DELETES_SQL.
+ */
+#define CASCADE_CONTAINER_DELETES_SQL \
+    "delete from data_block where container_id not in (select id from container); " \
+    "delete from save_frame where container_id not in (select id from container) " \
+        "or parent_id not in (select id from container); " \
+    "delete from loop where container_id not in (select id from container)"
+#define CASCADE_LOOP_DELETES_SQL \
+    "delete from loop_item where not exists (select 1 from loop l " \
+        "where l.container_id = loop_item.container_id and l.loop_num = loop_item.loop_num); " \
+    "delete from item_value where not exists (select 1 from loop_item li " \
+        "where li.container_id = item_value.container_id and li.loop_num = item_value.loop_num " \
+            "and li.name_id = item_value.name_id)"
+
+#define CHECK_FKS_SQL "pragma foreign_key_check"
+
+/* configures a connection to an in-memory database to keep its journal and its temporary b-trees in memory, too */
+#define MEMORY_STORAGE_SQL "pragma journal_mode = memory; pragma temp_store = memory"
+
 #define CREATE_BLOCK_SQL "insert into data_block(container_id, name, name_orig) values (?, ?, ?)"
 
 #define GET_BLOCK_SQL "select container_id as id, name_orig from data_block where name = ?"
@@ -62,88 +103,187 @@
 
 #define GET_ITEM_LOOP_SQL "select l.loop_num, l.category from loop l " \
         "join loop_item li on l.container_id = li.container_id and l.loop_num = li.loop_num " \
-        "where li.container_id = ? and li.name = ?"
+        "where li.container_id = ? and li.name_id = " NAME_ID("?")
 
 #define GET_ALL_LOOPS_SQL "select loop_num, category from loop where container_id = ?"
 
 #define PRUNE_SQL "delete from loop where container_id = ? and loop_num not in " \
-        "(select distinct loop_num from loop_item li join item_value using (container_id, name) where container_id = ?1)"
+        "(select distinct loop_num from item_value where container_id = ?1)"
 
 /*
  * This statement both updates existing values and sets omitted values in all packets of the loop containing the
  * specified name in the specified container:
  */
 #define SET_ALL_VALUES_SQL "insert or replace into item_value " \
-  "(kind, quoted, val_text, val, val_digits, su_digits, scale, container_id, name, row_num) " \
-  "select ?, ?, ?, ?, ?, ?, ?, ?, ?, loop_row.row_num " \
+  "(kind, quoted, val_text, val, val_digits, su_digits, scale, container_id, name_id, loop_num, row_num) " \
+  "select ?, ?, ?, ?, ?, ?, ?, ?8, lr.name_id, lr.loop_num, lr.row_num " \
      "from (" \
-       "select distinct iv.row_num as row_num " \
-       "from loop_item li1 " \
-         "join loop_item li2 on li1.container_id = li2.container_id and li1.loop_num = li2.loop_num " \
-         "join item_value iv on li2.container_id = iv.container_id and li2.name = iv.name " \
-       "where li1.container_id = ?8 and li1.name = ?9" \
-     ") loop_row"
+       "select distinct li.name_id as name_id, iv.loop_num as loop_num, iv.row_num as row_num " \
+       "from loop_item li " \
+         "join item_value iv on li.container_id = iv.container_id and li.loop_num = iv.loop_num " \
+       "where li.container_id = ?8 and li.name_id = " NAME_ID("?9") \
+     ") lr"
 
 /* Loop "size" is the number of data names in a loop.  See also COUNT_LOOP_PACKETS_SQL. */
 #define GET_LOOP_SIZE_SQL "select loop_num, count(*) as size " \
         "from loop_item li1 join loop_item li2 using (container_id, loop_num) " \
-        "where li1.container_id = ? and li1.name = ? " \
+        "where li1.container_id = ? and li1.name_id = " NAME_ID("?") " " \
         "group by loop_num"
 
 /* not currently used: */
 #define COUNT_LOOP_PACKETS_SQL "select count(*) as packet_count " \
   "from (" \
-    "select distinct iv.row_num " \
-      "from loop_item li " \
-        "join item_value iv on li.container_id = iv.container_id and li.name = iv.name " \
-      "where li.container_id = ? and li.loop_num = ?" \
+    "select distinct row_num from item_value where container_id = ? and loop_num = ?" \
   ")"
 
-#define REMOVE_ITEM_SQL "delete from loop_item where container_id = ? and name = ?"
+#define REMOVE_ITEM_SQL "delete from loop_item where container_id = ? and name_id = " NAME_ID("?")
+
+/* retrieves the names of a loop's items, in the same order as GET_LOOP_NAME_IDS_SQL */
+#define GET_LOOP_NAMES_SQL "select name_orig from loop_item where container_id = ? and loop_num = ? order by item_num"
+
+#define CHECK_ITEM_LOOP_SQL "select 1 from loop_item where container_id = ? and name_id = ? and loop_num = ?"
+
+/* retrieves the IDs of a loop's items, in the same order that item values are presented by GET_LOOP_VALUES_SQL */
+#define GET_LOOP_NAME_IDS_SQL "select name_id from loop_item where container_id = ? and loop_num = ? order by item_num"
+
+#define GET_NAME_ID_SQL "select id from item_name where name = ?"
+
+#define GET_ITEM_NAME_SQL "select name from item_name where id = ?"
 
-#define GET_LOOP_NAMES_SQL "select name_orig from loop_item where container_id = ? and loop_num = ?"
+/* interns a normalized item name, if it is not interned already */
+#define INTERN_NAME_SQL "insert or ignore into item_name(name) values (?)"
 
-#define CHECK_ITEM_LOOP_SQL "select 1 from loop_item where container_id = ? and name = ? and loop_num = ?"
+/*
+ * Create partial indexes on the numeric and text values of the item having a given name ID, in support of value-based
+ * selections such as those of cif_loop_select().  Arguments: the name ID, twice.
+ */
+#define CREATE_NUMB_INDEX_SQL \
+    "create index if not exists ix_numb_item_value_%d on item_value (container_id, kind, val) where name_id = %d"
+#define CREATE_TEXT_INDEX_SQL \
+    "create index if not exists ix_text_item_value_%d on item_value (container_id, val_text) where name_id = %d"
 
 /*
  * This approach to assigning packet (row) numbers is in a sense more correct than one based on tracking a sequence
  * number in the 'loop' table as we now do, but it's too expensive for loops with large numbers of packets, especially
  * when used repeatedly.
 
-#define MAX_PACKET_NUM_SQL "select max(iv.row_num) from loop_item li " \
-    "join item_value iv using (container_id, name) where li.container_id = ? and li.loop_num = ?"
+#define MAX_PACKET_NUM_SQL "select max(row_num) from item_value where container_id = ? and loop_num = ?"
 
  */
 
 #define GET_PACKET_NUM_SQL "select last_row_num from loop where container_id = ? and loop_num = ?"
 
-#define UPDATE_PACKET_NUM_SQL "update loop set last_row_num = last_row_num + 1 where container_id = ? and loop_num = ?"
+/* reserves a block of ?3 packet numbers, ending with the new value of last_row_num */
+#define UPDATE_PACKET_NUM_SQL "update loop set last_row_num = last_row_num + ?3 " \
+        "where container_id = ?1 and loop_num = ?2"
 
 #define RESET_PACKET_NUM_SQL "update loop set last_row_num = 0 where container_id = ? and loop_num = ?"
 
-#define ADD_LOOP_ITEM_SQL "insert into loop_item (container_id, name, name_orig, loop_num) values (?, ?, ?, ?)"
+/* the view's trigger interns the (normalized) name if necessary */
+#define ADD_LOOP_ITEM_SQL "insert into named_loop_item (container_id, name, name_orig, loop_num) values (?, ?, ?, ?)"
 
-#define INSERT_VALUE_SQL "insert into item_value (container_id, name, row_num, " \
-    "kind, quoted, val_text, val, val_digits, su_digits, scale) values (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
+/*
+ * In this and the next statement, the item is identified by its name ID (parameter 2), and the loop number is
+ * parameter 11, following the value properties
+ */
+#define INSERT_VALUE_SQL "insert into item_value (container_id, name_id, row_num, " \
+    "kind, quoted, val_text, val, val_digits, su_digits, scale, loop_num) values (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?11)"
 
-#define UPDATE_VALUE_SQL "insert or replace into item_value (container_id, name, row_num, " \
-    "kind, quoted, val_text, val, val_digits, su_digits, scale) values (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
+#define UPDATE_VALUE_SQL "insert or replace into item_value (container_id, name_id, row_num, " \
+    "kind, quoted, val_text, val, val_digits, su_digits, scale, loop_num) values (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?11)"
 
 #define GET_VALUE_SQL "select kind, quoted, val, val_text, val_digits, su_digits, scale " \
-        "from item_value where container_id = ? and name = ?"
+        "from item_value where container_id = ? and name_id = " NAME_ID("?")
 
 /*
  * Note: there is no dedicated stmt in the cif struct corresponding to this SQL; a new statement is needed for each
  * loop iterated to allow multiple iterations to proceed simultaneously (as if doing that were a good idea ...)
+ *
+ * The packets are produced in the order of item_value's primary key, by a range scan.  Only the values within each
+ * packet are sorted, into the order of their items' positions in the loop (as recorded in loop_item).  The cross join
+ * keeps the engine from instead scanning loop_item first, which would require sorting all the loop's values.
  */
 #define GET_LOOP_VALUES_SQL \
-    "select iv.row_num, name, iv.kind, iv.quoted, iv.val, iv.val_text, iv.val_digits, iv.su_digits, iv.scale " \
-    "from loop_item li join item_value iv using (container_id, name) " \
-    "where li.container_id=? and li.loop_num=? " \
-    "order by iv.row_num"
+    "select row_num, name_id, kind, quoted, val, val_text, val_digits, su_digits, scale " \
+    "from item_value cross join loop_item using (container_id, loop_num, name_id) " \
+    "where container_id=? and loop_num=? " \
+    "order by row_num, item_num"
+
+/*
+ * The beginning and end of a variant of GET_LOOP_VALUES_SQL that can be restricted to selected items or to packets
+ * satisfying a predicate; additional conditions go between them, each introduced by "and"
+ */
+#define GET_FILTERED_VALUES_SQL_HEAD \
+    "select row_num, name_id, kind, quoted, val, val_text, val_digits, su_digits, scale " \
+    "from item_value cross join loop_item using (container_id, loop_num, name_id) " \
+    "where container_id=?1 and loop_num=?2"
+#define GET_FILTERED_VALUES_SQL_TAIL " order by row_num, item_num"
+
+/*
+ * Conditions selecting the rows of packets whose value for the item with a given ID compares in a given way with a
+ * numeric or character constant.  Arguments: the name ID, an SQL comparison operator, and the constant's
+ * parameter number.
+ */
+#define NUMB_PREDICATE_SQL \
+    "row_num in (select row_num from item_value " \
+      "where container_id = ?1 and loop_num = ?2 and name_id = %d and kind = 1 and val %s ?%d)"
+#define CHAR_PREDICATE_SQL \
+    "row_num in (select row_num from item_value " \
+      "where container_id = ?1 and loop_num = ?2 and name_id = %d and kind in (0, 1) and val_text %s ?%d)"
+
+/*
+ * Retrieves the values of the merged packets of an equijoin between two loops, in the same form as GET_LOOP_VALUES_SQL.
+ * Each pair of joined packets is numbered in order of the left packet, then the right one, and those numbers take the
+ * place of packet numbers.  Within each pair, the left packet's values precede the right one's, and each packet's
+ * values are in the order of their items' positions in their loop.  Character keys match character keys by their raw
+ * val_text (no normalization), and numeric keys match numeric keys by value.  The right loop's keys are gathered first
+ * so that the engine can index them automatically.  Parameters: ?1 and ?2 are the left loop's container ID and loop
+ * number, ?3 and ?4 are the right loop's, and ?5 and ?6 are the left and right key items' name IDs.  The statement is
+ * the concatenation of JOIN_LOOP_VALUES_SQL_HEAD, JOIN_LOOP_VALUES_SQL_BODY, and JOIN_LOOP_VALUES_SQL_TAIL.
+ */
+#define JOIN_LOOP_VALUES_SQL_HEAD \
+    "with rkeys(row_num, key) as (" \
+      "select row_num, case kind when 1 then val else val_text end " \
+      "from item_value " \
+      "where container_id = ?3 and loop_num = ?4 and name_id = ?6 and kind in (0, 1)" \
+    "), pairs(pair_num, left_row, right_row) as (" \
+      "select row_number() over (order by l.row_num, r.row_num), l.row_num, r.row_num " \
+      "from item_value l " \
+        "join rkeys r on r.key = (case l.kind when 1 then l.val else l.val_text end) " \
+      "where l.container_id = ?1 and l.loop_num = ?2 and l.name_id = ?5 and l.kind in (0, 1)" \
+    "), "
+#define JOIN_LOOP_VALUES_SQL_BODY \
+    "sides(pair_num, side, container_id, loop_num, row_num) as (" \
+      "select pair_num, 0, ?1, ?2, left_row from pairs " \
+      "union all " \
+      "select pair_num, 1, ?3, ?4, right_row from pairs" \
+    ") "
+#define JOIN_LOOP_VALUES_SQL_TAIL \
+    "select s.pair_num, v.name_id, v.kind, v.quoted, v.val, v.val_text, v.val_digits, v.su_digits, v.scale " \
+    "from sides s " \
+      "join item_value v " \
+        "on v.container_id = s.container_id and v.loop_num = s.loop_num and v.row_num = s.row_num " \
+      "join loop_item li " \
+        "on li.container_id = v.container_id and li.loop_num = v.loop_num and li.name_id = v.name_id " \
+    "order by s.pair_num, s.side, li.item_num"
+
+/* retrieves the numeric properties of one item's values, in the same packet order as GET_LOOP_VALUES_SQL */
+#define GET_COLUMN_VALUES_SQL \
+    "select kind, val, su_digits, scale " \
+    "from item_value " \
+    "where container_id = ? and loop_num = ? and name_id = ? " \
+    "order by row_num"
+
+/*
+ * summarizes one item's values, by kind; for kind 1, the minimum, maximum, and total are those of the numbers
+ */
+#define AGGREGATE_VALUES_SQL \
+    "select kind, count(*), min(val), max(val), total(val) " \
+    "from item_value " \
+    "where container_id = ? and loop_num = ? and name_id = ? " \
+    "group by kind"
 
-#define REMOVE_PACKET_SQL "delete from item_value where container_id = ?1 and row_num = ?3 " \
-        "and name in (select name from loop_item where container_id = ?1 and loop_num = ?2)"
+#define REMOVE_PACKET_SQL "delete from item_value where container_id = ?1 and loop_num = ?2 and row_num = ?3"
 
 #endif
 
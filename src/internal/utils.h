@@ -289,14 +289,22 @@ extern int total_queries;
 
 #define SAVE(db) DEBUG_WRAP((db), sqlite3_exec((db), "savepoint s", NULL, NULL, NULL))
 #define RELEASE(db) DEBUG_WRAP((db), sqlite3_exec((db), "release s", NULL, NULL, NULL))
-#define ROLLBACK_TO(db) DEBUG_WRAP((db), sqlite3_exec((db), "rollback to s", NULL, NULL, NULL))
+/* rolling back to a savepoint does not end it, so it is released afterward */
+#define ROLLBACK_TO(db) DEBUG_WRAP((db), sqlite3_exec((db), "rollback to s; release s", NULL, NULL, NULL))
 
 #define NESTTX_HANDLING int _top_tx
 #define BEGIN_NESTTX(db) ( \
   (_top_tx = sqlite3_get_autocommit(db)), \
   ((_top_tx == 0) ? SAVE(db) : BEGIN(db)) )
 #define COMMIT_NESTTX(db) ((_top_tx == 0) ? RELEASE(db) : COMMIT(db))
-#define ROLLBACK_NESTTX(db) ((_top_tx == 0) ? ROLLBACK_TO(db) : ROLLBACK(db))
+/*
+ * Unlike the other transaction macros, ROLLBACK_NESTTX takes a CIF handle.  Rolling back may un-insert item names and
+ * loop items that the CIF's caches already hold, so the caches are invalidated.  Functions that complete successfully
+ * without having changed anything should therefore end their transaction with COMMIT_NESTTX instead.
+ */
+#define ROLLBACK_NESTTX(cif) ( \
+  ((cif)->loop_item_generation += 1), \
+  ((_top_tx == 0) ? ROLLBACK_TO((cif)->db) : ROLLBACK((cif)->db)) )
 
 /*
  * A macro expression evaluating to zero if the specified error code
@@ -451,9 +459,9 @@ extern int total_queries;
     } \
     switch (v->kind) { \
         case CIF_CHAR_KIND: \
+            /* the text is recorded only once, in val_text */ \
             if ((sqlite3_bind_int(s, 2 + ofs, v->as_char.quoted) != SQLITE_OK) \
-                    || (sqlite3_bind_text16(s, 3 + ofs, v->as_char.text, -1, SQLITE_STATIC) != SQLITE_OK) \
-                    || (sqlite3_bind_text16(s, 4 + ofs, v->as_char.text, -1, SQLITE_STATIC) != SQLITE_OK)) { \
+                    || (sqlite3_bind_text16(s, 3 + ofs, v->as_char.text, -1, SQLITE_STATIC) != SQLITE_OK)) { \
                 DEFAULT_FAIL(onsqlerr); \
             } \
             break; \
@@ -508,6 +516,13 @@ extern int total_queries;
                 GET_COLUMN_BYTESTRING(_stmt, _col_ofs + 5, _value->as_numb.su_digits, HANDLER_LABEL(errlabel)); \
                 _value->as_numb.scale = sqlite3_column_int(_stmt, _col_ofs + 6); \
                 _value->as_numb.sign = (*(_value->as_numb.text) == UCHAR_MINUS) ? -1 : 1; \
+                /* the stored binary value saves converting the digits again */ \
+                if (sqlite3_column_type(_stmt, _col_ofs + 2) == SQLITE_FLOAT) { \
+                    _value->as_numb.d_value = sqlite3_column_double(_stmt, _col_ofs + 2); \
+                    _value->as_numb.cached = NUMB_VALUE_CACHED; \
+                } else { \
+                    _value->as_numb.cached = 0; \
+                } \
                 break; \
             } \
             FAIL(errlabel, CIF_INTERNAL_ERROR); \
@@ -711,6 +726,15 @@ CIF_VOIDFUNC_DECL(cif_map_entry_free_internal, (
         cif_map_t *map
         )) INTERNAL_VOID;
 
+/*
+ * Computes the double nearest the number represented by the specified decimal digit string, interpreted according to
+ * the specified scale, exactly as cif_value_get_number() does for number values.
+ */
+double cif_digits_to_double(
+        const char *digits,
+        int scale
+        ) INTERNAL;
+
 /*
  * Serializes a value to this library's internal serialization format.
  * Returns NULL if serialization fails (most likely because of insufficient memory).
@@ -770,6 +794,89 @@ int cif_parse_internal(
         cif_tp *dest
         ) INTERNAL;
 
+/*
+ * Prepares a reader for cif_reader_next() by allocating its scanner's buffer, reading the first character(s), and
+ * settling the CIF version.  The reader must otherwise be zero-initialized.
+ *
+ * @param[in,out] reader a pointer to the reader to start, whose scanner is initialized as for cif_parse_internal()
+ * @param[in] not_utf8 if non-zero, indicates that the characters provided by the scanner's character source are known
+ *         to be derived from an encoded byte sequence via an encoding different from UTF-8
+ */
+int cif_reader_start(
+        struct cif_reader_s *reader,
+        int not_utf8,
+        const char *extra_ws,
+        const char *extra_eol
+        ) INTERNAL;
+
+/*
+ * Releases the reader itself and the resources it holds, other than its scanner's character source.
+ */
+void cif_reader_free(
+        struct cif_reader_s *reader
+        ) INTERNAL_VOID;
+
+/*
+ * Starts a bulk-load transaction on the specified CIF, in which foreign key enforcement is suspended.  If the caller
+ * already has a transaction open then none is started, and the load simply becomes part of the caller's transaction.
+ *
+ * @param[in,out] cif the CIF that is about to receive a large volume of data
+ * @param[out] active the location where a flag should be recorded indicating whether a bulk-load transaction was
+ *         actually started; the caller must pass the CIF to cif_bulk_load_end() if and only if this flag is nonzero
+ */
+int cif_bulk_load_begin(
+        cif_tp *cif,
+        int *active
+        ) INTERNAL;
+
+/*
+ * Ends a bulk-load transaction started by cif_bulk_load_begin().  If the load succeeded, as indicated by 'result',
+ * then the cascading deletions that were deferred while foreign keys were not enforced are performed, the referential
+ * integrity of the data is verified, and the transaction is committed; otherwise, or if any of those steps fails, the
+ * whole transaction is rolled back.  Foreign key enforcement is restored in every case.
+ *
+ * @param[in,out] cif the CIF on which a bulk-load transaction is in progress
+ * @param[in] result the result code of the load
+ *
+ * @return Returns 'result' if it is other than CIF_OK; otherwise, CIF_OK if the load is committed or an error code
+ *         (typically CIF_ERROR) if not
+ */
+int cif_bulk_load_end(
+        cif_tp *cif,
+        int result
+        ) INTERNAL;
+
+/*
+ * Looks up the ID of an interned item name, consulting the CIF's name cache before the database.
+ *
+ * @param[in,out] cif the CIF whose interned names are to be consulted
+ * @param[in] name the normalized item name whose ID is requested
+ * @param[out] id the location where the ID should be recorded
+ *
+ * @return Returns CIF_OK on success, CIF_NOSUCH_ITEM if the name is not interned, or an error code on failure
+ */
+int cif_get_name_id(
+        cif_tp *cif,
+        const UChar *name,
+        int *id
+        ) INTERNAL;
+
+/*
+ * Looks up the interned item name having the specified ID, consulting the CIF's name cache before the database.
+ *
+ * @param[in,out] cif the CIF whose interned names are to be consulted
+ * @param[in] id the ID of the requested name
+ * @param[out] name the location where a pointer to the normalized name should be recorded.  The name belongs to the
+ *         cache, and it may be invalidated by any later change to the CIF, so callers that retain it must copy it
+ *
+ * @return Returns CIF_OK on success, CIF_NOSUCH_ITEM if no name has the specified ID, or an error code on failure
+ */
+int cif_get_item_name(
+        cif_tp *cif,
+        int id,
+        const UChar **name
+        ) INTERNAL;
+
 /*
  * Validates that the specified Unicode string contains only characters that are in the CIF 1.1 character set.  Returns
  * CIF_OK if all characters are allowed, or CIF_DISALLOWED_CHAR if not.
@@ -783,6 +890,42 @@ int cif_validate_cif11_characters(
         UChar **disallowed
         ) INTERNAL;
 
+/*
+ * Translates the specified predicate into an SQL condition on the rows of table item_value, true for those rows
+ * belonging to packets that satisfy the predicate.  The condition refers to the container ID and loop number as
+ * parameters ?1 and ?2, and to the predicate's constants as consecutive parameters starting at ?3, to which
+ * cif_predicate_bind() binds them.
+ *
+ * @param[in] predicate the predicate to translate
+ * @param[in] item_ids the IDs of the target loop's items, parallel to 'item_names'
+ * @param[in] item_names the target loop's _normalized_ item names, as a NULL-terminated array
+ * @param[out] sql the location where a pointer to the condition text should be recorded; the text belongs to the
+ *         caller
+ *
+ * @return Returns CIF_OK on success, CIF_WRONG_LOOP if the predicate refers to an item not named in 'item_names', or
+ *         an error code (typically CIF_MEMORY_ERROR) on failure
+ */
+int cif_predicate_to_sql(
+        const cif_predicate_tp *predicate,
+        const int *item_ids,
+        UChar **item_names,
+        char **sql
+        ) INTERNAL;
+
+/*
+ * Binds the constants of the specified predicate to the parameters of a statement prepared from SQL that includes
+ * the predicate's translation by cif_predicate_to_sql().
+ *
+ * @param[in] predicate the predicate whose constants are to be bound
+ * @param[in,out] stmt the prepared statement
+ *
+ * @return Returns SQLITE_OK on success, or an SQLite error code on failure
+ */
+int cif_predicate_bind(
+        const cif_predicate_tp *predicate,
+        sqlite3_stmt *stmt
+        ) INTERNAL;
+
 #ifdef __cplusplus
 }
 #endif
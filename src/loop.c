@@ -27,6 +27,9 @@
 #include "internal/compat.h"
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
 #include <assert.h>
 #include "cif.h"
 #include "internal/ciftypes.h"
@@ -38,6 +41,18 @@ static const char MULTIPLE_SCALAR_MESSAGE[49] = "Attempted to create multiple va
 
 static int dup_ustrings(UChar ***dest, UChar *src[]);
 static int cif_loop_get_names_internal(cif_loop_tp *loop, UChar ***item_names, int normalize);
+static int cif_loop_get_ids_internal(cif_loop_tp *loop, int **item_ids, UChar ***item_names);
+static int get_member_id(cif_loop_tp *loop, const UChar *item_name, int *name_id);
+static int cif_loop_get_packets_internal(cif_loop_tp *loop, UChar *selected_names[],
+        const cif_predicate_tp *predicate, cif_pktitr_tp **iterator);
+static int select_iterator_items(cif_pktitr_tp *iterator, UChar *selected_names[]);
+static int build_values_sql(cif_pktitr_tp *iterator, int restricted, const char *filter, char **sql);
+static int merge_iterator_items(cif_pktitr_tp *iterator, int *left_ids, UChar **left_names, int *right_ids,
+        UChar **right_names);
+static int init_iterator_entries(cif_pktitr_tp *iterator);
+static void clear_item_set(cif_loop_tp *loop);
+static int item_set_is_current(cif_loop_tp *loop);
+static int add_to_item_set(cif_loop_tp *loop, const UChar *norm_name);
 
 static int dup_ustrings(UChar ***dest, UChar *src[]) {
     if (src == NULL) {
@@ -103,6 +118,7 @@ void cif_loop_free(
         }
         free(loop->names);
     }
+    clear_item_set(loop);
     free(loop);
 }
 
@@ -136,6 +152,7 @@ int cif_loop_destroy(
                     /* no such loop (now) exists */
                     FAIL(soft, CIF_INVALID_HANDLE);
                 case 1:
+                    cif->loop_item_generation += 1;
                     cif_loop_free(loop);
                     return CIF_OK;
                 default:
@@ -333,6 +350,10 @@ int cif_loop_add_item_internal(
                             /* NOTE: sqlite3_changes() is not thread-safe */
                             && ((*changes = sqlite3_changes(cif->db)) || CIF_TRUE)
                             && (COMMIT_NESTTX(cif->db) == SQLITE_OK)) {
+                        if (item_set_is_current(loop)) {
+                            /* failure to cache the name is harmless, so the result is ignored */
+                            (void) add_to_item_set(loop, norm_name);
+                        }
                         return CIF_OK;
                     }
                     break;
@@ -344,7 +365,7 @@ int cif_loop_add_item_internal(
                 case SQLITE_CONSTRAINT:
                     TRACELINE;
                     sqlite3_reset(cif->add_loop_item_stmt);
-                    ROLLBACK_NESTTX(cif->db);
+                    ROLLBACK_NESTTX(cif);
                     FAIL(soft, CIF_DUP_ITEMNAME);
                 default:
                     TRACELINE;
@@ -353,7 +374,7 @@ int cif_loop_add_item_internal(
             }
         }
 
-        ROLLBACK_NESTTX(cif->db);
+        ROLLBACK_NESTTX(cif);
     }
 
     DROP_STMT(cif, add_loop_item);
@@ -368,18 +389,43 @@ int cif_loop_add_packet(
         cif_loop_tp *loop,
         cif_packet_tp *packet
         ) {
+    return cif_loop_add_packets(loop, &packet, 1);
+}
+
+/* All uthash fatal errors arise from memory allocation failure */
+#undef uthash_fatal
+#define uthash_fatal(msg) FAIL(soft, CIF_MEMORY_ERROR)
+
+/* safe to be called by anyone */
+int cif_loop_add_packets(
+        cif_loop_tp *loop,
+        cif_packet_tp **packets,
+        size_t count
+        ) {
     FAILURE_HANDLING;
     NESTTX_HANDLING;
     cif_container_tp *container = loop->container;
     cif_tp *cif;
+    struct set_element_s *name_set = NULL;
+    struct set_element_s *element;
+    struct set_element_s *temp_element;
+    struct entry_s *item;
+    size_t index;
 
     if (container == NULL) {
         return CIF_INVALID_HANDLE;
-    } else if (!packet->map.head) {
-        return CIF_INVALID_PACKET;
-    } else {
-        cif = container->cif;
+    } else if ((packets == NULL) || (count > INT_MAX)) {
+        return CIF_ARGUMENT_ERROR;
     }
+    for (index = 0; index < count; index += 1) {
+        if ((packets[index] == NULL) || !packets[index]->map.head) {
+            return CIF_INVALID_PACKET;
+        }
+    }
+    if (count == 0) {
+        return CIF_OK;
+    }
+    cif = container->cif;
 
     /*
      * Create any needed prepared statements, or prepare the existing one(s)
@@ -390,102 +436,135 @@ int cif_loop_add_packet(
     PREPARE_STMT(cif, check_item_loop, CHECK_ITEM_LOOP_SQL);
     PREPARE_STMT(cif, insert_value, INSERT_VALUE_SQL);
 
+    /* collect the distinct item names among all the packets, so that each is validated only once */
+    for (index = 0; index < count; index += 1) {
+        for (item = packets[index]->map.head; item != NULL; item = (struct entry_s *) item->hh.next) {
+            HASH_FIND(hh, name_set, item->key, U_BYTES(item->key), element);
+            if (element == NULL) {
+                element = (struct set_element_s *) malloc(sizeof(struct set_element_s));
+                if (element == NULL) {
+                    FAIL(soft, CIF_MEMORY_ERROR);
+                }
+                HASH_ADD_KEYPTR(hh, name_set, item->key, U_BYTES(item->key), element);
+            }
+        }
+    }
+
+    if (!item_set_is_current(loop)) {
+        clear_item_set(loop);
+    }
+
     if (BEGIN_NESTTX(cif->db) == SQLITE_OK) {
         STEP_HANDLING;
         int result = -1;
+        int name_id;
+
+        /*
+         * check that the items belong to the present loop, consulting the database only for those not already
+         * known to belong to it
+         */
+        if ((sqlite3_bind_int64(cif->check_item_loop_stmt, 1, container->id) != SQLITE_OK)
+                || (sqlite3_bind_int(cif->check_item_loop_stmt, 3, loop->loop_num) != SQLITE_OK)) {
+            DEFAULT_FAIL(hard);
+        }
+        for (element = name_set; element != NULL; element = (struct set_element_s *) element->hh.next) {
+            HASH_FIND(hh, loop->item_set, element->hh.key, element->hh.keylen, temp_element);
+            if (temp_element != NULL) {
+                continue;
+            }
+            switch (cif_get_name_id(cif, (const UChar *) element->hh.key, &name_id)) {
+                case CIF_OK:
+                    break;
+                case CIF_NOSUCH_ITEM:
+                    /* the name is not interned, so the item does not belong to any loop */
+                    FAIL(rb, CIF_WRONG_LOOP);
+                default:
+                    DEFAULT_FAIL(hard);
+            }
+            if (sqlite3_bind_int(cif->check_item_loop_stmt, 2, name_id) != SQLITE_OK) {
+                DEFAULT_FAIL(hard);
+            }
+            switch(STEP_STMT(cif, check_item_loop)) {
+                case SQLITE_DONE:
+                    /* the item does not belong to this loop */
+                    TRACELINE;
+                    FAIL(rb, CIF_WRONG_LOOP);
+                case SQLITE_ROW:
+                    TRACELINE;
+                    if (sqlite3_reset(cif->check_item_loop_stmt) != SQLITE_OK) {
+                        DEFAULT_FAIL(rb);
+                    }
+                    /* failure to cache the name is harmless, so the result is ignored */
+                    (void) add_to_item_set(loop, (const UChar *) element->hh.key);
+                    break;  /* break from switch */
+                default:
+                    TRACELINE;
+                    DEFAULT_FAIL(hard);
+            }
+        }
 
+        /* reserve a block of 'count' consecutive packet numbers */
         if ((sqlite3_bind_int64(cif->update_packet_num_stmt, 1, container->id) == SQLITE_OK)
                 && (sqlite3_bind_int(cif->update_packet_num_stmt, 2, loop->loop_num) == SQLITE_OK)
+                && (sqlite3_bind_int(cif->update_packet_num_stmt, 3, (int) count) == SQLITE_OK)
                 && ((result = STEP_STMT(cif, update_packet_num)) == SQLITE_DONE)
                 && (sqlite3_bind_int64(cif->get_packet_num_stmt, 1, container->id) == SQLITE_OK)
                 && (sqlite3_bind_int(cif->get_packet_num_stmt, 2, loop->loop_num) == SQLITE_OK)) {
-            int row_num;
-            struct entry_s *item;
+            int first_row_num;
 
-            /* determine the packet number to use */
             switch (STEP_STMT(cif, get_packet_num)) {
                 case SQLITE_ROW:
                     TRACELINE;
-                    /* If the result is NULL then the retrieval function returns it as 0: */
-                    row_num = sqlite3_column_int(cif->get_packet_num_stmt, 0);
-                    if ((sqlite3_reset(cif->get_packet_num_stmt) == SQLITE_OK)
-                            && (sqlite3_clear_bindings(cif->get_packet_num_stmt) == SQLITE_OK)
-                            && (sqlite3_bind_int64(cif->check_item_loop_stmt, 1, container->id) == SQLITE_OK)
-                            && (sqlite3_bind_int(cif->check_item_loop_stmt, 3, loop->loop_num) == SQLITE_OK)) {
-
-                        /* step through the entries in the packet */
-                        for (item = packet->map.head; ; item = (struct entry_s *) item->hh.next) {
-                            if (item == NULL) { /* no more entries */
-                                if (COMMIT_NESTTX(cif->db) == SQLITE_OK) {
-                                    return CIF_OK;
-                                } else {
-                                    DEFAULT_FAIL(hard);
-                                }
-                            }
+                    /* the reserved numbers end with the one now recorded */
+                    first_row_num = sqlite3_column_int(cif->get_packet_num_stmt, 0) - (int) count + 1;
+                    if ((sqlite3_reset(cif->get_packet_num_stmt) != SQLITE_OK)
+                            || (sqlite3_clear_bindings(cif->get_packet_num_stmt) != SQLITE_OK)) {
+                        DEFAULT_FAIL(hard);
+                    }
 
-                            /* check that the item belongs to the present loop */
-                            if (sqlite3_bind_text16(cif->check_item_loop_stmt, 2, item->key, -1, SQLITE_STATIC)
-                                    != SQLITE_OK) {
+                    /* insert all the values of all the packets */
+                    for (index = 0; index < count; index += 1) {
+                        for (item = packets[index]->map.head; item != NULL; item = (struct entry_s *) item->hh.next) {
+                            TRACELINE;
+                            if ((cif_get_name_id(cif, item->key, &name_id) != CIF_OK)
+                                    || (sqlite3_bind_int64(cif->insert_value_stmt, 1, container->id) != SQLITE_OK)
+                                    || (sqlite3_bind_int(cif->insert_value_stmt, 2, name_id) != SQLITE_OK)
+                                    || (sqlite3_bind_int(cif->insert_value_stmt, 3, first_row_num + (int) index)
+                                            != SQLITE_OK)
+                                    || (sqlite3_bind_int(cif->insert_value_stmt, 11, loop->loop_num) != SQLITE_OK)) {
                                 DEFAULT_FAIL(hard);
-                            } else {
-                                switch(STEP_STMT(cif, check_item_loop)) {
-                                    case SQLITE_DONE:
-                                        /* the item does not belong to this loop */
-                                        TRACELINE;
-                                        FAIL(rb, CIF_WRONG_LOOP);
-                                    case SQLITE_ROW:
-                                        TRACELINE;
-                                        if (sqlite3_reset(cif->check_item_loop_stmt) != SQLITE_OK) {
-                                            DEFAULT_FAIL(rb);
-                                        }
-                                        break;  /* break from switch */
-                                    default:
-                                        TRACELINE;
-                                        DEFAULT_FAIL(hard);
-                                }
                             }
-
-                            /* insert this item's value for this packet */
-                            TRACELINE;
-                            if ((sqlite3_bind_int64(cif->insert_value_stmt, 1, container->id) == SQLITE_OK)
-                                    && (sqlite3_bind_text16(cif->insert_value_stmt, 2, item->key, -1, SQLITE_STATIC)
-                                            == SQLITE_OK)
-                                    && (sqlite3_bind_int(cif->insert_value_stmt, 3, row_num) == SQLITE_OK)) {
-                                SET_VALUE_PROPS(cif->insert_value_stmt, 3, &(item->as_value), hard, rb);
-                                TRACELINE;
-                                switch (STEP_STMT(cif, insert_value)) {
-                                    case SQLITE_DONE:
-                                        /* one value recorded; move on to the next, if any */
-                                        TRACELINE;
-                                        if (sqlite3_clear_bindings(cif->insert_value_stmt) != SQLITE_OK) {
-                                            DEFAULT_FAIL(hard);
-                                        }
-                                        continue;
-                                    case SQLITE_ROW:
-                                        /* should not happen: insert statements do not return rows */
-                                        TRACELINE;
-                                        FAIL(rb, CIF_INTERNAL_ERROR);
-                                    default:
-                                        TRACELINE;
-                                        break; /* falls out of the switch, ultimately to fail hard */
-                                }
+                            SET_VALUE_PROPS(cif->insert_value_stmt, 3, &(item->as_value), hard, rb);
+                            switch (STEP_STMT(cif, insert_value)) {
+                                case SQLITE_DONE:
+                                    /* one value recorded; move on to the next, if any */
+                                    if (sqlite3_clear_bindings(cif->insert_value_stmt) != SQLITE_OK) {
+                                        DEFAULT_FAIL(hard);
+                                    }
+                                    break;
+                                case SQLITE_ROW:
+                                    /* should not happen: insert statements do not return rows */
+                                    TRACELINE;
+                                    FAIL(rb, CIF_INTERNAL_ERROR);
+                                default:
+                                    TRACELINE;
+                                    DEFAULT_FAIL(hard);
                             }
+                        }
+                    }
 
-                            TRACELINE;
-                            break; /* break out of the loop */
-
-                            FAILURE_HANDLER(rb):
-                            TRACELINE;
-                            ROLLBACK_NESTTX(cif->db);
-                            DEFAULT_FAIL(soft);
+                    if (COMMIT_NESTTX(cif->db) == SQLITE_OK) {
+                        HASH_ITER(hh, name_set, element, temp_element) {
+                            HASH_DEL(name_set, element);
+                            free(element);
                         }
+                        return CIF_OK;
                     }
                     break;
                 case SQLITE_DONE:
-                    /* should not happen: an aggregate selection must always return a row */
+                    /* should not happen: the loop's own row must be selected */
                     TRACELINE;
-                    ROLLBACK_NESTTX(cif->db);
-                    FAIL(soft, CIF_INTERNAL_ERROR);
+                    FAIL(rb, CIF_INTERNAL_ERROR);
                 /* default: do nothing */
             }
         } else if (result == SQLITE_CONSTRAINT) {
@@ -498,15 +577,25 @@ int cif_loop_add_packet(
         }
 
         FAILURE_HANDLER(hard):
-        (void) ROLLBACK_NESTTX(cif->db);
+        (void) ROLLBACK_NESTTX(cif);
     }
 
     DROP_STMT(cif, insert_value);
     DROP_STMT(cif, check_item_loop);
     DROP_STMT(cif, get_packet_num);
     DROP_STMT(cif, update_packet_num);
+    DEFAULT_FAIL(soft);
+
+    FAILURE_HANDLER(rb):
+    TRACELINE;
+    (void) ROLLBACK_NESTTX(cif);
 
     FAILURE_HANDLER(soft):
+    HASH_ITER(hh, name_set, element, temp_element) {
+        HASH_DEL(name_set, element);
+        free(element);
+    }
+
     FAILURE_TERMINUS;
 }
 
@@ -515,7 +604,170 @@ int cif_loop_get_packets(
         cif_loop_tp *loop,
         cif_pktitr_tp **iterator
         ) {
+    return cif_loop_get_packets_internal(loop, NULL, NULL, iterator);
+}
+
+int cif_loop_get_packets_for(
+        cif_loop_tp *loop,
+        UChar *item_names[],
+        cif_pktitr_tp **iterator
+        ) {
+    if (item_names == NULL) {
+        return CIF_ARGUMENT_ERROR;
+    } else {
+        return cif_loop_get_packets_internal(loop, item_names, NULL, iterator);
+    }
+}
+
+int cif_loop_select(
+        cif_loop_tp *loop,
+        const cif_predicate_tp *predicate,
+        cif_pktitr_tp **iterator
+        ) {
+    if (predicate == NULL) {
+        return CIF_ARGUMENT_ERROR;
+    } else {
+        return cif_loop_get_packets_internal(loop, NULL, predicate, iterator);
+    }
+}
+
+int cif_loop_join(
+        cif_loop_tp *left_loop,
+        const UChar *left_item,
+        cif_loop_tp *right_loop,
+        const UChar *right_item,
+        cif_pktitr_tp **iterator
+        ) {
     FAILURE_HANDLING;
+    NESTTX_HANDLING;
+    cif_tp *cif;
+    cif_pktitr_tp *temp_it;
+    int left_key_id;
+    int right_key_id;
+    int result;
+
+    if ((left_loop->container == NULL) || (right_loop->container == NULL)) {
+        return CIF_INVALID_HANDLE;
+    } else if ((iterator == NULL) || (left_loop->container->cif != right_loop->container->cif)) {
+        return CIF_ARGUMENT_ERROR;
+    } else if (((result = get_member_id(left_loop, left_item, &left_key_id)) != CIF_OK)
+            || ((result = get_member_id(right_loop, right_item, &right_key_id)) != CIF_OK)) {
+        return result;
+    } else {
+        cif = left_loop->container->cif;
+        /* every iterator holds the same savepoint open, so they cannot safely be ended out of order */
+        if (cif->open_iterators > 0) {
+            return CIF_MISUSE;
+        }
+    }
+
+    temp_it = (cif_pktitr_tp *) malloc(sizeof(cif_pktitr_tp));
+    if (!temp_it) {
+        SET_RESULT(CIF_MEMORY_ERROR);
+    } else {
+        int *left_ids = NULL;
+        int *right_ids = NULL;
+        UChar **left_names = NULL;
+        UChar **right_names = NULL;
+        char *sql;
+
+        /* initialize to NULL so we can later recognize where cleanup is needed */
+        temp_it->stmt = NULL;
+        temp_it->right_loop = NULL;
+        temp_it->item_names = NULL;
+        temp_it->item_ids = NULL;
+        temp_it->entries = NULL;
+        temp_it->name_set = NULL;
+        temp_it->finished = 0;
+
+        if ((result = cif_loop_get_ids_internal(left_loop, &left_ids, &left_names)) != CIF_OK) {
+            SET_RESULT(result);
+        } else if ((result = cif_loop_get_ids_internal(right_loop, &right_ids, &right_names)) != CIF_OK) {
+            SET_RESULT(result);
+        } else if ((result = merge_iterator_items(temp_it, left_ids, left_names, right_ids, right_names)) != CIF_OK) {
+            SET_RESULT(result);
+        } else if ((result = init_iterator_entries(temp_it)) != CIF_OK) {
+            SET_RESULT(result);
+        } else if ((sql = (char *) malloc(strlen(JOIN_LOOP_VALUES_SQL_HEAD) + strlen(JOIN_LOOP_VALUES_SQL_BODY)
+                + strlen(JOIN_LOOP_VALUES_SQL_TAIL) + 1)) == NULL) {
+            SET_RESULT(CIF_MEMORY_ERROR);
+        } else {
+            /* the query is assembled from parts to keep each string literal within the limits of C89 */
+            strcpy(sql, JOIN_LOOP_VALUES_SQL_HEAD);
+            strcat(sql, JOIN_LOOP_VALUES_SQL_BODY);
+            strcat(sql, JOIN_LOOP_VALUES_SQL_TAIL);
+            result = sqlite3_prepare_v2(cif->db, sql, -1, &(temp_it->stmt), NULL);
+            free(sql);
+            if (result == SQLITE_OK) {
+                if ((sqlite3_bind_int64(temp_it->stmt, 1, left_loop->container->id) == SQLITE_OK)
+                        && (sqlite3_bind_int(temp_it->stmt, 2, left_loop->loop_num) == SQLITE_OK)
+                        && (sqlite3_bind_int64(temp_it->stmt, 3, right_loop->container->id) == SQLITE_OK)
+                        && (sqlite3_bind_int(temp_it->stmt, 4, right_loop->loop_num) == SQLITE_OK)
+                        && (sqlite3_bind_int(temp_it->stmt, 5, left_key_id) == SQLITE_OK)
+                        && (sqlite3_bind_int(temp_it->stmt, 6, right_key_id) == SQLITE_OK)) {
+                    /* the iteration joins any enclosing transaction, such as one begun via cif_begin() */
+                    if (BEGIN_NESTTX(cif->db) == SQLITE_OK) {
+                        /* intentionally not using STEP_STMT(): */
+                        switch (sqlite3_step(temp_it->stmt)) {
+                            case SQLITE_DONE:
+                                /* no packets match; the iteration is finished before it starts */
+                                temp_it->finished = 1;
+                                /* fall through */
+                            case SQLITE_ROW:
+                                free(left_ids);
+                                free(left_names);
+                                free(right_ids);
+                                free(right_names);
+                                temp_it->previous_row_num = -1;
+                                temp_it->loop = left_loop;
+                                temp_it->right_loop = right_loop;
+                                temp_it->top_tx = _top_tx;
+                                cif->open_iterators += 1;
+                                *iterator = temp_it;
+                                /* transaction or savepoint is left open */
+                                return CIF_OK;
+                            /* default: do nothing */
+                        }
+                        (void) ROLLBACK_NESTTX(cif);
+                    }
+                }
+            }
+        }
+
+        /* clean up everything; the iterator owns the names once they have been merged */
+        if (temp_it->item_names == NULL) {
+            UChar **name;
+
+            for (name = left_names; (name != NULL) && (*name != NULL); name += 1) {
+                free(*name);
+            }
+            for (name = right_names; (name != NULL) && (*name != NULL); name += 1) {
+                free(*name);
+            }
+        }
+        free(left_ids);
+        free(left_names);
+        free(right_ids);
+        free(right_names);
+        cif_pktitr_free(temp_it);
+    }
+
+    FAILURE_TERMINUS;
+}
+
+/*
+ * Creates an iterator over the packets of the specified loop, covering either all the loop's items (when
+ * 'selected_names' is NULL) or only those named by the NULL-terminated array 'selected_names', and either all the
+ * loop's packets (when 'predicate' is NULL) or only those satisfying 'predicate'.
+ */
+static int cif_loop_get_packets_internal(
+        cif_loop_tp *loop,
+        UChar *selected_names[],
+        const cif_predicate_tp *predicate,
+        cif_pktitr_tp **iterator
+        ) {
+    FAILURE_HANDLING;
+    NESTTX_HANDLING;
     cif_container_tp *container = loop->container;
     cif_tp *cif;
     cif_pktitr_tp *temp_it;
@@ -526,70 +778,281 @@ int cif_loop_get_packets(
         return CIF_ARGUMENT_ERROR;
     } else {
         cif = container->cif;
+        /* every iterator holds the same savepoint open, so they cannot safely be ended out of order */
+        if (cif->open_iterators > 0) {
+            return CIF_MISUSE;
+        }
     }
 
     temp_it = (cif_pktitr_tp *) malloc(sizeof(cif_pktitr_tp));
     if (!temp_it) {
         SET_RESULT(CIF_MEMORY_ERROR);
     } else {
+        char *filter = NULL;
+        char *sql = NULL;
         int result;
 
         /* initialize to NULL so we can later recognize where cleanup is needed */
         temp_it->stmt = NULL;
+        temp_it->right_loop = NULL;
         temp_it->item_names = NULL;
+        temp_it->item_ids = NULL;
+        temp_it->entries = NULL;
         temp_it->name_set = NULL;
         temp_it->finished = 0;
 
-        if ((result = cif_loop_get_names_internal(loop, &(temp_it->item_names), CIF_TRUE)) != CIF_OK) {
+        if ((result = cif_loop_get_ids_internal(loop, &(temp_it->item_ids), &(temp_it->item_names))) != CIF_OK) {
+            SET_RESULT(result);
+        } else if ((predicate != NULL)
+                && ((result = cif_predicate_to_sql(predicate, temp_it->item_ids, temp_it->item_names, &filter))
+                        != CIF_OK)) {
+            SET_RESULT(result);
+        } else if ((selected_names != NULL) && ((result = select_iterator_items(temp_it, selected_names)) != CIF_OK)) {
+            SET_RESULT(result);
+        } else if (((selected_names != NULL) || (predicate != NULL))
+                && ((result = build_values_sql(temp_it, (selected_names != NULL), filter, &sql)) != CIF_OK)) {
+            SET_RESULT(result);
+        } else if ((result = init_iterator_entries(temp_it)) != CIF_OK) {
             SET_RESULT(result);
         } else {
-            UChar **name;
-
-/* All uthash fatal errors arise from memory allocation failure */
-#undef uthash_fatal
-#define uthash_fatal(msg) FAIL(soft, CIF_MEMORY_ERROR)
-            for (name = temp_it->item_names; *name; name += 1) {
-                struct set_element_s *element = (struct set_element_s *) malloc(sizeof(struct set_element_s));
-
-                if (element) {
-                    HASH_ADD_KEYPTR(hh, temp_it->name_set, *name, U_BYTES(*name), element);
-                } else {
-                    FAIL(soft, CIF_MEMORY_ERROR);
-                }
-            }
-
             /* prepare the SQL statement by which the values will be retrieved, and fetch the first row */
-            if (sqlite3_prepare_v2(cif->db, GET_LOOP_VALUES_SQL, -1, &(temp_it->stmt), NULL) == SQLITE_OK) {
+            result = sqlite3_prepare_v2(cif->db, ((sql == NULL) ? GET_LOOP_VALUES_SQL : sql), -1,
+                    &(temp_it->stmt), NULL);
+            free(sql);
+            sql = NULL;
+            if (result == SQLITE_OK) {
                 if ((sqlite3_bind_int64(temp_it->stmt, 1, container->id) == SQLITE_OK)
-                        && (sqlite3_bind_int(temp_it->stmt, 2, loop->loop_num) == SQLITE_OK)) {
-                    if (BEGIN(cif->db) == SQLITE_OK) {
+                        && (sqlite3_bind_int(temp_it->stmt, 2, loop->loop_num) == SQLITE_OK)
+                        && ((predicate == NULL) || (cif_predicate_bind(predicate, temp_it->stmt) == SQLITE_OK))) {
+                    /* the iteration joins any enclosing transaction, such as one begun via cif_begin() */
+                    if (BEGIN_NESTTX(cif->db) == SQLITE_OK) {
                         /* intentionally not using STEP_STMT(): */
                         switch (sqlite3_step(temp_it->stmt)) {
+                            case SQLITE_DONE:
+                                if (predicate == NULL) {
+                                    SET_RESULT(CIF_EMPTY_LOOP);
+                                    break;
+                                }
+                                /* no packets are selected; the iteration is finished before it starts */
+                                temp_it->finished = 1;
+                                /* fall through */
                             case SQLITE_ROW:
+                                free(filter);
                                 temp_it->previous_row_num = -1;
                                 temp_it->loop = loop;
+                                temp_it->top_tx = _top_tx;
+                                cif->open_iterators += 1;
                                 *iterator = temp_it;
-                                /* transaction is left open */
+                                /* transaction or savepoint is left open */
                                 return CIF_OK;
-                            case SQLITE_DONE:
-                                SET_RESULT(CIF_EMPTY_LOOP);
-                                /* fall through */
                             /* default: do nothing */
                         }
-                        (void) ROLLBACK(cif->db);
+                        (void) ROLLBACK_NESTTX(cif);
                     }
                 }
             }
         }
 
-        FAILURE_HANDLER(soft):
         /* clean up everything */
+        free(sql);
+        free(filter);
         cif_pktitr_free(temp_it);
     }
 
     FAILURE_TERMINUS;
 }
 
+int cif_loop_get_column_doubles(
+        cif_loop_tp *loop,
+        const UChar *item_name,
+        double **values,
+        double **sus,
+        cif_kind_tp **kinds,
+        size_t *count
+        ) {
+    FAILURE_HANDLING;
+    cif_container_tp *container = loop->container;
+    cif_tp *cif;
+    int name_id;
+    int result;
+
+    if (container == NULL) {
+        return CIF_INVALID_HANDLE;
+    } else if ((values == NULL) || (count == NULL)) {
+        return CIF_ARGUMENT_ERROR;
+    } else if (item_name == NULL) {
+        return CIF_INVALID_ITEMNAME;
+    } else {
+        cif = container->cif;
+    }
+
+    /*
+     * Create any needed prepared statements, or prepare the existing one(s)
+     * for re-use, exiting this function with an error on failure.
+     */
+    PREPARE_STMT(cif, get_column_values, GET_COLUMN_VALUES_SQL);
+
+    if ((result = get_member_id(loop, item_name, &name_id)) != CIF_OK) {
+        SET_RESULT(result);
+    } else {
+        STEP_HANDLING;
+
+        if ((sqlite3_bind_int64(cif->get_column_values_stmt, 1, container->id) == SQLITE_OK)
+                && (sqlite3_bind_int(cif->get_column_values_stmt, 2, loop->loop_num) == SQLITE_OK)
+                && (sqlite3_bind_int(cif->get_column_values_stmt, 3, name_id) == SQLITE_OK)) {
+            size_t capacity = 64;
+            size_t size = 0;
+            double *temp_values = (double *) malloc(capacity * sizeof(double));
+            double *temp_sus = (double *) malloc(capacity * sizeof(double));
+            cif_kind_tp *temp_kinds = (cif_kind_tp *) malloc(capacity * sizeof(cif_kind_tp));
+
+            if ((temp_values == NULL) || (temp_sus == NULL) || (temp_kinds == NULL)) {
+                FAIL(arrays, CIF_MEMORY_ERROR);
+            }
+
+            while ((result = STEP_STMT(cif, get_column_values)) == SQLITE_ROW) {
+                cif_kind_tp kind = (cif_kind_tp) sqlite3_column_int(cif->get_column_values_stmt, 0);
+
+                if (size >= capacity) {
+                    double *new_values;
+                    double *new_sus;
+                    cif_kind_tp *new_kinds;
+
+                    capacity *= 2;
+                    new_values = (double *) realloc(temp_values, capacity * sizeof(double));
+                    if (new_values == NULL) FAIL(arrays, CIF_MEMORY_ERROR);
+                    temp_values = new_values;
+                    new_sus = (double *) realloc(temp_sus, capacity * sizeof(double));
+                    if (new_sus == NULL) FAIL(arrays, CIF_MEMORY_ERROR);
+                    temp_sus = new_sus;
+                    new_kinds = (cif_kind_tp *) realloc(temp_kinds, capacity * sizeof(cif_kind_tp));
+                    if (new_kinds == NULL) FAIL(arrays, CIF_MEMORY_ERROR);
+                    temp_kinds = new_kinds;
+                }
+
+                temp_kinds[size] = kind;
+                if (kind == CIF_NUMB_KIND) {
+                    const char *su_digits = (const char *) sqlite3_column_text(cif->get_column_values_stmt, 2);
+
+                    temp_values[size] = sqlite3_column_double(cif->get_column_values_stmt, 1);
+                    temp_sus[size] = (su_digits == NULL) ? 0.0
+                            : cif_digits_to_double(su_digits, sqlite3_column_int(cif->get_column_values_stmt, 3));
+                } else {
+                    temp_values[size] = 0.0;
+                    temp_sus[size] = 0.0;
+                }
+                size += 1;
+            }
+
+            if (result == SQLITE_DONE) {
+                /* success */
+                *values = temp_values;
+                if (sus == NULL) {
+                    free(temp_sus);
+                } else {
+                    *sus = temp_sus;
+                }
+                if (kinds == NULL) {
+                    free(temp_kinds);
+                } else {
+                    *kinds = temp_kinds;
+                }
+                *count = size;
+                return CIF_OK;
+            }
+
+            sqlite3_reset(cif->get_column_values_stmt);
+            SET_RESULT(CIF_ERROR);
+
+            FAILURE_HANDLER(arrays):
+            free(temp_kinds);
+            free(temp_sus);
+            free(temp_values);
+            FAILURE_TERMINUS;
+        }
+
+        DROP_STMT(cif, get_column_values);
+    }
+
+    FAILURE_TERMINUS;
+}
+
+int cif_loop_aggregate(
+        cif_loop_tp *loop,
+        const UChar *item_name,
+        cif_aggregate_tp *aggregate
+        ) {
+    FAILURE_HANDLING;
+    cif_container_tp *container = loop->container;
+    cif_tp *cif;
+    int name_id;
+    int result;
+
+    if (container == NULL) {
+        return CIF_INVALID_HANDLE;
+    } else if (aggregate == NULL) {
+        return CIF_ARGUMENT_ERROR;
+    } else if (item_name == NULL) {
+        return CIF_INVALID_ITEMNAME;
+    } else {
+        cif = container->cif;
+    }
+
+    /*
+     * Create any needed prepared statements, or prepare the existing one(s)
+     * for re-use, exiting this function with an error on failure.
+     */
+    PREPARE_STMT(cif, aggregate_values, AGGREGATE_VALUES_SQL);
+
+    if ((result = get_member_id(loop, item_name, &name_id)) != CIF_OK) {
+        SET_RESULT(result);
+    } else {
+        STEP_HANDLING;
+
+        if ((sqlite3_bind_int64(cif->aggregate_values_stmt, 1, container->id) == SQLITE_OK)
+                && (sqlite3_bind_int(cif->aggregate_values_stmt, 2, loop->loop_num) == SQLITE_OK)
+                && (sqlite3_bind_int(cif->aggregate_values_stmt, 3, name_id) == SQLITE_OK)) {
+            sqlite3_stmt *stmt = cif->aggregate_values_stmt;
+            cif_aggregate_tp temp = { 0, 0, 0, 0, 0.0, 0.0, 0.0, 0.0 };
+
+            /* the query produces one row for each kind of value present */
+            while ((result = STEP_STMT(cif, aggregate_values)) == SQLITE_ROW) {
+                size_t kind_count = (size_t) sqlite3_column_int64(stmt, 1);
+
+                switch ((cif_kind_tp) sqlite3_column_int(stmt, 0)) {
+                    case CIF_NUMB_KIND:
+                        temp.numb_count = kind_count;
+                        temp.min = sqlite3_column_double(stmt, 2);
+                        temp.max = sqlite3_column_double(stmt, 3);
+                        temp.sum = sqlite3_column_double(stmt, 4);
+                        temp.mean = temp.sum / kind_count;
+                        break;
+                    case CIF_UNK_KIND:
+                        temp.unk_count = kind_count;
+                        break;
+                    case CIF_NA_KIND:
+                        temp.na_count = kind_count;
+                        break;
+                    default:
+                        temp.other_count += kind_count;
+                        break;
+                }
+            }
+
+            if (result == SQLITE_DONE) {
+                *aggregate = temp;
+                return CIF_OK;
+            }
+
+            sqlite3_reset(stmt);
+        }
+
+        DROP_STMT(cif, aggregate_values);
+    }
+
+    FAILURE_TERMINUS;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -653,7 +1116,8 @@ static int cif_loop_get_names_internal(cif_loop_tp *loop, UChar ***item_names, i
                             if (temp_names == NULL) {
                                 SET_RESULT(CIF_MEMORY_ERROR);
                             } else {
-                                ROLLBACK_NESTTX(cif->db);  /* no changes should have been made anyway */
+                                /* no changes were made; releasing rather than rolling back keeps the caches valid */
+                                (void) COMMIT_NESTTX(cif->db);
 
                                 temp_names[name_count] = NULL;
                                 LL_FOREACH_SAFE(name_list, next_name, temp_name) {
@@ -693,12 +1157,12 @@ static int cif_loop_get_names_internal(cif_loop_tp *loop, UChar ***item_names, i
                         free(next_name->string);
                         free(next_name);
                     }
-                    ROLLBACK_NESTTX(cif->db);
+                    ROLLBACK_NESTTX(cif);
                     DEFAULT_FAIL(soft);
                 }
             }
 
-            ROLLBACK_NESTTX(cif->db);
+            ROLLBACK_NESTTX(cif);
         }
 
         DROP_STMT(cif, get_loop_names);
@@ -707,3 +1171,401 @@ static int cif_loop_get_names_internal(cif_loop_tp *loop, UChar ***item_names, i
         FAILURE_TERMINUS;
     }
 }
+
+/*
+ * Retrieves the IDs of the items in the specified loop, in the order of their positions in the loop, together with
+ * their normalized names.  The name array is NULL-terminated, and the ID array has one fewer element.  Fails with
+ * CIF_INVALID_HANDLE if the loop has no items.
+ */
+static int cif_loop_get_ids_internal(cif_loop_tp *loop, int **item_ids, UChar ***item_names) {
+    FAILURE_HANDLING;
+    STEP_HANDLING;
+    cif_container_tp *container = loop->container;
+    cif_tp *cif = container->cif;
+    int *ids = NULL;
+    UChar **names = NULL;
+    int id_count = 0;
+    int id_capacity = 0;
+
+    /*
+     * Create any needed prepared statements, or prepare the existing one(s)
+     * for re-use, exiting this function with an error on failure.
+     */
+    PREPARE_STMT(cif, get_loop_name_ids, GET_LOOP_NAME_IDS_SQL);
+
+    if ((sqlite3_bind_int64(cif->get_loop_name_ids_stmt, 1, container->id) != SQLITE_OK)
+            || (sqlite3_bind_int(cif->get_loop_name_ids_stmt, 2, loop->loop_num) != SQLITE_OK)) {
+        DEFAULT_FAIL(hard);
+    }
+
+    /* read the IDs */
+    while (CIF_TRUE) {
+        switch (STEP_STMT(cif, get_loop_name_ids)) {
+            case SQLITE_ROW:
+                if (id_count >= id_capacity) {
+                    int *temp_ids;
+
+                    id_capacity = (id_capacity == 0) ? 16 : (2 * id_capacity);
+                    temp_ids = (int *) realloc(ids, sizeof(int) * id_capacity);
+                    if (temp_ids == NULL) {
+                        sqlite3_reset(cif->get_loop_name_ids_stmt);
+                        FAIL(soft, CIF_MEMORY_ERROR);
+                    }
+                    ids = temp_ids;
+                }
+                ids[id_count++] = sqlite3_column_int(cif->get_loop_name_ids_stmt, 0);
+                continue;
+            case SQLITE_DONE:
+                break;
+            default:
+                DEFAULT_FAIL(hard);
+        }
+        break;
+    }
+
+    if (id_count <= 0) {
+        FAIL(soft, CIF_INVALID_HANDLE);
+    }
+
+    /* look up the corresponding names */
+    names = (UChar **) calloc(id_count + 1, sizeof(UChar *));
+    if (names == NULL) {
+        FAIL(soft, CIF_MEMORY_ERROR);
+    } else {
+        int index;
+
+        for (index = 0; index < id_count; index += 1) {
+            const UChar *name;
+            int result = cif_get_item_name(cif, ids[index], &name);
+
+            if (result != CIF_OK) {
+                FAIL(soft, ((result == CIF_NOSUCH_ITEM) ? CIF_INTERNAL_ERROR : result));
+            }
+            names[index] = cif_u_strdup(name);
+            if (names[index] == NULL) {
+                FAIL(soft, CIF_MEMORY_ERROR);
+            }
+        }
+    }
+
+    *item_ids = ids;
+    *item_names = names;
+    return CIF_OK;
+
+    FAILURE_HANDLER(hard):
+    DROP_STMT(cif, get_loop_name_ids);
+
+    FAILURE_HANDLER(soft):
+    if (names != NULL) {
+        UChar **name;
+
+        for (name = names; *name; name += 1) {
+            free(*name);
+        }
+        free(names);
+    }
+    free(ids);
+    FAILURE_TERMINUS;
+}
+
+/*
+ * Determines the name ID of the named item, verifying that the item belongs to the specified loop.  Returns
+ * CIF_WRONG_LOOP if it does not.
+ */
+static int get_member_id(cif_loop_tp *loop, const UChar *item_name, int *name_id) {
+    FAILURE_HANDLING;
+    cif_container_tp *container = loop->container;
+    cif_tp *cif = container->cif;
+    UChar *norm_name;
+    int known_member;
+    int result;
+
+    /*
+     * Create any needed prepared statements, or prepare the existing one(s)
+     * for re-use, exiting this function with an error on failure.
+     */
+    PREPARE_STMT(cif, check_item_loop, CHECK_ITEM_LOOP_SQL);
+
+    if ((result = cif_normalize_item_name(item_name, -1, &norm_name, CIF_INVALID_ITEMNAME)) != CIF_OK) {
+        return result;
+    }
+    if (!item_set_is_current(loop)) {
+        clear_item_set(loop);
+        known_member = CIF_FALSE;
+    } else {
+        struct set_element_s *element;
+
+        HASH_FIND(hh, loop->item_set, norm_name, U_BYTES(norm_name), element);
+        known_member = (element != NULL);
+    }
+    result = cif_get_name_id(cif, norm_name, name_id);
+    free(norm_name);
+
+    if (result == CIF_NOSUCH_ITEM) {
+        /* the name is not interned, so the item does not belong to any loop */
+        return CIF_WRONG_LOOP;
+    } else if ((result != CIF_OK) || known_member) {
+        return result;
+    } else {
+        STEP_HANDLING;
+
+        /* check that the item belongs to this loop */
+        if ((sqlite3_bind_int64(cif->check_item_loop_stmt, 1, container->id) == SQLITE_OK)
+                && (sqlite3_bind_int(cif->check_item_loop_stmt, 2, *name_id) == SQLITE_OK)
+                && (sqlite3_bind_int(cif->check_item_loop_stmt, 3, loop->loop_num) == SQLITE_OK)) {
+            switch (STEP_STMT(cif, check_item_loop)) {
+                case SQLITE_DONE:
+                    return CIF_WRONG_LOOP;
+                case SQLITE_ROW:
+                    if (sqlite3_reset(cif->check_item_loop_stmt) == SQLITE_OK) {
+                        return CIF_OK;
+                    }
+                    break;
+                /* default: do nothing */
+            }
+        }
+
+        DROP_STMT(cif, check_item_loop);
+    }
+
+    FAILURE_TERMINUS;
+}
+
+/*
+ * Restricts the specified new iterator, whose item IDs and names cover its whole loop, to the items named by the
+ * NULL-terminated array 'selected_names'
+ */
+static int select_iterator_items(cif_pktitr_tp *iterator, UChar *selected_names[]) {
+    FAILURE_HANDLING;
+    int item_count;
+    int *selected;
+    int index;
+
+    for (item_count = 0; iterator->item_names[item_count] != NULL; item_count += 1) ;
+
+    if (*selected_names == NULL) {
+        return CIF_ARGUMENT_ERROR;
+    }
+
+    selected = (int *) calloc(item_count, sizeof(int));
+    if (selected == NULL) {
+        return CIF_MEMORY_ERROR;
+    } else {
+        int kept = 0;
+
+        /* mark the selected items; duplicate selections are harmless */
+        for (; *selected_names != NULL; selected_names += 1) {
+            UChar *norm_name;
+            int result = cif_normalize_item_name(*selected_names, -1, &norm_name, CIF_INVALID_ITEMNAME);
+
+            if (result != CIF_OK) {
+                FAIL(soft, result);
+            }
+            for (index = 0; index < item_count; index += 1) {
+                if (u_strcmp(norm_name, iterator->item_names[index]) == 0) {
+                    break;
+                }
+            }
+            free(norm_name);
+            if (index >= item_count) {
+                FAIL(soft, CIF_WRONG_LOOP);
+            }
+            selected[index] = CIF_TRUE;
+        }
+
+        /* compact the iterator's ID and name lists to the selected items, preserving their order */
+        for (index = 0; index < item_count; index += 1) {
+            if (selected[index]) {
+                iterator->item_ids[kept] = iterator->item_ids[index];
+                iterator->item_names[kept] = iterator->item_names[index];
+                kept += 1;
+            } else {
+                free(iterator->item_names[index]);
+            }
+        }
+        iterator->item_names[kept] = NULL;
+
+        SET_RESULT(CIF_OK);
+
+        FAILURE_HANDLER(soft):
+        free(selected);
+    }
+
+    FAILURE_TERMINUS;
+}
+
+/*
+ * Composes the text of a query for the values to be presented by the specified new iterator, restricted to the
+ * iterator's items if 'restricted' is true, and to the rows satisfying condition 'filter' if that is not NULL.  The
+ * query text belongs to the caller.
+ */
+static int build_values_sql(cif_pktitr_tp *iterator, int restricted, const char *filter, char **sql) {
+    size_t sql_len = strlen(GET_FILTERED_VALUES_SQL_HEAD) + strlen(GET_FILTERED_VALUES_SQL_TAIL) + 1;
+    char *sql_temp;
+    char *end;
+    int index;
+
+    if (restricted) {
+        /* room for the clause, and for each ID's decimal digits, a sign, and a separator */
+        for (index = 0; iterator->item_names[index] != NULL; index += 1) {
+            sql_len += 3 * sizeof(int) + 2;
+        }
+        sql_len += strlen(" and name_id in ()");
+    }
+    if (filter != NULL) {
+        sql_len += strlen(" and ") + strlen(filter);
+    }
+
+    sql_temp = (char *) malloc(sql_len);
+    if (sql_temp == NULL) {
+        return CIF_MEMORY_ERROR;
+    }
+
+    strcpy(sql_temp, GET_FILTERED_VALUES_SQL_HEAD);
+    end = sql_temp + strlen(sql_temp);
+    if (restricted) {
+        end += sprintf(end, " and name_id in (");
+        for (index = 0; iterator->item_names[index] != NULL; index += 1) {
+            end += sprintf(end, (index ? ",%d" : "%d"), iterator->item_ids[index]);
+        }
+        end += sprintf(end, ")");
+    }
+    if (filter != NULL) {
+        end += sprintf(end, " and %s", filter);
+    }
+    strcpy(end, GET_FILTERED_VALUES_SQL_TAIL);
+
+    *sql = sql_temp;
+    return CIF_OK;
+}
+
+/*
+ * Records in the specified new join iterator the items of both joined loops: the left loop's items, followed by the
+ * right loop's, each in the order of their positions in their loop, together with their parallel name lists.  On
+ * success, the iterator takes ownership of the individual names, but not of the arrays containing them.  Fails with
+ * CIF_DUP_ITEMNAME if the two loops share any item.
+ */
+static int merge_iterator_items(cif_pktitr_tp *iterator, int *left_ids, UChar **left_names, int *right_ids,
+        UChar **right_names) {
+    int left_count;
+    int right_count;
+    int left_index;
+    int right_index;
+
+    for (left_count = 0; left_names[left_count] != NULL; left_count += 1) ;
+    for (right_count = 0; right_names[right_count] != NULL; right_count += 1) ;
+
+    /* loops have few items, so a pairwise comparison suffices to detect shared ones */
+    for (left_index = 0; left_index < left_count; left_index += 1) {
+        for (right_index = 0; right_index < right_count; right_index += 1) {
+            if (left_ids[left_index] == right_ids[right_index]) {
+                return CIF_DUP_ITEMNAME;
+            }
+        }
+    }
+
+    iterator->item_ids = (int *) malloc(sizeof(int) * (left_count + right_count));
+    if (iterator->item_ids == NULL) {
+        return CIF_MEMORY_ERROR;
+    }
+    iterator->item_names = (UChar **) malloc(sizeof(UChar *) * (left_count + right_count + 1));
+    if (iterator->item_names == NULL) {
+        return CIF_MEMORY_ERROR;
+    }
+
+    memcpy(iterator->item_ids, left_ids, sizeof(int) * left_count);
+    memcpy(iterator->item_ids + left_count, right_ids, sizeof(int) * right_count);
+    memcpy(iterator->item_names, left_names, sizeof(UChar *) * left_count);
+    memcpy(iterator->item_names + left_count, right_names, sizeof(UChar *) * right_count);
+    iterator->item_names[left_count + right_count] = NULL;
+
+    return CIF_OK;
+}
+
+/*
+ * Prepares the scratch entry array and the item name set of the specified new iterator, whose item IDs and names
+ * have already been recorded.
+ */
+static int init_iterator_entries(cif_pktitr_tp *iterator) {
+    FAILURE_HANDLING;
+    UChar **name;
+
+    for (name = iterator->item_names; *name; name += 1) ;
+    iterator->entries = (struct entry_s **) malloc(sizeof(struct entry_s *) * (name - iterator->item_names));
+    if (iterator->entries == NULL) {
+        FAIL(soft, CIF_MEMORY_ERROR);
+    }
+
+    for (name = iterator->item_names; *name; name += 1) {
+        struct set_element_s *element = (struct set_element_s *) malloc(sizeof(struct set_element_s));
+
+        if (element) {
+            HASH_ADD_KEYPTR(hh, iterator->name_set, *name, U_BYTES(*name), element);
+        } else {
+            FAIL(soft, CIF_MEMORY_ERROR);
+        }
+    }
+
+    return CIF_OK;
+
+    FAILURE_HANDLER(soft):
+    FAILURE_TERMINUS;
+}
+
+/*
+ * Releases all the names cached in the specified loop handle's item set
+ */
+static void clear_item_set(cif_loop_tp *loop) {
+    struct set_element_s *element;
+    struct set_element_s *temp_element;
+
+    HASH_ITER(hh, loop->item_set, element, temp_element) {
+        HASH_DEL(loop->item_set, element);
+        free(element->hh.key);
+        free(element);
+    }
+}
+
+/*
+ * Determines whether the specified loop handle's item set may still be relied upon, in the sense that no item it
+ * records may since have been removed from the loop.  A handle whose set is found to be stale has its generation
+ * updated on the assumption that the caller will clear the set.
+ */
+static int item_set_is_current(cif_loop_tp *loop) {
+    cif_tp *cif = loop->container->cif;
+
+    if (loop->item_set_generation == cif->loop_item_generation) {
+        return CIF_TRUE;
+    } else {
+        loop->item_set_generation = cif->loop_item_generation;
+        return (loop->item_set == NULL);
+    }
+}
+
+/*
+ * Records the specified normalized item name in the specified loop handle's item set, which must be current
+ */
+static int add_to_item_set(cif_loop_tp *loop, const UChar *norm_name) {
+    FAILURE_HANDLING;
+    struct set_element_s *element;
+    UChar *key;
+
+    HASH_FIND(hh, loop->item_set, norm_name, U_BYTES(norm_name), element);
+    if (element != NULL) {
+        return CIF_OK;
+    }
+
+    key = cif_u_strdup(norm_name);
+    if (key != NULL) {
+        element = (struct set_element_s *) malloc(sizeof(struct set_element_s));
+        if (element != NULL) {
+            HASH_ADD_KEYPTR(hh, loop->item_set, key, U_BYTES(key), element);
+            return CIF_OK;
+        }
+        FAILURE_HANDLER(soft):
+        free(key);
+    }
+
+    SET_RESULT(CIF_MEMORY_ERROR);
+    FAILURE_TERMINUS;
+}
@@ -300,6 +300,12 @@
 /* For UChar: */
 #include <unicode/umachine.h>
 
+#ifdef __SSE2__
+/* SSE2 is part of the x86-64 baseline, so it can be used without a run-time feature test wherever it is enabled */
+#define SCAN_SSE2
+#include <emmintrin.h>
+#endif
+
 #include "cif.h"
 #include "internal/utils.h"
 #include "internal/value.h"
@@ -322,6 +328,23 @@
 #define CIF1_MAX_CHAR 0x7E
 #define EOF_CHAR      0xFFFF
 
+/*
+ * The range of printable ASCII characters other than space.  None of these is ever disallowed, nor (except when so
+ * designated via the extra whitespace or end-of-line characters parse options) whitespace or end-of-line; the scanners
+ * may therefore pass over runs of them without character-by-character validation and classification.
+ */
+#define MIN_PLAIN_CHAR 0x21
+#define MAX_PLAIN_CHAR CIF1_MAX_CHAR
+
+/* Evaluates whether the specified code unit is in the range of plain characters; may evaluate its argument twice */
+#define IS_PLAIN_CHAR(c) (((c) >= MIN_PLAIN_CHAR) && ((c) <= MAX_PLAIN_CHAR))
+
+/* The number of code units examined together by the plain character scanning kernel */
+#define SCAN_STRIDE 8
+
+/* The number of plain characters that may be designated to stop a scan for special characters */
+#define STOP_COUNT 4
+
 #if (CHAR_TABLE_MAX <= CIF1_MAX_CHAR)
 #error "character class table is too small"
 #endif
@@ -341,6 +364,11 @@ static const UChar CIF1_MAGIC[MAGIC_LENGTH]
 static const UChar CIF2_MAGIC[MAGIC_LENGTH]
         = { 0x23, 0x5c, 0x23, 0x43, 0x49, 0x46, 0x5f, 0x32, 0x2e, 0x30 }; /* #\#CIF_2.0 */
 
+/* stop characters for find_special_char(); unused positions are filled with a non-plain character */
+static const UChar NO_STOPS[STOP_COUNT] = { 0, 0, 0, 0 };
+static const UChar BRACKET_STOPS[STOP_COUNT] = { 0x5b, 0x5d, 0x7b, 0x7d }; /* [ ] { } */
+static const UChar SEMI_STOPS[STOP_COUNT] = { UCHAR_SEMI, 0, 0, 0 };
+
 
 /* static function headers */
 
@@ -366,12 +394,26 @@ static int scan_unquoted(struct scanner_s *scanner);
 static int scan_delim_string(struct scanner_s *scanner);
 static int scan_triple_delim_string(struct scanner_s *scanner);
 static int scan_text(struct scanner_s *scanner);
+static UChar *find_special_char(UChar *start, UChar *end, const UChar stops[]);
+static UChar *find_nonblank_char(UChar *start, UChar *end);
+static size_t skip_plain_chars(struct scanner_s *scanner, const UChar stops[]);
 static int get_first_char(struct scanner_s *scanner);
 static int get_more_chars(struct scanner_s *scanner);
 
 /* other functions */
+static int start_scan(struct scanner_s *scanner, int not_utf8, const char *extra_ws, const char *extra_eol);
 static int decode_text(struct scanner_s *scanner, UChar *text, int32_t text_length, cif_value_tp **dest);
 
+/* pull reader functions */
+static int read_container_token(struct cif_reader_s *reader, cif_event_tp *event, int *have_event);
+static int read_loop_token(struct cif_reader_s *reader, cif_event_tp *event, int *have_event);
+static int read_item_value(struct cif_reader_s *reader, cif_event_tp *event);
+static int split_key_token(struct scanner_s *scanner, enum token_type ttype);
+static int set_reader_name(struct cif_reader_s *reader, const UChar *name, int32_t length);
+static int add_loop_name(struct cif_reader_s *reader, const UChar *name, int32_t length);
+static void next_loop_column(struct cif_reader_s *reader);
+static void end_reader_loop(struct cif_reader_s *reader);
+
 /* function-like macros */
 
 #define INIT_V2_SCANNER(s, ws, eol) do { \
@@ -388,16 +430,19 @@ static int decode_text(struct scanner_s *scanner, UChar *text, int32_t text_leng
     for (_i =  32; _i < 127;            _i += 1) _s->char_class[_i] = GENERAL_CLASS; \
     for (_i = 128; _i < CHAR_TABLE_MAX; _i += 1) _s->char_class[_i] = NO_CLASS; \
     for (_i =   1; _i <= LAST_CLASS;    _i += 1) _s->meta_class[_i] = GENERAL_META; \
+    _s->printables_plain = CIF_TRUE; \
     if (ws) { \
         for (_c = ws; *_c; _c += 1) { \
             unsigned char uc = *_c; \
             if (uc < CHAR_TABLE_MAX) _s->char_class[uc] = WS_CLASS; \
+            if (IS_PLAIN_CHAR(uc)) _s->printables_plain = CIF_FALSE; \
         } \
     } \
     if (eol) { \
         for (_c = eol; *_c; _c += 1) { \
             unsigned char uc = *_c; \
             if (uc < CHAR_TABLE_MAX) _s->char_class[uc] = EOL_CLASS; \
+            if (IS_PLAIN_CHAR(uc)) _s->printables_plain = CIF_FALSE; \
         } \
     } \
     _s->char_class[UCHAR_TAB] =   WS_CLASS; \
@@ -751,86 +796,98 @@ int cif_parse_internal(struct scanner_s *scanner, int not_utf8, const char *extr
     if (scanner->buffer == NULL) {
         SET_RESULT(CIF_MEMORY_ERROR);
     } else {
-        UChar c;
-
-        INIT_V2_SCANNER(scanner, extra_ws, extra_eol);
-        scanner->next_char = scanner->buffer;
-        scanner->text_start = scanner->buffer;
-        scanner->tvalue_start = scanner->buffer;
-        scanner->tvalue_length = 0;
-
-        /*
-         * We must avoid get_more_chars() here (and also NEXT_CHAR, which uses it) because we want -- here only -- to
-         * accept a byte-order mark.
-         */
-        FAILURE_VARIABLE = get_first_char(scanner);
+        FAILURE_VARIABLE = start_scan(scanner, not_utf8, extra_ws, extra_eol);
 
         if (FAILURE_VARIABLE == CIF_EOF) {
-            /* empty CIF */
+            /* empty or BOM-only CIF; nothing else to do */
             FAILURE_VARIABLE = CIF_OK;
+        } else if ((FAILURE_VARIABLE == CIF_OK) && (dest != NULL) && (scanner->bulk_load != 0)) {
+            int bulk_active;
+
+            if ((FAILURE_VARIABLE = cif_bulk_load_begin(dest, &bulk_active)) == CIF_OK) {
+                FAILURE_VARIABLE = parse_cif(scanner, dest);
+                if (bulk_active) {
+                    FAILURE_VARIABLE = cif_bulk_load_end(dest, FAILURE_VARIABLE);
+                }
+            }
         } else if (FAILURE_VARIABLE == CIF_OK) {
-            int scanned_bom;
+            SET_RESULT(parse_cif(scanner, dest));
+        }
 
-            c = *(scanner->next_char++);
+        free(scanner->buffer);
+    }
 
-            /* consume an initial BOM, if present, regardless of the actual source encoding */
-            /* NOTE: assumes that the character decoder, if any, does not also consume an initial BOM */
-            if ((scanned_bom = (c == UCHAR_BOM))) {
-                CONSUME_TOKEN(scanner);
-                NEXT_CHAR(scanner, c, FAILURE_VARIABLE);
-            }
+    GENERAL_TERMINUS;
+}
 
-            if (FAILURE_VARIABLE == CIF_EOF) {
-                /* BOM-only CIF; nothing else to do */
-                FAILURE_VARIABLE = CIF_OK;
-            } else if (FAILURE_VARIABLE == CIF_OK) {
-                /* If the CIF version is uncertain then use the CIF magic code, if any, to choose */
-                if (scanner->cif_version <= 0) {
-                    scanner->cif_version = (scanner->cif_version < 0) ? -scanner->cif_version : 1;
-                    if (CLASS_OF(c, scanner) == HASH_CLASS) {
-                        if ((FAILURE_VARIABLE = scan_to_ws(scanner)) != CIF_OK) {
-                            DEFAULT_FAIL(early);
-                        }
-                        if (TVALUE_LENGTH(scanner) == MAGIC_LENGTH) {
-                            if (u_strncmp(TVALUE_START(scanner), CIF2_MAGIC, MAGIC_LENGTH) == 0) {
-                                scanner->cif_version = 2;
-                            } else if (u_strncmp(TVALUE_START(scanner), CIF1_MAGIC, MAGIC_LENGTH - 3) == 0) {
-                                /* recognize magic codes for all CIF versions other than 2.0 as CIF 1 */
-                                scanner->cif_version = 1;
-                            }
-                        }
-                    }
-                }
+int cif_reader_start(struct cif_reader_s *reader, int not_utf8, const char *extra_ws, const char *extra_eol) {
+    struct scanner_s *scanner = &reader->scanner;
+    int result;
+
+    scanner->buffer = (UChar *) malloc(BUF_SIZE_INITIAL * sizeof(UChar));
+    scanner->buffer_size = BUF_SIZE_INITIAL;
+    scanner->buffer_limit = 0;
 
-                /* reset the scanner */
-                scanner->next_char = scanner->text_start;
-                scanner->column = 0;
+    if (scanner->buffer == NULL) {
+        return CIF_MEMORY_ERROR;
+    }
 
-                if (scanner->cif_version == 1) {
-                    if (scanned_bom) {
-                        /* error: disallowed CIF 1 character */
-                        FAILURE_VARIABLE = scanner->error_callback(CIF_DISALLOWED_CHAR, 1, 0,
-                                scanner->next_char - 1, 1, scanner->user_data);
-                        /* recover, if necessary, by ignoring the problem */
-                    }
-                    SET_V1(scanner);
-                } else if ((scanner->cif_version == 2) && (not_utf8 != 0)) {
-                    /* error: CIF2 but not UTF-8 */
-                    FAILURE_VARIABLE = scanner->error_callback(CIF_WRONG_ENCODING, 1, 1, scanner->next_char, 0,
-                            scanner->user_data);
-                    /* recover, if necessary, by ignoring the problem */
-                }
-                if (FAILURE_VARIABLE == CIF_OK) {
-                    SET_RESULT(parse_cif(scanner, dest));
-                }
+    result = start_scan(scanner, not_utf8, extra_ws, extra_eol);
+    if (result == CIF_EOF) {
+        /* empty or BOM-only CIF */
+        reader->finished = CIF_TRUE;
+        result = CIF_OK;
+    }
+
+    return result;
+}
+
+void cif_reader_free(struct cif_reader_s *reader) {
+    end_reader_loop(reader);
+    free(reader->name);
+    if (reader->value != NULL) {
+        cif_value_free(reader->value);
+    }
+    free(reader->scanner.buffer);
+    free(reader);
+}
+
+int cif_reader_next(cif_reader_tp *reader, cif_event_tp *event) {
+    struct scanner_s *scanner;
+
+    if ((reader == NULL) || (event == NULL)) {
+        return CIF_ARGUMENT_ERROR;
+    }
+
+    scanner = &reader->scanner;
+
+    while (!reader->finished) {
+        int have_event = CIF_FALSE;
+        int result;
+
+        /* tokens that yield no event may nevertheless have touched the event, as when a stray value is discarded */
+        event->name = NULL;
+        event->item_names = NULL;
+        event->text = NULL;
+        event->text_length = 0;
+        event->value_kind = CIF_UNK_KIND;
+        event->quoted = CIF_NOT_QUOTED;
+        event->value = NULL;
+
+        if ((result = next_token(scanner)) == CIF_OK) {
+            if (reader->loop_names != NULL) {
+                result = read_loop_token(reader, event, &have_event);
+            } else {
+                result = read_container_token(reader, event, &have_event);
             }
         }
 
-        FAILURE_HANDLER(early):
-        free(scanner->buffer);
+        if ((result != CIF_OK) || have_event) {
+            return result;
+        }
     }
 
-    GENERAL_TERMINUS;
+    return CIF_FINISHED;
 }
 
 #ifdef __cplusplus
@@ -1382,7 +1439,7 @@ static int parse_loop(struct scanner_s *scanner, cif_container_tp *container) {
                 int column_count = 0;
                
                 /* dummy_loop is a static adapter; of its elements, it owns only 'category' */
-                cif_loop_tp dummy_loop = { NULL, -1, NULL, NULL };
+                cif_loop_tp dummy_loop = { NULL, -1, NULL, NULL, NULL, 0 };
 
                 dummy_loop.container = container;
                 dummy_loop.names = names; 
@@ -2044,6 +2101,13 @@ static int parse_table(struct scanner_s *scanner, cif_value_tp **tablep) {
     } /* while */
 
     table_end:
+
+    if (result == CIF_OK) {
+        *tablep = table;
+    } else if (table != *tablep) {
+        cif_value_free(table);
+    }
+
     return result;
 }
 
@@ -2151,6 +2215,578 @@ static int parse_value(struct scanner_s *scanner, cif_value_tp **valuep) {
 }
 
 
+/*
+ * Handles the scanner's current token, which is not in a loop body, on behalf of a pull reader.  Sets the flag
+ * pointed to by have_event if the token completes an event for the caller; otherwise, the event is not meaningful.
+ * Tokens are consumed as they are handled, except those that close an open context, which are left for the next call.
+ */
+static int read_container_token(struct cif_reader_s *reader, cif_event_tp *event, int *have_event) {
+    struct scanner_s *scanner = &reader->scanner;
+    enum token_type alt_ttype = QVALUE;
+    int result = CIF_OK;
+
+    if (!reader->in_block && (scanner->ttype != BLOCK_HEAD) && (scanner->ttype != END)) {
+        /* error: missing data block header */
+        result = scanner->error_callback(CIF_NO_BLOCK_HEADER, scanner->line,
+                scanner->column - TVALUE_LENGTH(scanner), TVALUE_START(scanner), TVALUE_LENGTH(scanner),
+                scanner->user_data);
+        /* recover by reporting an anonymous block to contain the content; do not consume the token */
+        if ((result == CIF_OK) && ((result = set_reader_name(reader, &cif_uchar_nul, 0)) == CIF_OK)) {
+            reader->in_block = CIF_TRUE;
+            event->kind = CIF_BLOCK_EVENT;
+            event->name = reader->name;
+            *have_event = CIF_TRUE;
+        }
+        return result;
+    }
+
+    switch (scanner->ttype) {
+        case BLOCK_HEAD:
+            if (reader->frame_depth > 0) {
+                /* error: unterminated save frame */
+                result = scanner->error_callback(CIF_NO_FRAME_TERM, scanner->line,
+                        scanner->column - TVALUE_LENGTH(scanner), TVALUE_START(scanner), TVALUE_LENGTH(scanner),
+                        scanner->user_data);
+                /* recover, if so directed, by closing the frame; do not consume the token */
+                if (result == CIF_OK) {
+                    reader->frame_depth -= 1;
+                    event->kind = CIF_FRAME_END_EVENT;
+                    *have_event = CIF_TRUE;
+                }
+            } else if ((result = set_reader_name(reader, TVALUE_START(scanner), TVALUE_LENGTH(scanner))) == CIF_OK) {
+                CONSUME_TOKEN(scanner);
+                reader->in_block = CIF_TRUE;
+                event->kind = CIF_BLOCK_EVENT;
+                event->name = reader->name;
+                *have_event = CIF_TRUE;
+            }
+            break;
+        case FRAME_HEAD:
+            if (scanner->max_frame_depth == 0) {
+                /* save frames are not permitted */
+                result = scanner->error_callback(CIF_FRAME_NOT_ALLOWED, scanner->line,
+                        scanner->column - TVALUE_LENGTH(scanner), TVALUE_START(scanner), TVALUE_LENGTH(scanner),
+                        scanner->user_data);
+                /* recover, if so directed, by acting as if max_frame_depth were 1 */
+                if ((result != CIF_OK) || (reader->frame_depth > 0)) {
+                    goto close_frame;
+                }
+            } else if ((scanner->max_frame_depth == 1) && (reader->frame_depth > 0)) {
+                /* nested save frames are not permitted */
+                result = scanner->error_callback(CIF_NO_FRAME_TERM, scanner->line,
+                        scanner->column - TVALUE_LENGTH(scanner), TVALUE_START(scanner), TVALUE_LENGTH(scanner),
+                        scanner->user_data);
+                /* recover, if so directed, by assuming the missing terminator */
+                goto close_frame;
+            }
+
+            if ((result = set_reader_name(reader, TVALUE_START(scanner), TVALUE_LENGTH(scanner))) == CIF_OK) {
+                CONSUME_TOKEN(scanner);
+                reader->frame_depth += 1;
+                event->kind = CIF_FRAME_EVENT;
+                event->name = reader->name;
+                *have_event = CIF_TRUE;
+            }
+            break;
+
+            close_frame:
+            /* do not consume the token */
+            if (result == CIF_OK) {
+                reader->frame_depth -= 1;
+                event->kind = CIF_FRAME_END_EVENT;
+                *have_event = CIF_TRUE;
+            }
+            break;
+        case FRAME_TERM:
+            /* consume the token in all cases */
+            CONSUME_TOKEN(scanner);
+            if (reader->frame_depth > 0) {
+                /* close the context */
+                reader->frame_depth -= 1;
+                event->kind = CIF_FRAME_END_EVENT;
+                *have_event = CIF_TRUE;
+            } else {
+                /* error: unexpected frame terminator */
+                result = scanner->error_callback(CIF_UNEXPECTED_TERM, scanner->line,
+                        scanner->column - TVALUE_LENGTH(scanner), TVALUE_START(scanner),
+                        TVALUE_LENGTH(scanner), scanner->user_data);
+                /* recover by dropping the token */
+            }
+            break;
+        case LOOPKW:
+            OPTIONAL_VOIDCALL( scanner->keyword_callback, (scanner->line, scanner->column,
+                    TVALUE_START(scanner), TVALUE_LENGTH(scanner), scanner->user_data) );
+            CONSUME_TOKEN(scanner);
+
+            /* parse the header */
+            while (((result = next_token(scanner)) == CIF_OK) && (scanner->ttype == NAME)) {
+                OPTIONAL_VOIDCALL( scanner->dataname_callback, (scanner->line, scanner->column,
+                        TVALUE_START(scanner), TVALUE_LENGTH(scanner), scanner->user_data) );
+                if ((result = add_loop_name(reader, TVALUE_START(scanner), TVALUE_LENGTH(scanner))) != CIF_OK) {
+                    break;
+                }
+                CONSUME_TOKEN(scanner);
+            }
+
+            if (result != CIF_OK) {
+                break;
+            } else if (reader->column_count == 0) {
+                /* error: empty loop header */
+                result = scanner->error_callback(CIF_NULL_LOOP, scanner->line,
+                        scanner->column - TVALUE_LENGTH(scanner), TVALUE_START(scanner), 0, scanner->user_data);
+                /* recover by ignoring it */
+            } else {
+                /* the loop body follows */
+                reader->column_index = 0;
+                reader->packet_open = CIF_FALSE;
+                reader->have_packets = CIF_FALSE;
+                reader->partial_packet = CIF_FALSE;
+                event->kind = CIF_LOOP_START_EVENT;
+                event->item_names = reader->loop_names;
+                *have_event = CIF_TRUE;
+            }
+            break;
+        case NAME:
+            OPTIONAL_VOIDCALL( scanner->dataname_callback, (scanner->line, scanner->column, TVALUE_START(scanner),
+                    TVALUE_LENGTH(scanner), scanner->user_data) );
+            if (((result = set_reader_name(reader, TVALUE_START(scanner), TVALUE_LENGTH(scanner))) != CIF_OK)) {
+                break;
+            }
+            CONSUME_TOKEN(scanner);
+            if ((result = next_token(scanner)) != CIF_OK) {
+                break;
+            }
+
+            switch (scanner->ttype) {
+                case TKEY:
+                    alt_ttype = TVALUE;
+                    /* fall through */
+                case KEY:
+                    if ((result = split_key_token(scanner, alt_ttype)) != CIF_OK) {
+                        break;
+                    }
+                    /* fall through */
+                case OLIST:  /* opening delimiter of a list value */
+                case OTABLE: /* opening delimiter of a table value */
+                case TVALUE:
+                case QVALUE:
+                case VALUE:
+                    result = read_item_value(reader, event);
+                    break;
+                default:
+                    /* error: missing value */
+                    result = scanner->error_callback(CIF_MISSING_VALUE, scanner->line,
+                            scanner->column - TVALUE_LENGTH(scanner), TVALUE_START(scanner),
+                            TVALUE_LENGTH(scanner), scanner->user_data);
+                    /* recover by reporting a synthetic unknown value; do not consume the token */
+                    break;
+            }
+
+            if (result == CIF_OK) {
+                event->kind = CIF_ITEM_EVENT;
+                event->name = reader->name;
+                *have_event = CIF_TRUE;
+            }
+            break;
+        case TKEY:
+            alt_ttype = TVALUE;
+            /* fall through */
+        case KEY:
+            if ((result = split_key_token(scanner, alt_ttype)) != CIF_OK) {
+                break;
+            }
+            /* fall through */
+        case TVALUE:
+        case QVALUE:
+        case VALUE:
+        case OLIST:  /* opening delimiter of a list value */
+        case OTABLE: /* opening delimiter of a table value */
+            /* error: unexpected value */
+            result = scanner->error_callback(CIF_UNEXPECTED_VALUE, scanner->line,
+                    1 + scanner->column - TVALUE_LENGTH(scanner), TVALUE_START(scanner),
+                    TVALUE_LENGTH(scanner), scanner->user_data);
+            if (result == CIF_OK) {
+                /* recover by consuming and discarding the value */
+                result = read_item_value(reader, event);
+            }
+            break;
+        case CTABLE:
+        case CLIST:
+            /* error: unexpected closing delimiter */
+            result = scanner->error_callback(CIF_UNEXPECTED_DELIM, scanner->line,
+                    scanner->column - TVALUE_LENGTH(scanner), TVALUE_START(scanner),
+                    TVALUE_LENGTH(scanner), scanner->user_data);
+            if (result == CIF_OK) {
+                /* recover by dropping it */
+                CONSUME_TOKEN(scanner);
+            }
+            break;
+        case END:
+            if (reader->frame_depth > 0) {
+                /* error: unterminated save frame at EOF */
+                result = scanner->error_callback(CIF_EOF_IN_FRAME, scanner->line, scanner->column,
+                        TVALUE_START(scanner), 0, scanner->user_data);
+                /* recover by closing the frame */
+                if (result == CIF_OK) {
+                    reader->frame_depth -= 1;
+                    event->kind = CIF_FRAME_END_EVENT;
+                    *have_event = CIF_TRUE;
+                }
+            } else {
+                /* the token is not consumed; there is nothing more to read */
+                reader->finished = CIF_TRUE;
+            }
+            break;
+        default:
+            /* should not happen */
+            result = CIF_INTERNAL_ERROR;
+            break;
+    }
+
+    return result;
+}
+
+/*
+ * Handles the scanner's current token, which is in the body of the current loop, on behalf of a pull reader.  Sets
+ * the flag pointed to by have_event if the token completes an event for the caller.  A token that ends the loop body
+ * is not consumed, but the loop itself is ended (after any missing values of a partial packet are reported).
+ */
+static int read_loop_token(struct cif_reader_s *reader, cif_event_tp *event, int *have_event) {
+    struct scanner_s *scanner = &reader->scanner;
+    enum token_type alt_ttype = QVALUE;
+    int result = CIF_OK;
+
+    switch (scanner->ttype) {
+        case TKEY:
+            alt_ttype = TVALUE;
+            /* fall through */
+        case KEY:
+            if ((result = split_key_token(scanner, alt_ttype)) != CIF_OK) {
+                break;
+            }
+            /* fall through */
+        case OLIST:  /* opening delimiter of a list value */
+        case OTABLE: /* opening delimiter of a table value */
+        case TVALUE:
+        case QVALUE:
+        case VALUE:
+            if (!reader->packet_open) {
+                /* first value of a new packet; report the packet without yet consuming the value */
+                reader->packet_open = CIF_TRUE;
+                event->kind = CIF_PACKET_EVENT;
+                *have_event = CIF_TRUE;
+            } else if ((result = read_item_value(reader, event)) == CIF_OK) {
+                event->kind = CIF_ITEM_EVENT;
+                event->name = reader->loop_names[reader->column_index];
+                *have_event = CIF_TRUE;
+                next_loop_column(reader);
+            }
+            break;
+        case CLIST:
+        case CTABLE:
+            /* error: unexpected list/table delimiter */
+            result = scanner->error_callback(CIF_UNEXPECTED_DELIM, scanner->line,
+                    scanner->column - TVALUE_LENGTH(scanner), TVALUE_START(scanner),
+                    TVALUE_LENGTH(scanner), scanner->user_data);
+            if (result == CIF_OK) {
+                /* recover by dropping it; the loop body is not terminated */
+                CONSUME_TOKEN(scanner);
+            }
+            break;
+        default: /* any other token type terminates the loop body; it is not consumed */
+            if (reader->column_index != 0) {
+                if (!reader->partial_packet) {
+                    /* error: partial packet */
+                    result = scanner->error_callback(CIF_PARTIAL_PACKET, scanner->line,
+                            scanner->column - TVALUE_LENGTH(scanner), TVALUE_START(scanner), 0,
+                            scanner->user_data);
+                    if (result != CIF_OK) {
+                        break;
+                    }
+                    reader->partial_packet = CIF_TRUE;
+                }
+                /* recover by reporting synthetic unknown values to fill the packet, one per call */
+                event->kind = CIF_ITEM_EVENT;
+                event->name = reader->loop_names[reader->column_index];
+                *have_event = CIF_TRUE;
+                next_loop_column(reader);
+            } else {
+                if (!reader->have_packets) {
+                    /* error: no packets */
+                    result = scanner->error_callback(CIF_EMPTY_LOOP, scanner->line,
+                            scanner->column - TVALUE_LENGTH(scanner), TVALUE_START(scanner),
+                            TVALUE_LENGTH(scanner), scanner->user_data);
+                    if (result != CIF_OK) {
+                        break;
+                    }
+                    /* recover by ignoring the problem */
+                }
+                end_reader_loop(reader);
+                event->kind = CIF_LOOP_END_EVENT;
+                *have_event = CIF_TRUE;
+            }
+            break;
+    }
+
+    return result;
+}
+
+/*
+ * Reads the value that is or starts with the scanner's current token into the specified event, consuming the token
+ * (and, for a list or table, those of its elements).  Text of quoted and unquoted strings is borrowed directly from
+ * the scanner's buffer; text fields are decoded into, and lists and tables are parsed into, the reader's own value
+ * object.
+ */
+static int read_item_value(struct cif_reader_s *reader, cif_event_tp *event) {
+    struct scanner_s *scanner = &reader->scanner;
+    UChar *token_value = TVALUE_START(scanner);
+    int32_t token_length = TVALUE_LENGTH(scanner);
+    int result = CIF_OK;
+
+    switch (scanner->ttype) {
+        case OLIST: /* opening delimiter of a list value */
+            CONSUME_TOKEN(scanner);
+            if ((result = parse_list(scanner, &reader->value)) == CIF_OK) {
+                event->value_kind = CIF_LIST_KIND;
+                event->value = reader->value;
+            }
+            break;
+        case OTABLE: /* opening delimiter of a table value */
+            CONSUME_TOKEN(scanner);
+            if ((result = parse_table(scanner, &reader->value)) == CIF_OK) {
+                event->value_kind = CIF_TABLE_KIND;
+                event->value = reader->value;
+            }
+            break;
+        case TVALUE:
+            /* parse text block contents into the reader's value */
+            result = decode_text(scanner, token_value, token_length, &reader->value);
+            CONSUME_TOKEN(scanner);  /* consume the token _after_ parsing its value */
+            if (result == CIF_OK) {
+                event->text = reader->value->as_char.text;
+                event->text_length = u_strlen(event->text);
+                event->value_kind = CIF_CHAR_KIND;
+                event->quoted = CIF_QUOTED;
+            }
+            break;
+        case QVALUE:
+            /* the closing delimiter is not included in the token length */
+            event->text = token_value;
+            event->text_length = token_length;
+            event->value_kind = CIF_CHAR_KIND;
+            event->quoted = CIF_QUOTED;
+            CONSUME_TOKEN(scanner);
+            break;
+        case VALUE:
+            event->text = token_value;
+            event->text_length = token_length;
+            event->quoted = CIF_NOT_QUOTED;
+            /* special cases for unquoted question mark (?) and period (.) */
+            if ((token_length == 1) && (*token_value == UCHAR_QUERY)) {
+                event->value_kind = CIF_UNK_KIND;
+            } else if ((token_length == 1) && (*token_value == UCHAR_DECIMAL)) {
+                event->value_kind = CIF_NA_KIND;
+            } else {
+                event->value_kind = CIF_CHAR_KIND;
+            }
+            CONSUME_TOKEN(scanner);
+            break;
+        default:
+            /* This function should be called only when the incoming token is or starts a value */
+            result = CIF_INTERNAL_ERROR;
+            break;
+    }
+
+    return result;
+}
+
+/*
+ * Recovers from a table key token scanned where no table key is expected, by reporting missing whitespace before its
+ * colon, pushing back the colon, and reclassifying the token as the specified type (TVALUE or QVALUE).
+ */
+static int split_key_token(struct scanner_s *scanner, enum token_type ttype) {
+    /* error: missing whitespace (between a quoted value and a subsequent colon) */
+    int result = scanner->error_callback(CIF_MISSING_SPACE, scanner->line, scanner->column - 1,
+            scanner->next_char - 1, 0, scanner->user_data);
+
+    if (result == CIF_OK) {
+        /* recover by pushing back the colon */
+        scanner->next_char -= 1;
+        scanner->ttype = ttype;
+
+        /* notify the configured whitespace callback, if any, of zero-length whitespace */
+        OPTIONAL_VOIDCALL(scanner->whitespace_callback, (scanner->line, scanner->column,
+                scanner->next_char - 1, 0, scanner->user_data));
+    }
+
+    return result;
+}
+
+/*
+ * Records a copy of the specified block code, frame code, or data name as a pull reader's current name.
+ */
+static int set_reader_name(struct cif_reader_s *reader, const UChar *name, int32_t length) {
+    if ((size_t) length >= reader->name_capacity) {
+        UChar *new_name = (UChar *) realloc(reader->name, (length + 1) * sizeof(UChar));
+
+        if (new_name == NULL) {
+            return CIF_MEMORY_ERROR;
+        }
+        reader->name = new_name;
+        reader->name_capacity = length + 1;
+    }
+
+    u_strncpy(reader->name, name, length);
+    reader->name[length] = 0;
+
+    return CIF_OK;
+}
+
+/*
+ * Appends a copy of the specified data name to the header of the loop a pull reader is reading, keeping the name
+ * array NULL-terminated.
+ */
+static int add_loop_name(struct cif_reader_s *reader, const UChar *name, int32_t length) {
+    UChar *copy;
+
+    if ((size_t) reader->column_count + 1 >= reader->loop_capacity) {
+        size_t new_capacity = ((reader->loop_capacity == 0) ? 8 : (2 * reader->loop_capacity));
+        UChar **new_names = (UChar **) realloc(reader->loop_names, new_capacity * sizeof(UChar *));
+
+        if (new_names == NULL) {
+            return CIF_MEMORY_ERROR;
+        }
+        reader->loop_names = new_names;
+        reader->loop_capacity = new_capacity;
+    }
+
+    copy = (UChar *) malloc((length + 1) * sizeof(UChar));
+    if (copy == NULL) {
+        return CIF_MEMORY_ERROR;
+    }
+    u_strncpy(copy, name, length);
+    copy[length] = 0;
+
+    reader->loop_names[reader->column_count++] = copy;
+    reader->loop_names[reader->column_count] = NULL;
+
+    return CIF_OK;
+}
+
+/*
+ * Advances a pull reader to the next column of the current loop, closing the current packet after its last value.
+ */
+static void next_loop_column(struct cif_reader_s *reader) {
+    reader->column_index = (reader->column_index + 1) % reader->column_count;
+    if (reader->column_index == 0) {
+        /* that was the last value in the packet */
+        reader->packet_open = CIF_FALSE;
+        reader->have_packets = CIF_TRUE;
+        reader->partial_packet = CIF_FALSE;
+    }
+}
+
+/*
+ * Releases a pull reader's record of the current loop, if any, so that subsequent tokens are read in container
+ * context.
+ */
+static void end_reader_loop(struct cif_reader_s *reader) {
+    if (reader->loop_names != NULL) {
+        int index;
+
+        for (index = 0; index < reader->column_count; index += 1) {
+            free(reader->loop_names[index]);
+        }
+        free(reader->loop_names);
+        reader->loop_names = NULL;
+    }
+    reader->loop_capacity = 0;
+    reader->column_count = 0;
+    reader->column_index = 0;
+    reader->packet_open = CIF_FALSE;
+}
+
+/*
+ * Initializes the specified scanner, whose buffer must already be allocated, and reads the first characters from its
+ * source.  Consumes an initial byte-order mark, if any, and determines the CIF version, from the CIF magic code where
+ * it has not already been settled, adjusting the scanner for CIF 1 if appropriate.  The scanner is left positioned at
+ * the beginning of the input after the BOM.
+ *
+ * Returns CIF_OK if the scanner is ready to scan tokens, CIF_EOF if there are no characters other than a BOM, or an
+ * error code.
+ */
+static int start_scan(struct scanner_s *scanner, int not_utf8, const char *extra_ws, const char *extra_eol) {
+    int scanned_bom;
+    int result;
+    UChar c;
+
+    INIT_V2_SCANNER(scanner, extra_ws, extra_eol);
+    scanner->next_char = scanner->buffer;
+    scanner->text_start = scanner->buffer;
+    scanner->tvalue_start = scanner->buffer;
+    scanner->tvalue_length = 0;
+
+    /*
+     * We must avoid get_more_chars() here (and also NEXT_CHAR, which uses it) because we want -- here only -- to
+     * accept a byte-order mark.
+     */
+    if ((result = get_first_char(scanner)) != CIF_OK) {
+        /* CIF_EOF for an empty CIF, or else an error */
+        return result;
+    }
+
+    c = *(scanner->next_char++);
+
+    /* consume an initial BOM, if present, regardless of the actual source encoding */
+    /* NOTE: assumes that the character decoder, if any, does not also consume an initial BOM */
+    if ((scanned_bom = (c == UCHAR_BOM))) {
+        CONSUME_TOKEN(scanner);
+        NEXT_CHAR(scanner, c, result);
+        if (result != CIF_OK) {
+            /* CIF_EOF for a BOM-only CIF, or else an error */
+            return result;
+        }
+    }
+
+    /* If the CIF version is uncertain then use the CIF magic code, if any, to choose */
+    if (scanner->cif_version <= 0) {
+        scanner->cif_version = (scanner->cif_version < 0) ? -scanner->cif_version : 1;
+        if (CLASS_OF(c, scanner) == HASH_CLASS) {
+            if ((result = scan_to_ws(scanner)) != CIF_OK) {
+                return result;
+            }
+            if (TVALUE_LENGTH(scanner) == MAGIC_LENGTH) {
+                if (u_strncmp(TVALUE_START(scanner), CIF2_MAGIC, MAGIC_LENGTH) == 0) {
+                    scanner->cif_version = 2;
+                } else if (u_strncmp(TVALUE_START(scanner), CIF1_MAGIC, MAGIC_LENGTH - 3) == 0) {
+                    /* recognize magic codes for all CIF versions other than 2.0 as CIF 1 */
+                    scanner->cif_version = 1;
+                }
+            }
+        }
+    }
+
+    /* reset the scanner */
+    scanner->next_char = scanner->text_start;
+    scanner->column = 0;
+
+    if (scanner->cif_version == 1) {
+        if (scanned_bom) {
+            /* error: disallowed CIF 1 character */
+            result = scanner->error_callback(CIF_DISALLOWED_CHAR, 1, 0, scanner->next_char - 1, 1,
+                    scanner->user_data);
+            /* recover, if necessary, by ignoring the problem */
+        }
+        SET_V1(scanner);
+    } else if ((scanner->cif_version == 2) && (not_utf8 != 0)) {
+        /* error: CIF2 but not UTF-8 */
+        result = scanner->error_callback(CIF_WRONG_ENCODING, 1, 1, scanner->next_char, 0, scanner->user_data);
+        /* recover, if necessary, by ignoring the problem */
+    }
+
+    return result;
+}
+
 /*
  * Decodes the contents of a text block by un-prefixing and unfolding lines as appropriate, and standardizing line
  * terminators to a single newline character.  Records the result in a CIF value object.
@@ -2641,8 +3277,20 @@ static int scan_ws(struct scanner_s *scanner) {
         int result;
 
         for (; scanner->next_char < top; scanner->next_char += 1) {
-            UChar c = *(scanner->next_char);
+            UChar *nonblank = find_nonblank_char(scanner->next_char, top);
+            UChar c;
+
+            if (nonblank != scanner->next_char) {
+                /* pass over a run of spaces and tabs in one step */
+                POSN_INCCOLUMN(scanner, nonblank - scanner->next_char);
+                sol = 0;
+                scanner->next_char = nonblank;
+                if (nonblank >= top) {
+                    break;
+                }
+            }
 
+            c = *(scanner->next_char);
             switch (CLASS_OF(c, scanner)) {
                 case WS_CLASS:
                     /* increment the column number; c is assumed to not be a surrogate code value */
@@ -2742,6 +3390,7 @@ static int scan_to_eol(struct scanner_s *scanner) {
 }
 
 static int scan_unquoted(struct scanner_s *scanner) {
+    const UChar *stops = ((scanner->cif_version >= 2) ? BRACKET_STOPS : NO_STOPS);
     int lead_surrogate = CIF_FALSE;
 
     for (;;) {
@@ -2751,6 +3400,10 @@ static int scan_unquoted(struct scanner_s *scanner) {
         while (scanner->next_char < top) {
             UChar c;
 
+            if (!lead_surrogate && (skip_plain_chars(scanner, stops) != 0) && (scanner->next_char >= top)) {
+                break;
+            }
+
             /* Scan and validate the next code unit, incrementing the column number as appropriate */
             SCAN_UCHAR(scanner, c, lead_surrogate, result);
             if (result != CIF_OK) {
@@ -2804,16 +3457,24 @@ static int scan_unquoted(struct scanner_s *scanner) {
  */
 static int scan_delim_string(struct scanner_s *scanner) {
     UChar delim = *(scanner->text_start);
+    UChar stops[STOP_COUNT];
     int lead_surrogate = CIF_FALSE;
     int delim_size;
     int result;
 
+    stops[0] = delim;
+    stops[1] = stops[2] = stops[3] = 0;
+
     for (;;) {
         UChar *top = scanner->buffer + scanner->buffer_limit;
 
         while (scanner->next_char < top) {
             UChar c;
 
+            if (!lead_surrogate && (skip_plain_chars(scanner, stops) != 0) && (scanner->next_char >= top)) {
+                break;
+            }
+
             /* Scan and validate the next code unit, incrementing the column number as appropriate */
             SCAN_UCHAR(scanner, c, lead_surrogate, result);
             if (result != CIF_OK) {
@@ -2887,18 +3548,30 @@ static int scan_delim_string(struct scanner_s *scanner) {
  */
 static int scan_triple_delim_string(struct scanner_s *scanner) {
     UChar delim = *(scanner->text_start);
+    UChar stops[STOP_COUNT];
     int delim_count = 0;
     int lead_surrogate = CIF_FALSE;
     int delim_size;
     int result;
     int sol = 0;
 
+    stops[0] = delim;
+    stops[1] = stops[2] = stops[3] = 0;
+
     for (;;) {
         UChar *top = scanner->buffer + scanner->buffer_limit;
 
         while (scanner->next_char < top) {
             UChar c;
 
+            if (!lead_surrogate && (skip_plain_chars(scanner, stops) != 0)) {
+                delim_count = 0;
+                sol = 0;
+                if (scanner->next_char >= top) {
+                    break;
+                }
+            }
+
             /* Scan and validate the next code unit, incrementing the column number as appropriate */
             SCAN_UCHAR(scanner, c, lead_surrogate, result);
             if (result != CIF_OK) {
@@ -2964,6 +3637,13 @@ static int scan_text(struct scanner_s *scanner) {
         while (scanner->next_char < top) {
             UChar c;
 
+            if (!lead_surrogate && (skip_plain_chars(scanner, SEMI_STOPS) != 0)) {
+                sol = 0;
+                if (scanner->next_char >= top) {
+                    break;
+                }
+            }
+
             /* Scan and validate the next code unit, incrementing the column number as appropriate */
             SCAN_UCHAR(scanner, c, lead_surrogate, result);
             if (result != CIF_OK) {
@@ -3021,6 +3701,114 @@ static int scan_text(struct scanner_s *scanner) {
     return CIF_OK;
 }
 
+/*
+ * Returns a pointer to the first code unit in the range [start, end) that either is not a plain character or is equal
+ * to one of the STOP_COUNT characters in the 'stops' array, or 'end' if there is no such code unit.
+ */
+static UChar *find_special_char(UChar *start, UChar *end, const UChar stops[]) {
+#ifdef SCAN_SSE2
+    if (end - start >= SCAN_STRIDE) {
+        UChar *last = end - SCAN_STRIDE;
+        __m128i min_plain;
+        __m128i max_plain;
+        __m128i zero;
+        __m128i stop0;
+        __m128i stop1;
+        __m128i stop2;
+        __m128i stop3;
+
+        min_plain = _mm_set1_epi16(MIN_PLAIN_CHAR);
+        max_plain = _mm_set1_epi16(MAX_PLAIN_CHAR);
+        zero = _mm_setzero_si128();
+        stop0 = _mm_set1_epi16((short) stops[0]);
+        stop1 = _mm_set1_epi16((short) stops[1]);
+        stop2 = _mm_set1_epi16((short) stops[2]);
+        stop3 = _mm_set1_epi16((short) stops[3]);
+
+        for (; start <= last; start += SCAN_STRIDE) {
+            __m128i units = _mm_loadu_si128((const __m128i *) start);
+            /* the unsigned saturating differences are both zero exactly for the plain characters */
+            __m128i plain = _mm_cmpeq_epi16(_mm_or_si128(_mm_subs_epu16(min_plain, units),
+                    _mm_subs_epu16(units, max_plain)), zero);
+            __m128i stopped = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(units, stop0), _mm_cmpeq_epi16(units, stop1)),
+                    _mm_or_si128(_mm_cmpeq_epi16(units, stop2), _mm_cmpeq_epi16(units, stop3)));
+
+            if (_mm_movemask_epi8(_mm_andnot_si128(stopped, plain)) != 0xffff) {
+                /* the special character is among these; the scalar loop below will locate it */
+                break;
+            }
+        }
+    }
+#endif
+
+    for (; start < end; start += 1) {
+        UChar c = *start;
+
+        if (!IS_PLAIN_CHAR(c) || (c == stops[0]) || (c == stops[1]) || (c == stops[2]) || (c == stops[3])) {
+            break;
+        }
+    }
+
+    return start;
+}
+
+/*
+ * Returns a pointer to the first code unit in the range [start, end) that is neither a space nor a tab, or 'end' if
+ * there is no such code unit.
+ */
+static UChar *find_nonblank_char(UChar *start, UChar *end) {
+#ifdef SCAN_SSE2
+    if (end - start >= SCAN_STRIDE) {
+        UChar *last = end - SCAN_STRIDE;
+        __m128i space;
+        __m128i tab;
+
+        space = _mm_set1_epi16(UCHAR_SP);
+        tab = _mm_set1_epi16(UCHAR_TAB);
+
+        for (; start <= last; start += SCAN_STRIDE) {
+            __m128i units = _mm_loadu_si128((const __m128i *) start);
+
+            if (_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi16(units, space), _mm_cmpeq_epi16(units, tab)))
+                    != 0xffff) {
+                /* the non-blank character is among these; the scalar loop below will locate it */
+                break;
+            }
+        }
+    }
+#endif
+
+    for (; start < end; start += 1) {
+        if ((*start != UCHAR_SP) && (*start != UCHAR_TAB)) {
+            break;
+        }
+    }
+
+    return start;
+}
+
+/*
+ * Advances the specified scanner past the run of plain characters, other than those in the 'stops' array, beginning
+ * at its current position in its buffer, and performs the corresponding column accounting.  Does not consider any
+ * characters if the scanner's configuration makes some plain characters whitespace or end-of-line characters.  Must
+ * not be used when the scanner's previous code unit is a lead surrogate, as that would go unreported.  Returns the
+ * number of characters skipped.
+ */
+static size_t skip_plain_chars(struct scanner_s *scanner, const UChar stops[]) {
+    UChar *start = scanner->next_char;
+    size_t count;
+
+    if (!scanner->printables_plain) {
+        return 0;
+    }
+
+    scanner->next_char = find_special_char(start, scanner->buffer + scanner->buffer_limit, stops);
+    count = scanner->next_char - start;
+    POSN_INCCOLUMN(scanner, count);
+
+    return count;
+}
+
 /*
  * Transfers one or possibly two characters from the provided scanner's character source into its working character
  * buffer, provided that any are available.  Assumes that no characters have yet been transferred, and that the CIF
@@ -76,10 +76,12 @@ int cif_pktitr_close(
     int result = CIF_OK;
     cif_tp *cif = iterator->loop->container->cif;
 
-    if (COMMIT(cif->db) != SQLITE_OK) {
+    if ((iterator->top_tx ? COMMIT(cif->db) : RELEASE(cif->db)) != SQLITE_OK) {
         result = CIF_ERROR;
-        (void) ROLLBACK(cif->db);
+        (void) (iterator->top_tx ? ROLLBACK(cif->db) : ROLLBACK_TO(cif->db));
+        cif->loop_item_generation += 1;
     }
+    cif->open_iterators -= 1;
 
     cif_pktitr_free(iterator);
 
@@ -94,9 +96,11 @@ int cif_pktitr_abort(
     int result = CIF_OK;
     cif_tp *cif = iterator->loop->container->cif;
 
-    if (ROLLBACK(cif->db) != SQLITE_OK) {
+    if ((iterator->top_tx ? ROLLBACK(cif->db) : ROLLBACK_TO(cif->db)) != SQLITE_OK) {
         result = CIF_ERROR;
     }
+    cif->loop_item_generation += 1;
+    cif->open_iterators -= 1;
 
     cif_pktitr_free(iterator);
 
@@ -118,6 +122,9 @@ void cif_pktitr_free(
         free(iterator->item_names);
     }
 
+    free(iterator->item_ids);
+    free(iterator->entries);
+
     HASH_ITER(hh, iterator->name_set, element, temp) {
         HASH_DEL(iterator->name_set, element);
         free(element);
@@ -157,23 +164,35 @@ int cif_pktitr_next_packet(
         if ((result = cif_packet_create_norm(&temp_packet, iterator->item_names, CIF_TRUE)) != CIF_OK) {
             SET_RESULT(result);
         } else {
+            struct entry_s *entry;
+            int item_index;
+
+            /* index the packet's entries by their items' positions in the ID list */
+            /* iteration via hh.next is documented to proceed in insertion order */
+            for (item_index = 0, entry = temp_packet->map.head;
+                    entry != NULL;
+                    item_index += 1, entry = (struct entry_s *) entry->hh.next) {
+                iterator->entries[item_index] = entry;
+            }
+
             /* populate the packet with values read from the DB */
+            item_index = 0;
             while (CIF_TRUE) {
-                const UChar *name;
-                struct entry_s *entry;
+                int name_id;
                 int next_row;
     
-                /* For which item is this value? */
-    
-                /* will be freed automatically by SQLite: */
-                name = (const UChar *) sqlite3_column_text16(stmt, 1);
-    
-                if (!name) {
-                    DEFAULT_FAIL(soft);
+                /* For which item is this value?  Values come in the same item order as the iterator's item IDs. */
+                name_id = sqlite3_column_int(stmt, 1);
+                while (iterator->item_names[item_index] && (iterator->item_ids[item_index] != name_id)) {
+                    item_index += 1;
+                }
+                if (!iterator->item_names[item_index] || (iterator->item_ids[item_index] != name_id)) {
+                    /* The value does not belong to any of the loop's items as of the start of iteration */
+                    FAIL(soft, CIF_INTERNAL_ERROR);
                 }
 
-                HASH_FIND(hh, temp_packet->map.head, name, U_BYTES(name), entry);
-                if ((entry == NULL) || entry->as_value.kind != CIF_UNK_KIND) {
+                entry = iterator->entries[item_index];
+                if (entry->as_value.kind != CIF_UNK_KIND) {
                     /* The item was expected to have a dummy value pre-recorded in the packet */
                     FAIL(soft, CIF_INTERNAL_ERROR);
                 }
@@ -187,6 +206,7 @@ int cif_pktitr_next_packet(
                         next_row = sqlite3_column_int(stmt, 0);
                         if (next_row == current_row) {
                             /* there is another value for this packet; loop back to handle it */
+                            item_index += 1;
                             continue;
                         } /* else that was the last value for the packet, but there is another packet after it */
                         SET_RESULT(CIF_OK);
@@ -281,13 +301,119 @@ int cif_pktitr_next_packet(
     }
 }
 
-#define SET_ID_PROPS(stmt, ofs, container_id, item_name, row_num, onerr) do { \
+int cif_pktitr_next_row(
+        cif_pktitr_tp *iterator,
+        cif_value_tp **row
+        ) {
+    if (iterator->finished != 0) {
+        return CIF_FINISHED;
+    } else if (row == NULL) {
+        return CIF_ARGUMENT_ERROR;
+    } else {
+        FAILURE_HANDLING;
+        sqlite3_stmt *stmt = iterator->stmt;
+        int current_row = sqlite3_column_int(stmt, 0);
+        int item_index;
+
+        assert (iterator->item_names != NULL);
+
+        if (sqlite3_get_autocommit(iterator->loop->container->cif->db) != 0) {
+            /* no transaction is active -- the provided iterator is stale */
+            return CIF_INVALID_HANDLE;
+        }
+
+        /* provide a value object in every slot, resetting those carried over from the previous row to unknown */
+        for (item_index = 0; iterator->item_names[item_index] != NULL; item_index += 1) {
+            if (row[item_index] == NULL) {
+                if (cif_value_create(CIF_UNK_KIND, row + item_index) != CIF_OK) {
+                    FAIL(soft, CIF_MEMORY_ERROR);
+                }
+            } else {
+                cif_value_clean(row[item_index]);
+            }
+        }
+
+        /* populate the row with values read from the DB */
+        item_index = 0;
+        while (CIF_TRUE) {
+            int name_id;
+
+            /*
+             * The column ordinal is resolved from the value's name ID alone.  Values come in the same item order as
+             * the iterator's item IDs, which is also the order of the iterator's item names.
+             */
+            name_id = sqlite3_column_int(stmt, 1);
+            while (iterator->item_names[item_index] && (iterator->item_ids[item_index] != name_id)) {
+                item_index += 1;
+            }
+            if (!iterator->item_names[item_index] || (iterator->item_ids[item_index] != name_id)) {
+                /* The value does not belong to any of the loop's items as of the start of iteration */
+                FAIL(soft, CIF_INTERNAL_ERROR);
+            }
+
+            /* set value properties from the DB */
+            GET_VALUE_PROPS(stmt, 2, row[item_index], soft);
+
+            /* check whether there are any more values for the current packet */
+            switch (sqlite3_step(stmt)) {
+                case SQLITE_ROW:
+                    if (sqlite3_column_int(stmt, 0) == current_row) {
+                        /* there is another value for this packet; loop back to handle it */
+                        item_index += 1;
+                        continue;
+                    } /* else that was the last value for the packet, but there is another packet after it */
+                    break;
+                case SQLITE_DONE:
+                    /* that was the last value for the last packet */
+                    iterator->finished = 1;
+                    break;
+                default:
+                    DEFAULT_FAIL(soft);
+            }
+
+            /* the current packet has been fully read from the DB */
+            iterator->previous_row_num = current_row;
+
+            return CIF_OK;
+        }
+
+        FAILURE_HANDLER(soft):
+        FAILURE_TERMINUS;
+    }
+}
+
+#define SET_ID_PROPS(stmt, ofs, container_id, name_id, row_num, onerr) do { \
     sqlite3_stmt *s = (stmt); \
     if ((sqlite3_bind_int64(s, ofs + 1, (container_id)) != SQLITE_OK) \
-            || (sqlite3_bind_text16(s, ofs + 2, (item_name), -1, SQLITE_STATIC) != SQLITE_OK) \
+            || (sqlite3_bind_int(s, ofs + 2, (name_id)) != SQLITE_OK) \
             || (sqlite3_bind_int(s, ofs + 3, (row_num)) != SQLITE_OK)) DEFAULT_FAIL(onerr); \
 } while (0)
 
+int cif_pktitr_get_names(
+        cif_pktitr_tp *iterator,
+        const UChar ***names
+        ) {
+    const UChar **temp;
+    size_t name_count;
+
+    if (names == NULL) {
+        return CIF_ARGUMENT_ERROR;
+    }
+
+    assert (iterator->item_names != NULL);
+
+    /* the iterator's names are already in row order; the caller gets a new array of pointers to them */
+    for (name_count = 0; iterator->item_names[name_count] != NULL; name_count += 1) ;
+    temp = (const UChar **) malloc((name_count + 1) * sizeof(const UChar *));
+    if (temp == NULL) {
+        return CIF_MEMORY_ERROR;
+    }
+    memcpy(temp, iterator->item_names, (name_count + 1) * sizeof(const UChar *));
+
+    *names = temp;
+    return CIF_OK;
+}
+
 int cif_pktitr_update_packet(
         cif_pktitr_tp *iterator,
         cif_packet_tp *packet
@@ -297,6 +423,9 @@ int cif_pktitr_update_packet(
     if (sqlite3_get_autocommit(iterator->loop->container->cif->db) != 0) {
         /* no transaction is active -- the provided iterator is stale */
         SET_RESULT(CIF_INVALID_HANDLE);
+    } else if (iterator->right_loop != NULL) {
+        /* a joined packet does not correspond to any one stored packet */
+        SET_RESULT(CIF_NOT_SUPPORTED);
     } else if (iterator->previous_row_num <= 0) {
         /* no packet has yet been returned, or the last returned has been removed */
         SET_RESULT(CIF_MISUSE);
@@ -320,9 +449,16 @@ int cif_pktitr_update_packet(
                 HASH_FIND(hh, iterator->name_set, scalar->key, U_BYTES(scalar->key), element);
                 if (element) { /* an item for the iterator's subject loop */
                     STEP_HANDLING;
+                    int name_id;
 
-                    SET_ID_PROPS(cif->update_value_stmt, 0, container->id, scalar->key,
+                    if (cif_get_name_id(cif, scalar->key, &name_id) != CIF_OK) {
+                        DEFAULT_FAIL(hard);
+                    }
+                    SET_ID_PROPS(cif->update_value_stmt, 0, container->id, name_id,
                             iterator->previous_row_num, hard);
+                    if (sqlite3_bind_int(cif->update_value_stmt, 11, iterator->loop->loop_num) != SQLITE_OK) {
+                        DEFAULT_FAIL(hard);
+                    }
                     SET_VALUE_PROPS(cif->update_value_stmt, 3, &(scalar->as_value), hard, soft);
 
                     if ((STEP_STMT(cif, update_value) == SQLITE_DONE)
@@ -370,6 +506,9 @@ int cif_pktitr_remove_packet(
     if (sqlite3_get_autocommit(iterator->loop->container->cif->db)) {
         /* no transaction is active -- the provided iterator is stale */
         SET_RESULT(CIF_INVALID_HANDLE);
+    } else if (iterator->right_loop != NULL) {
+        /* a joined packet does not correspond to any one stored packet */
+        SET_RESULT(CIF_NOT_SUPPORTED);
     } else if (iterator->previous_row_num <= 0) {
         /* no packet has yet been returned, or the last returned has already been removed */
         SET_RESULT(CIF_MISUSE);
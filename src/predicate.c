@@ -0,0 +1,278 @@
+/*
+ * predicate.c
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Note: predicates are applied to loops by cif_loop_select(), in loop.c
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "internal/compat.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unicode/ustring.h>
+#include "cif.h"
+#include "internal/ciftypes.h"
+#include "internal/utils.h"
+#include "internal/sql.h"
+
+/* The SQL comparison operators corresponding to the cif_compare_tp codes, in code order */
+static const char *COMPARISON_OPERATORS[] = { "=", "<>", "<", "<=", ">", ">=" };
+
+/* The number of characters needed to format any int in decimal, including a sign */
+#define INT_CHARS (3 * sizeof(int) + 1)
+
+static int create_leaf(cif_predicate_tp **predicate, const UChar *item_name, cif_compare_tp comparison,
+        cif_kind_tp kind);
+static int create_node(cif_predicate_tp **predicate, int op, cif_predicate_tp *left, cif_predicate_tp *right);
+static int predicate_to_sql(const cif_predicate_tp *predicate, const int *item_ids, UChar **item_names,
+        int *next_param, char **sql);
+static int predicate_bind(const cif_predicate_tp *predicate, sqlite3_stmt *stmt, int *next_param);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int cif_predicate_create_numb(
+        cif_predicate_tp **predicate,
+        const UChar *item_name,
+        cif_compare_tp comparison,
+        double value
+        ) {
+    int result = create_leaf(predicate, item_name, comparison, CIF_NUMB_KIND);
+
+    if (result == CIF_OK) {
+        (*predicate)->number = value;
+    }
+
+    return result;
+}
+
+int cif_predicate_create_char(
+        cif_predicate_tp **predicate,
+        const UChar *item_name,
+        cif_compare_tp comparison,
+        const UChar *text
+        ) {
+    if (text == NULL) {
+        return CIF_ARGUMENT_ERROR;
+    } else {
+        UChar *text_copy = cif_u_strdup(text);
+
+        if (text_copy == NULL) {
+            return CIF_MEMORY_ERROR;
+        } else {
+            int result = create_leaf(predicate, item_name, comparison, CIF_CHAR_KIND);
+
+            if (result == CIF_OK) {
+                (*predicate)->text = text_copy;
+            } else {
+                free(text_copy);
+            }
+
+            return result;
+        }
+    }
+}
+
+int cif_predicate_create_and(
+        cif_predicate_tp **predicate,
+        cif_predicate_tp *left,
+        cif_predicate_tp *right
+        ) {
+    return create_node(predicate, PREDICATE_AND, left, right);
+}
+
+int cif_predicate_create_or(
+        cif_predicate_tp **predicate,
+        cif_predicate_tp *left,
+        cif_predicate_tp *right
+        ) {
+    return create_node(predicate, PREDICATE_OR, left, right);
+}
+
+void cif_predicate_free(
+        cif_predicate_tp *predicate
+        ) {
+    if (predicate != NULL) {
+        cif_predicate_free(predicate->left);
+        cif_predicate_free(predicate->right);
+        free(predicate->name);
+        free(predicate->text);
+        free(predicate);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+int cif_predicate_to_sql(
+        const cif_predicate_tp *predicate,
+        const int *item_ids,
+        UChar **item_names,
+        char **sql
+        ) {
+    int next_param = 3;
+
+    return predicate_to_sql(predicate, item_ids, item_names, &next_param, sql);
+}
+
+int cif_predicate_bind(
+        const cif_predicate_tp *predicate,
+        sqlite3_stmt *stmt
+        ) {
+    int next_param = 3;
+
+    return predicate_bind(predicate, stmt, &next_param);
+}
+
+/*
+ * Creates a comparison predicate without a constant, which the caller is expected to record
+ */
+static int create_leaf(cif_predicate_tp **predicate, const UChar *item_name, cif_compare_tp comparison,
+        cif_kind_tp kind) {
+    cif_predicate_tp *temp;
+    int result;
+
+    if ((predicate == NULL) || ((int) comparison < (int) CIF_CMP_EQ) || ((int) comparison > (int) CIF_CMP_GE)) {
+        return CIF_ARGUMENT_ERROR;
+    } else if (item_name == NULL) {
+        return CIF_INVALID_ITEMNAME;
+    }
+
+    temp = (cif_predicate_tp *) calloc(1, sizeof(cif_predicate_tp));
+    if (temp == NULL) {
+        return CIF_MEMORY_ERROR;
+    }
+
+    result = cif_normalize_item_name(item_name, -1, &(temp->name), CIF_INVALID_ITEMNAME);
+    if (result != CIF_OK) {
+        free(temp);
+    } else {
+        temp->op = (int) comparison;
+        temp->kind = kind;
+        *predicate = temp;
+    }
+
+    return result;
+}
+
+/*
+ * Creates a predicate combining two others via the specified logical operation
+ */
+static int create_node(cif_predicate_tp **predicate, int op, cif_predicate_tp *left, cif_predicate_tp *right) {
+    cif_predicate_tp *temp;
+
+    if ((predicate == NULL) || (left == NULL) || (right == NULL)) {
+        return CIF_ARGUMENT_ERROR;
+    }
+
+    temp = (cif_predicate_tp *) calloc(1, sizeof(cif_predicate_tp));
+    if (temp == NULL) {
+        return CIF_MEMORY_ERROR;
+    }
+
+    temp->op = op;
+    temp->left = left;
+    temp->right = right;
+    *predicate = temp;
+
+    return CIF_OK;
+}
+
+static int predicate_to_sql(const cif_predicate_tp *predicate, const int *item_ids, UChar **item_names,
+        int *next_param, char **sql) {
+    FAILURE_HANDLING;
+    char *temp;
+
+    if ((predicate->op == PREDICATE_AND) || (predicate->op == PREDICATE_OR)) {
+        char *left_sql;
+        char *right_sql;
+        int result;
+
+        if ((result = predicate_to_sql(predicate->left, item_ids, item_names, next_param, &left_sql)) != CIF_OK) {
+            return result;
+        }
+        if ((result = predicate_to_sql(predicate->right, item_ids, item_names, next_param, &right_sql)) != CIF_OK) {
+            free(left_sql);
+            return result;
+        }
+        temp = (char *) malloc(strlen(left_sql) + strlen(right_sql) + 8);
+        if (temp == NULL) {
+            SET_RESULT(CIF_MEMORY_ERROR);
+        } else {
+            sprintf(temp, ((predicate->op == PREDICATE_AND) ? "(%s and %s)" : "(%s or %s)"), left_sql, right_sql);
+        }
+        free(right_sql);
+        free(left_sql);
+    } else {
+        int index;
+
+        for (index = 0; item_names[index] != NULL; index += 1) {
+            if (u_strcmp(predicate->name, item_names[index]) == 0) {
+                break;
+            }
+        }
+        if (item_names[index] == NULL) {
+            return CIF_WRONG_LOOP;
+        }
+
+        temp = (char *) malloc(strlen(CHAR_PREDICATE_SQL) + 2 * INT_CHARS);
+        if (temp == NULL) {
+            SET_RESULT(CIF_MEMORY_ERROR);
+        } else if (predicate->kind == CIF_NUMB_KIND) {
+            sprintf(temp, NUMB_PREDICATE_SQL, item_ids[index], COMPARISON_OPERATORS[predicate->op], *next_param);
+            *next_param += 1;
+        } else {
+            sprintf(temp, CHAR_PREDICATE_SQL, item_ids[index], COMPARISON_OPERATORS[predicate->op], *next_param);
+            *next_param += 1;
+        }
+    }
+
+    if (temp != NULL) {
+        *sql = temp;
+        return CIF_OK;
+    }
+
+    FAILURE_TERMINUS;
+}
+
+static int predicate_bind(const cif_predicate_tp *predicate, sqlite3_stmt *stmt, int *next_param) {
+    int result;
+
+    if ((predicate->op == PREDICATE_AND) || (predicate->op == PREDICATE_OR)) {
+        if ((result = predicate_bind(predicate->left, stmt, next_param)) == SQLITE_OK) {
+            result = predicate_bind(predicate->right, stmt, next_param);
+        }
+    } else if (predicate->kind == CIF_NUMB_KIND) {
+        result = sqlite3_bind_double(stmt, (*next_param)++, predicate->number);
+    } else {
+        result = sqlite3_bind_text16(stmt, (*next_param)++, predicate->text, -1, SQLITE_TRANSIENT);
+    }
+
+    return result;
+}
@@ -0,0 +1,39 @@
+#!/bin/sh
+#
+# each_storage.sh
+#
+# A test wrapper that runs the test program given by its arguments once under each managed-CIF storage backend,
+# selecting the backend via the CIF_STORAGE environment variable.  The exit status is that of the first run that
+# does not succeed, or zero if all runs succeed.
+#
+# Copyright 2014, 2015 John C. Bollinger
+#
+#
+# This file is part of the CIF API.
+#
+# The CIF API is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published
+# by the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# The CIF API is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+for storage in tempfile memory; do
+  echo "Running $1 with storage backend '$storage'..."
+  CIF_STORAGE=$storage
+  export CIF_STORAGE
+  "$@"
+  status=$?
+  if test $status -ne 0; then
+    exit $status
+  fi
+done
+
+exit 0
@@ -0,0 +1,89 @@
+/*
+ * test_create_storage.c
+ *
+ * Tests creating managed CIFs with each of the available storage backends.
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+
+#include "assert_cifs.h"
+#include "test.h"
+
+#define BUFFER_SIZE 512
+int main(void) {
+    char test_name[80] = "test_create_storage";
+    char local_file_name[] = "cif_core.dic";
+    char file_name[BUFFER_SIZE];
+    FILE * cif_file;
+    struct cif_parse_opts_s *options;
+    cif_tp *cif = NULL;
+    cif_tp *cif_mem = NULL;
+    cif_tp *cif_temp = NULL;
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    /* construct the test file name and open the file */
+    RESOLVE_DATADIR(file_name, BUFFER_SIZE - strlen(local_file_name));
+    TEST_NOT(file_name[0], 0, test_name, 1);
+    strcat(file_name, local_file_name);
+    cif_file = fopen(file_name, "rb");
+    TEST(cif_file == NULL, 0, test_name, 2);
+
+    /* unrecognized backends are rejected */
+    TEST(cif_create_with_storage(&cif_mem, -1), CIF_ARGUMENT_ERROR, test_name, 3);
+    TEST(cif_create_with_storage(&cif_mem, CIF_STORAGE_MEMORY + 1), CIF_ARGUMENT_ERROR, test_name, 4);
+    TEST(cif_create_with_storage(NULL, CIF_STORAGE_MEMORY), CIF_ARGUMENT_ERROR, test_name, 5);
+
+    /* create CIFs with each backend */
+    TEST(cif_create_with_storage(&cif, CIF_STORAGE_DEFAULT), CIF_OK, test_name, 6);
+    TEST(cif_create_with_storage(&cif_temp, CIF_STORAGE_TEMPFILE), CIF_OK, test_name, 7);
+    TEST(cif_create_with_storage(&cif_mem, CIF_STORAGE_MEMORY), CIF_OK, test_name, 8);
+
+    /* parse the same data into each, and verify that the results are the same */
+    TEST(cif_parse_options_create(&options), CIF_OK, test_name, 9);
+    options->max_frame_depth = -1;
+    TEST(cif_parse(cif_file, options, &cif), CIF_OK, test_name, 10);
+    rewind(cif_file);
+    TEST(cif_parse(cif_file, options, &cif_temp), CIF_OK, test_name, 11);
+    rewind(cif_file);
+    TEST(cif_parse(cif_file, options, &cif_mem), CIF_OK, test_name, 12);
+    TEST_NOT(assert_cifs_equal(cif, cif_temp), 0, test_name, 13);
+    TEST_NOT(assert_cifs_equal(cif, cif_mem), 0, test_name, 14);
+
+    /* a failed operation must be rolled back in the memory backend, too */
+    rewind(cif_file);
+    TEST(cif_parse(cif_file, options, &cif_mem), CIF_DUP_BLOCKCODE, test_name, 15);
+    TEST_NOT(assert_cifs_equal(cif, cif_mem), 0, test_name, 16);
+
+    free(options);
+
+    /* clean up */
+    DESTROY_CIF(test_name, cif_mem);
+    DESTROY_CIF(test_name, cif_temp);
+    DESTROY_CIF(test_name, cif);
+    fclose(cif_file);  /* ignore any failure here */
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * test_create_value_index.c
+ *
+ * Tests indexing an item's values via cif_create_value_index(), and selecting packets by the indexed values.
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+#include "test.h"
+
+#define NUM_PACKETS 10
+int main(void) {
+    char test_name[80] = "test_create_value_index";
+    cif_tp *cif = NULL;
+    cif_block_tp *block = NULL;
+    cif_loop_tp *loop;
+    cif_pktitr_tp *pktitr;
+    cif_packet_tp *packet;
+    cif_value_tp *value;
+    cif_value_tp *row[2] = { NULL, NULL };
+    cif_predicate_tp *pred1;
+    cif_predicate_tp *pred2;
+    cif_predicate_tp *pred3;
+    U_STRING_DECL(block_code, "block", 6);
+    UChar itemlabel[] = { '_', 'l', 'a', 'b', 'e', 'l', 0 };
+    UChar itemlabelu[] = { '_', 'L', 'a', 'b', 'e', 'l', 0 };
+    UChar itemxl[] = { '_', 'x', 0 };
+    UChar itemunused[] = { '_', 'u', 'n', 'u', 's', 'e', 'd', 0 };
+    UChar invalid[] = { 'x', 0 };
+    UChar *item_names[3];
+    UChar label[3] = { 'A', 0, 0 };
+    UChar *text;
+    UChar **names;
+    int x_index;
+    int packet_num;
+    double d;
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    U_STRING_INIT(block_code, "block", 6);
+
+    item_names[0] = itemlabel;
+    item_names[1] = itemxl;
+    item_names[2] = NULL;
+
+    CREATE_CIF(test_name, cif);
+
+    /* Test erroneous arguments */
+    TEST(cif_create_value_index(NULL, itemxl), CIF_INVALID_HANDLE, test_name, 1);
+    TEST(cif_create_value_index(cif, NULL), CIF_INVALID_ITEMNAME, test_name, 2);
+    TEST(cif_create_value_index(cif, invalid), CIF_INVALID_ITEMNAME, test_name, 3);
+
+    /* Items may be indexed before they are present, and indexing an item twice is harmless */
+    TEST(cif_create_value_index(cif, itemxl), CIF_OK, test_name, 4);
+    TEST(cif_create_value_index(cif, itemunused), CIF_OK, test_name, 5);
+    TEST(cif_create_value_index(cif, itemxl), CIF_OK, test_name, 6);
+
+    CREATE_BLOCK(test_name, cif, block_code, block);
+    TEST(cif_container_create_loop(block, NULL, item_names, &loop), CIF_OK, test_name, 7);
+
+    /* The labels are A0 ... A9, and _x is the packet number times 1.5 */
+    TEST(cif_packet_create(&packet, item_names), CIF_OK, test_name, 8);
+    for (packet_num = 0; packet_num < NUM_PACKETS; packet_num += 1) {
+        TEST(cif_packet_get_item(packet, itemlabel, &value), CIF_OK, test_name, 9);
+        label[1] = (UChar) ('0' + packet_num);
+        TEST(cif_value_copy_char(value, label), CIF_OK, test_name, 10);
+        TEST(cif_packet_get_item(packet, itemxl, &value), CIF_OK, test_name, 11);
+        TEST(cif_value_init_numb(value, 1.5 * packet_num, 0.0, 1, 1), CIF_OK, test_name, 12);
+        TEST(cif_loop_add_packet(loop, packet), CIF_OK, test_name, 13);
+    }
+    cif_packet_free(packet);
+
+    /* Rows present the items in the order of cif_loop_get_names() */
+    TEST(cif_loop_get_names(loop, &names), CIF_OK, test_name, 14);
+    x_index = (u_strcmp(names[0], itemxl) == 0) ? 0 : 1;
+    free(names[0]);
+    free(names[1]);
+    free(names);
+
+    /* Items may also be indexed after they are present, inside a transaction */
+    TEST(cif_begin(cif), CIF_OK, test_name, 15);
+    TEST(cif_create_value_index(cif, itemlabelu), CIF_OK, test_name, 16);
+    TEST(cif_commit(cif), CIF_OK, test_name, 17);
+
+    /* A range selection on the indexed numbers: 3 <= _x < 6 selects packets 2 and 3 */
+    TEST(cif_predicate_create_numb(&pred1, itemxl, CIF_CMP_GE, 3.0), CIF_OK, test_name, 18);
+    TEST(cif_predicate_create_numb(&pred2, itemxl, CIF_CMP_LT, 6.0), CIF_OK, test_name, 19);
+    TEST(cif_predicate_create_and(&pred3, pred1, pred2), CIF_OK, test_name, 20);
+    TEST(cif_loop_select(loop, pred3, &pktitr), CIF_OK, test_name, 21);
+    for (packet_num = 2; packet_num < 4; packet_num += 1) {
+        TEST(cif_pktitr_next_row(pktitr, row), CIF_OK, test_name, 22);
+        TEST(cif_value_get_number(row[x_index], &d), CIF_OK, test_name, 23);
+        TEST(d != 1.5 * packet_num, 0, test_name, 24);
+    }
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_FINISHED, test_name, 25);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 26);
+    cif_predicate_free(pred3);
+
+    /* An exact-match lookup on the indexed labels */
+    label[1] = '7';
+    TEST(cif_predicate_create_char(&pred1, itemlabel, CIF_CMP_EQ, label), CIF_OK, test_name, 27);
+    TEST(cif_loop_select(loop, pred1, &pktitr), CIF_OK, test_name, 28);
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_OK, test_name, 29);
+    TEST(cif_value_get_text(row[1 - x_index], &text), CIF_OK, test_name, 30);
+    TEST(u_strcmp(text, label), 0, test_name, 31);
+    free(text);
+    TEST(cif_value_get_number(row[x_index], &d), CIF_OK, test_name, 32);
+    TEST(d != 10.5, 0, test_name, 33);
+
+    /* The index follows modifications to the values */
+    TEST(cif_pktitr_remove_packet(pktitr), CIF_OK, test_name, 34);
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_FINISHED, test_name, 35);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 36);
+    TEST(cif_loop_select(loop, pred1, &pktitr), CIF_OK, test_name, 37);
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_FINISHED, test_name, 38);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 39);
+    cif_predicate_free(pred1);
+
+    cif_value_free(row[0]);
+    cif_value_free(row[1]);
+    cif_loop_free(loop);
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+
+    return 0;
+}
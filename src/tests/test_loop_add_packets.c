@@ -0,0 +1,131 @@
+/*
+ * test_loop_add_packets.c
+ *
+ * Tests adding multiple packets to a loop via cif_loop_add_packets().
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+#include "assert_value.h"
+#include "test.h"
+
+#define NUM_PACKETS 5
+int main(void) {
+    char test_name[80] = "test_loop_add_packets";
+    cif_tp *cif = NULL;
+    cif_block_tp *block = NULL;
+    cif_loop_tp *loop;
+    cif_loop_tp *scalar_loop;
+    cif_pktitr_tp *pktitr;
+    cif_packet_tp *packets[NUM_PACKETS + 1];
+    cif_packet_tp *packet;
+    cif_value_tp *value;
+    U_STRING_DECL(block_code, "block", 6);
+    UChar item1l[] = { '_', 'i', 't', 'e', 'm', '1', 0 };
+    UChar item2l[] = { '_', 'i', 't', 'e', 'm', '2', 0 };
+    UChar item3l[] = { '_', 'i', 't', 'e', 'm', '3', 0 };
+    UChar item4l[] = { '_', 'i', 't', 'e', 'm', '4', 0 };
+    UChar *item_names[3];
+    double d;
+    int index;
+    unsigned packet_mask;
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    U_STRING_INIT(block_code, "block", 6);
+
+    item_names[0] = item1l;
+    item_names[1] = item2l;
+    item_names[2] = NULL;
+
+    CREATE_CIF(test_name, cif);
+    CREATE_BLOCK(test_name, cif, block_code, block);
+
+    TEST(cif_container_create_loop(block, NULL, item_names, &loop), CIF_OK, test_name, 1);
+
+    /* Prepare packets; only some provide a value for _item2 */
+    for (index = 0; index < NUM_PACKETS; index += 1) {
+        TEST(cif_packet_create(packets + index, (index % 2) ? item_names : NULL), CIF_OK, test_name, 10 + 3 * index);
+        TEST(cif_packet_set_item(packets[index], item1l, NULL), CIF_OK, test_name, 11 + 3 * index);
+        TEST(cif_packet_get_item(packets[index], item1l, &value), CIF_OK, test_name, 12 + 3 * index);
+        cif_value_init_numb(value, (double) index, 0.0, 0, 1);
+    }
+    packets[NUM_PACKETS] = NULL;
+
+    /* Test degenerate and erroneous batches */
+    TEST(cif_loop_add_packets(loop, NULL, 1), CIF_ARGUMENT_ERROR, test_name, 29);
+    TEST(cif_loop_add_packets(loop, packets, 0), CIF_OK, test_name, 30);
+    TEST(cif_loop_get_packets(loop, &pktitr), CIF_EMPTY_LOOP, test_name, 31);
+    TEST(cif_loop_add_packets(loop, packets, NUM_PACKETS + 1), CIF_INVALID_PACKET, test_name, 32);
+    TEST(cif_packet_create(&packet, NULL), CIF_OK, test_name, 33);
+    packets[NUM_PACKETS] = packet;
+    TEST(cif_loop_add_packets(loop, packets, NUM_PACKETS + 1), CIF_INVALID_PACKET, test_name, 34);
+    TEST(cif_packet_set_item(packet, item3l, NULL), CIF_OK, test_name, 35);
+    TEST(cif_loop_add_packets(loop, packets, NUM_PACKETS + 1), CIF_WRONG_LOOP, test_name, 36);
+    TEST(cif_loop_get_packets(loop, &pktitr), CIF_EMPTY_LOOP, test_name, 37);
+
+    /* Test adding a valid batch */
+    TEST(cif_loop_add_packets(loop, packets, NUM_PACKETS), CIF_OK, test_name, 38);
+    TEST(cif_loop_add_packets(loop, packets + 2, 1), CIF_OK, test_name, 39);
+
+    /* Read back the packets */
+    TEST(cif_loop_get_packets(loop, &pktitr), CIF_OK, test_name, 40);
+    for (packet_mask = 0, index = 0; index < NUM_PACKETS + 1; index += 1) {
+        int key;
+        cif_packet_tp *iterated = NULL;
+
+        TEST(cif_pktitr_next_packet(pktitr, &iterated), CIF_OK, test_name, 41 + 5 * index);
+        TEST(cif_packet_get_item(iterated, item1l, &value), CIF_OK, test_name, 42 + 5 * index);
+        TEST(cif_value_get_number(value, &d), CIF_OK, test_name, 43 + 5 * index);
+        key = (int) d;
+        TEST(cif_packet_get_item(iterated, item2l, &value), CIF_OK, test_name, 44 + 5 * index);
+        TEST(cif_value_kind(value), CIF_UNK_KIND, test_name, 45 + 5 * index);
+        packet_mask |= (1 << key);
+        cif_packet_free(iterated);
+    }
+    TEST(cif_pktitr_next_packet(pktitr, NULL), CIF_FINISHED, test_name, 80);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 81);
+    TEST(packet_mask, (1 << NUM_PACKETS) - 1, test_name, 82);
+
+    /* Test the scalar loop, which may hold only one packet */
+    TEST(cif_container_set_value(block, item4l, NULL), CIF_OK, test_name, 83);
+    TEST(cif_container_get_item_loop(block, item4l, &scalar_loop), CIF_OK, test_name, 84);
+    TEST(cif_packet_remove_item(packet, item3l, NULL), CIF_OK, test_name, 85);
+    TEST(cif_packet_set_item(packet, item4l, NULL), CIF_OK, test_name, 86);
+    TEST(cif_loop_add_packets(scalar_loop, packets + NUM_PACKETS, 1), CIF_RESERVED_LOOP, test_name, 87);
+    TEST(cif_loop_get_packets(scalar_loop, &pktitr), CIF_OK, test_name, 88);
+    TEST(cif_pktitr_next_packet(pktitr, NULL), CIF_OK, test_name, 89);
+    TEST(cif_pktitr_next_packet(pktitr, NULL), CIF_FINISHED, test_name, 90);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 91);
+
+    cif_loop_free(scalar_loop);
+    for (index = 0; index <= NUM_PACKETS; index += 1) {
+        cif_packet_free(packets[index]);
+    }
+    cif_loop_free(loop);
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+
+    return 0;
+}
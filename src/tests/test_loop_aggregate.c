@@ -0,0 +1,132 @@
+/*
+ * test_loop_aggregate.c
+ *
+ * Tests computing summary statistics of a loop item's values via cif_loop_aggregate().
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+#include "test.h"
+
+#define NUM_PACKETS 7
+int main(void) {
+    char test_name[80] = "test_loop_aggregate";
+    cif_tp *cif = NULL;
+    cif_block_tp *block = NULL;
+    cif_loop_tp *loop;
+    cif_loop_tp *loop2;
+    cif_packet_tp *packet;
+    cif_value_tp *value;
+    cif_aggregate_tp aggregate;
+    U_STRING_DECL(block_code, "block", 6);
+    U_STRING_DECL(char_value, "12.5", 5);
+    UChar itemxl[] = { '_', 'x', 0 };
+    UChar itemxu[] = { '_', 'X', 0 };
+    UChar itemyl[] = { '_', 'y', 0 };
+    UChar itemzl[] = { '_', 'z', 0 };
+    UChar nosuch[] = { '_', 'n', 'o', 's', 'u', 'c', 'h', 0 };
+    UChar invalid[] = { 'x', 0 };
+    UChar *item_names[3];
+    UChar *item_names2[2];
+    /* the kinds of the _x values, and the numeric ones among them */
+    cif_kind_tp kinds[NUM_PACKETS] = { CIF_NUMB_KIND, CIF_NUMB_KIND, CIF_UNK_KIND, CIF_NUMB_KIND, CIF_NA_KIND,
+            CIF_NUMB_KIND, CIF_CHAR_KIND };
+    double x[NUM_PACKETS] = { 2.5, -1.0, 0.0, 4.0, 0.0, 6.5, 0.0 };
+    int packet_num;
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    U_STRING_INIT(block_code, "block", 6);
+    U_STRING_INIT(char_value, "12.5", 5);
+
+    item_names[0] = itemxl;
+    item_names[1] = itemyl;
+    item_names[2] = NULL;
+    item_names2[0] = itemzl;
+    item_names2[1] = NULL;
+
+    CREATE_CIF(test_name, cif);
+    CREATE_BLOCK(test_name, cif, block_code, block);
+
+    TEST(cif_container_create_loop(block, NULL, item_names, &loop), CIF_OK, test_name, 1);
+    TEST(cif_container_create_loop(block, NULL, item_names2, &loop2), CIF_OK, test_name, 2);
+
+    /* _y is unknown throughout */
+    TEST(cif_packet_create(&packet, item_names), CIF_OK, test_name, 3);
+    for (packet_num = 0; packet_num < NUM_PACKETS; packet_num += 1) {
+        TEST(cif_packet_get_item(packet, itemxl, &value), CIF_OK, test_name, 4);
+        switch (kinds[packet_num]) {
+            case CIF_NUMB_KIND:
+                TEST(cif_value_init_numb(value, x[packet_num], 0.5, 1, 1), CIF_OK, test_name, 5);
+                break;
+            case CIF_CHAR_KIND:
+                TEST(cif_value_copy_char(value, char_value), CIF_OK, test_name, 6);
+                break;
+            default:
+                TEST(cif_value_init(value, kinds[packet_num]), CIF_OK, test_name, 7);
+                break;
+        }
+        TEST(cif_loop_add_packet(loop, packet), CIF_OK, test_name, 8);
+    }
+    cif_packet_free(packet);
+
+    /* Test erroneous arguments */
+    TEST(cif_loop_aggregate(loop, itemxl, NULL), CIF_ARGUMENT_ERROR, test_name, 9);
+    TEST(cif_loop_aggregate(loop, NULL, &aggregate), CIF_INVALID_ITEMNAME, test_name, 10);
+    TEST(cif_loop_aggregate(loop, invalid, &aggregate), CIF_INVALID_ITEMNAME, test_name, 11);
+    TEST(cif_loop_aggregate(loop, nosuch, &aggregate), CIF_WRONG_LOOP, test_name, 12);
+    TEST(cif_loop_aggregate(loop, itemzl, &aggregate), CIF_WRONG_LOOP, test_name, 13);
+
+    /* Summarize _x, naming it in a different case; the character value does not count as a number */
+    TEST(cif_loop_aggregate(loop, itemxu, &aggregate), CIF_OK, test_name, 14);
+    TEST(aggregate.numb_count, 4, test_name, 15);
+    TEST(aggregate.unk_count, 1, test_name, 16);
+    TEST(aggregate.na_count, 1, test_name, 17);
+    TEST(aggregate.other_count, 1, test_name, 18);
+    TEST(aggregate.min != -1.0, 0, test_name, 19);
+    TEST(aggregate.max != 6.5, 0, test_name, 20);
+    TEST(aggregate.sum != 12.0, 0, test_name, 21);
+    TEST(aggregate.mean != 3.0, 0, test_name, 22);
+
+    /* An item with no numeric values */
+    TEST(cif_loop_aggregate(loop, itemyl, &aggregate), CIF_OK, test_name, 23);
+    TEST(aggregate.numb_count, 0, test_name, 24);
+    TEST(aggregate.unk_count, NUM_PACKETS, test_name, 25);
+    TEST(aggregate.na_count, 0, test_name, 26);
+    TEST(aggregate.other_count, 0, test_name, 27);
+    TEST((aggregate.min != 0.0) || (aggregate.max != 0.0) || (aggregate.sum != 0.0) || (aggregate.mean != 0.0), 0,
+            test_name, 28);
+
+    /* An item of an empty loop */
+    TEST(cif_loop_aggregate(loop2, itemzl, &aggregate), CIF_OK, test_name, 29);
+    TEST((aggregate.numb_count != 0) || (aggregate.unk_count != 0) || (aggregate.na_count != 0)
+            || (aggregate.other_count != 0), 0, test_name, 30);
+
+    cif_loop_free(loop2);
+    cif_loop_free(loop);
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+
+    return 0;
+}
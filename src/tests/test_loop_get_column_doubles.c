@@ -0,0 +1,137 @@
+/*
+ * test_loop_get_column_doubles.c
+ *
+ * Tests reading a loop column as numbers via cif_loop_get_column_doubles().
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+#include "test.h"
+
+#define NUM_PACKETS 100
+int main(void) {
+    char test_name[80] = "test_loop_get_column_doubles";
+    cif_tp *cif = NULL;
+    cif_block_tp *block = NULL;
+    cif_loop_tp *loop;
+    cif_loop_tp *empty_loop;
+    cif_packet_tp *packet;
+    cif_value_tp *value;
+    double *values;
+    double *sus;
+    cif_kind_tp *kinds;
+    size_t count;
+    U_STRING_DECL(block_code, "block", 6);
+    UChar item1l[] = { '_', 'i', 't', 'e', 'm', '1', 0 };
+    UChar item2l[] = { '_', 'i', 't', 'e', 'm', '2', 0 };
+    UChar item3l[] = { '_', 'i', 't', 'e', 'm', '3', 0 };
+    UChar item4l[] = { '_', 'i', 't', 'e', 'm', '4', 0 };
+    UChar item1u[] = { '_', 'I', 'T', 'E', 'M', '1', 0 };
+    UChar nosuch[] = { '_', 'n', 'o', 's', 'u', 'c', 'h', 0 };
+    UChar text[] = { 't', 'e', 'x', 't', 0 };
+    UChar *item_names[3];
+    UChar *empty_names[2];
+    int index;
+    int mismatches;
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    U_STRING_INIT(block_code, "block", 6);
+
+    item_names[0] = item1l;
+    item_names[1] = item2l;
+    item_names[2] = NULL;
+    empty_names[0] = item4l;
+    empty_names[1] = NULL;
+
+    CREATE_CIF(test_name, cif);
+    CREATE_BLOCK(test_name, cif, block_code, block);
+
+    TEST(cif_container_create_loop(block, NULL, item_names, &loop), CIF_OK, test_name, 1);
+    TEST(cif_container_create_loop(block, NULL, empty_names, &empty_loop), CIF_OK, test_name, 2);
+    TEST(cif_container_set_value(block, item3l, NULL), CIF_OK, test_name, 3);
+
+    /* Packet n has _item1 = n(1) * 0.5 except where a char or unknown value is interspersed */
+    TEST(cif_packet_create(&packet, item_names), CIF_OK, test_name, 4);
+    TEST(cif_packet_get_item(packet, item1l, &value), CIF_OK, test_name, 5);
+    for (index = 0; index < NUM_PACKETS; index += 1) {
+        if (index == 7) {
+            TEST(cif_value_copy_char(value, text), CIF_OK, test_name, 6);
+        } else if (index == 11) {
+            TEST(cif_value_init(value, CIF_UNK_KIND), CIF_OK, test_name, 7);
+        } else {
+            TEST(cif_value_init_numb(value, index * 0.5, 0.25, 2, 1), CIF_OK, test_name, 8);
+        }
+        TEST(cif_loop_add_packet(loop, packet), CIF_OK, test_name, 9);
+    }
+    cif_packet_free(packet);
+
+    /* Test erroneous calls */
+    TEST(cif_loop_get_column_doubles(loop, item1l, NULL, NULL, NULL, &count), CIF_ARGUMENT_ERROR, test_name, 10);
+    TEST(cif_loop_get_column_doubles(loop, item1l, &values, NULL, NULL, NULL), CIF_ARGUMENT_ERROR, test_name, 11);
+    TEST(cif_loop_get_column_doubles(loop, NULL, &values, NULL, NULL, &count), CIF_INVALID_ITEMNAME, test_name, 12);
+    TEST(cif_loop_get_column_doubles(loop, nosuch, &values, NULL, NULL, &count), CIF_WRONG_LOOP, test_name, 13);
+    TEST(cif_loop_get_column_doubles(loop, item3l, &values, NULL, NULL, &count), CIF_WRONG_LOOP, test_name, 14);
+    TEST(cif_loop_get_column_doubles(loop, item4l, &values, NULL, NULL, &count), CIF_WRONG_LOOP, test_name, 15);
+
+    /* Test reading the numeric column */
+    TEST(cif_loop_get_column_doubles(loop, item1u, &values, &sus, &kinds, &count), CIF_OK, test_name, 16);
+    TEST(count != NUM_PACKETS, 0, test_name, 17);
+    for (mismatches = 0, index = 0; index < NUM_PACKETS; index += 1) {
+        if (index == 7) {
+            mismatches += ((kinds[index] != CIF_CHAR_KIND) || (values[index] != 0.0) || (sus[index] != 0.0));
+        } else if (index == 11) {
+            mismatches += ((kinds[index] != CIF_UNK_KIND) || (values[index] != 0.0) || (sus[index] != 0.0));
+        } else {
+            mismatches += ((kinds[index] != CIF_NUMB_KIND) || (values[index] != index * 0.5)
+                    || (sus[index] != 0.25));
+        }
+    }
+    TEST(mismatches, 0, test_name, 18);
+    free(values);
+    free(sus);
+    free(kinds);
+
+    /* The su and kind arrays are optional; _item2 holds only unknown values */
+    TEST(cif_loop_get_column_doubles(loop, item2l, &values, NULL, NULL, &count), CIF_OK, test_name, 19);
+    TEST(count != NUM_PACKETS, 0, test_name, 20);
+    for (mismatches = 0, index = 0; index < NUM_PACKETS; index += 1) {
+        mismatches += (values[index] != 0.0);
+    }
+    TEST(mismatches, 0, test_name, 21);
+    free(values);
+
+    /* Test an empty loop */
+    TEST(cif_loop_get_column_doubles(empty_loop, item4l, &values, &sus, NULL, &count), CIF_OK, test_name, 22);
+    TEST(count, 0, test_name, 23);
+    free(values);
+    free(sus);
+
+    cif_loop_free(empty_loop);
+    cif_loop_free(loop);
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+
+    return 0;
+}
@@ -46,8 +46,18 @@ int main(void) {
     cif_loop_tp *loop2;
     U_STRING_DECL(block_code, "block1", 7);
     UChar item1[] = { '_', 'i', 't', 'e', 'm', '1', 0 };
+    UChar itemx[] = { '_', 'x', 0 };
+    UChar itemy[] = { '_', 'y', 0 };
+    UChar itemz[] = { '_', 'z', 0 };
     UChar *items[NUM_ITEMS + 1];
+    UChar *items2[3];
     UChar **names;
+    cif_packet_tp *packet;
+    cif_pktitr_tp *pktitr;
+    cif_value_tp *value;
+    cif_value_tp *row[3] = { NULL, NULL, NULL };
+    double d;
+    int index;
 
     /* Initialize data and prepare the test fixture */
     TESTHEADER(test_name);
@@ -85,6 +95,51 @@ int main(void) {
     cif_loop_free(loop1);
     free(names);
 
+    /* Items are presented in the order they were added to the loop, not the order their names were first used */
+    TEST(cif_container_set_value(block, itemx, NULL), CIF_OK, test_name, 9);
+    TEST(cif_container_set_value(block, itemy, NULL), CIF_OK, test_name, 10);
+    TEST(cif_container_set_value(block, itemz, NULL), CIF_OK, test_name, 11);
+    TEST(cif_container_remove_item(block, itemx), CIF_OK, test_name, 12);
+    TEST(cif_container_remove_item(block, itemy), CIF_OK, test_name, 13);
+    TEST(cif_container_remove_item(block, itemz), CIF_OK, test_name, 14);
+    items2[0] = itemz;
+    items2[1] = itemy;
+    items2[2] = NULL;
+    TEST(cif_container_create_loop(block, NULL, items2, &loop1), CIF_OK, test_name, 15);
+    TEST(cif_loop_add_item(loop1, itemx, NULL), CIF_OK, test_name, 16);
+    TEST(cif_loop_get_names(loop1, &names), CIF_OK, test_name, 17);
+    TEST(u_strcmp(itemz, names[0]), 0, test_name, 18);
+    TEST(u_strcmp(itemy, names[1]), 0, test_name, 19);
+    TEST(u_strcmp(itemx, names[2]), 0, test_name, 20);
+    TEST(names[3] != NULL, 0, test_name, 21);
+    for (index = 0; index < 3; index += 1) {
+        free(names[index]);
+    }
+    free(names);
+
+    /* ... and packet rows present their values in the same order */
+    TEST(cif_packet_create(&packet, NULL), CIF_OK, test_name, 22);
+    TEST(cif_packet_set_item(packet, itemx, NULL), CIF_OK, test_name, 23);
+    TEST(cif_packet_get_item(packet, itemx, &value), CIF_OK, test_name, 24);
+    TEST(cif_value_init_numb(value, 3.0, 0.0, 0, 1), CIF_OK, test_name, 25);
+    TEST(cif_packet_set_item(packet, itemz, NULL), CIF_OK, test_name, 26);
+    TEST(cif_packet_get_item(packet, itemz, &value), CIF_OK, test_name, 27);
+    TEST(cif_value_init_numb(value, 1.0, 0.0, 0, 1), CIF_OK, test_name, 28);
+    TEST(cif_loop_add_packet(loop1, packet), CIF_OK, test_name, 29);
+    cif_packet_free(packet);
+    TEST(cif_loop_get_packets(loop1, &pktitr), CIF_OK, test_name, 30);
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_OK, test_name, 31);
+    TEST(cif_value_get_number(row[0], &d), CIF_OK, test_name, 32);
+    TEST(d != 1.0, 0, test_name, 33);
+    TEST(cif_value_kind(row[1]), CIF_UNK_KIND, test_name, 34);
+    TEST(cif_value_get_number(row[2], &d), CIF_OK, test_name, 35);
+    TEST(d != 3.0, 0, test_name, 36);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 37);
+    for (index = 0; index < 3; index += 1) {
+        cif_value_free(row[index]);
+    }
+    cif_loop_free(loop1);
+
     /* Final cleanup */
     DESTROY_CIF(test_name, cif);
 
@@ -0,0 +1,157 @@
+/*
+ * test_loop_get_packets_for.c
+ *
+ * Tests iterating over selected items of a loop's packets via cif_loop_get_packets_for().
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+#include "test.h"
+
+#define NUM_PACKETS 3
+int main(void) {
+    char test_name[80] = "test_loop_get_packets_for";
+    cif_tp *cif = NULL;
+    cif_block_tp *block = NULL;
+    cif_loop_tp *loop;
+    cif_pktitr_tp *pktitr;
+    cif_packet_tp *packet;
+    cif_value_tp *value;
+    cif_value_tp *row[2] = { NULL, NULL };
+    U_STRING_DECL(block_code, "block", 6);
+    UChar itemal[] = { '_', 'a', 0 };
+    UChar itembl[] = { '_', 'b', 0 };
+    UChar itemcl[] = { '_', 'c', 0 };
+    UChar itemdl[] = { '_', 'd', 0 };
+    UChar itemdu[] = { '_', 'D', 0 };
+    UChar nosuch[] = { '_', 'n', 'o', 's', 'u', 'c', 'h', 0 };
+    UChar *item_names[5];
+    UChar *selection[4];
+    const UChar **names;
+    int packet_num;
+    int index;
+    double d;
+    double d2;
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    U_STRING_INIT(block_code, "block", 6);
+
+    item_names[0] = itemal;
+    item_names[1] = itembl;
+    item_names[2] = itemcl;
+    item_names[3] = itemdl;
+    item_names[4] = NULL;
+
+    CREATE_CIF(test_name, cif);
+    CREATE_BLOCK(test_name, cif, block_code, block);
+
+    TEST(cif_container_create_loop(block, NULL, item_names, &loop), CIF_OK, test_name, 1);
+
+    /* In packet n, the value of each item is n + 10 times the item's position */
+    TEST(cif_packet_create(&packet, item_names), CIF_OK, test_name, 2);
+    for (packet_num = 0; packet_num < NUM_PACKETS; packet_num += 1) {
+        for (index = 0; index < 4; index += 1) {
+            TEST(cif_packet_get_item(packet, item_names[index], &value), CIF_OK, test_name, 3);
+            TEST(cif_value_init_numb(value, (double) (packet_num + 10 * index), 0.0, 0, 1), CIF_OK, test_name, 4);
+        }
+        TEST(cif_loop_add_packet(loop, packet), CIF_OK, test_name, 5);
+    }
+    cif_packet_free(packet);
+
+    /* Test erroneous selections */
+    selection[0] = NULL;
+    TEST(cif_loop_get_packets_for(loop, NULL, &pktitr), CIF_ARGUMENT_ERROR, test_name, 6);
+    TEST(cif_loop_get_packets_for(loop, selection, &pktitr), CIF_ARGUMENT_ERROR, test_name, 7);
+    selection[0] = itembl;
+    selection[1] = nosuch;
+    selection[2] = NULL;
+    TEST(cif_loop_get_packets_for(loop, selection, &pktitr), CIF_WRONG_LOOP, test_name, 8);
+
+    /* Select _d (by a differently-cased name), and _b twice */
+    selection[0] = itemdu;
+    selection[1] = itembl;
+    selection[2] = itembl;
+    selection[3] = NULL;
+    TEST(cif_loop_get_packets_for(loop, selection, &pktitr), CIF_OK, test_name, 9);
+    for (packet_num = 0; packet_num < NUM_PACKETS; packet_num += 1) {
+        packet = NULL;
+        TEST(cif_pktitr_next_packet(pktitr, &packet), CIF_OK, test_name, 10 + 6 * packet_num);
+        TEST(cif_packet_get_names(packet, &names), CIF_OK, test_name, 11 + 6 * packet_num);
+        for (index = 0; names[index] != NULL; index += 1) ;
+        free(names);
+        TEST(index, 2, test_name, 12 + 6 * packet_num);
+        TEST(cif_packet_get_item(packet, itembl, &value), CIF_OK, test_name, 13 + 6 * packet_num);
+        TEST((cif_value_get_number(value, &d) != CIF_OK) || (d != packet_num + 10.0), 0, test_name,
+                14 + 6 * packet_num);
+        TEST(cif_packet_get_item(packet, itemdl, &value), CIF_OK, test_name, 15 + 6 * packet_num);
+        TEST((cif_value_get_number(value, &d) != CIF_OK) || (d != packet_num + 30.0), 0, test_name,
+                16 + 6 * packet_num);
+        if (packet_num == 0) {
+            /* updating a selected item is permitted, but updating another is not */
+            TEST(cif_packet_get_item(packet, itembl, &value), CIF_OK, test_name, 30);
+            cif_value_init(value, CIF_NA_KIND);
+            TEST(cif_pktitr_update_packet(pktitr, packet), CIF_OK, test_name, 31);
+            TEST(cif_packet_set_item(packet, itemal, NULL), CIF_OK, test_name, 32);
+            TEST(cif_pktitr_update_packet(pktitr, packet), CIF_WRONG_LOOP, test_name, 33);
+        } else if (packet_num == 1) {
+            /* removal removes the whole packet */
+            TEST(cif_pktitr_remove_packet(pktitr), CIF_OK, test_name, 34);
+        }
+        cif_packet_free(packet);
+    }
+    TEST(cif_pktitr_next_packet(pktitr, NULL), CIF_FINISHED, test_name, 35);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 36);
+
+    /* Verify the modifications, reading rows in the order given by cif_loop_get_names() */
+    selection[0] = itemal;
+    selection[1] = itemcl;
+    selection[2] = NULL;
+    TEST(cif_loop_get_packets_for(loop, selection, &pktitr), CIF_OK, test_name, 37);
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_OK, test_name, 38);
+    TEST(cif_value_get_number(row[0], &d), CIF_OK, test_name, 39);
+    TEST(cif_value_get_number(row[1], &d2), CIF_OK, test_name, 40);
+    TEST((d != 0.0) || (d2 != 20.0), 0, test_name, 41);
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_OK, test_name, 42);
+    TEST(cif_value_get_number(row[0], &d), CIF_OK, test_name, 43);
+    TEST(cif_value_get_number(row[1], &d2), CIF_OK, test_name, 44);
+    TEST((d != 2.0) || (d2 != 22.0), 0, test_name, 45);
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_FINISHED, test_name, 46);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 47);
+
+    selection[0] = itembl;
+    selection[1] = NULL;
+    TEST(cif_loop_get_packets_for(loop, selection, &pktitr), CIF_OK, test_name, 48);
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_OK, test_name, 49);
+    TEST(cif_value_kind(row[0]), CIF_NA_KIND, test_name, 50);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 51);
+
+    cif_value_free(row[0]);
+    cif_value_free(row[1]);
+    cif_loop_free(loop);
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * test_loop_item_cache.c
+ *
+ * Tests that loop handles correctly track changes to the loop's items when validating packets.
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+#include "test.h"
+
+int main(void) {
+    char test_name[80] = "test_loop_item_cache";
+    cif_tp *cif = NULL;
+    cif_block_tp *block = NULL;
+    cif_loop_tp *loop;
+    cif_loop_tp *loop2;
+    cif_packet_tp *packet;
+    U_STRING_DECL(block_code, "block", 6);
+    UChar item1l[] = { '_', 'i', 't', 'e', 'm', '1', 0 };
+    UChar item2l[] = { '_', 'i', 't', 'e', 'm', '2', 0 };
+    UChar item3l[] = { '_', 'i', 't', 'e', 'm', '3', 0 };
+    UChar item3u[] = { '_', 'I', 'T', 'E', 'M', '3', 0 };
+    UChar item4l[] = { '_', 'i', 't', 'e', 'm', '4', 0 };
+    UChar *item_names[3];
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    U_STRING_INIT(block_code, "block", 6);
+
+    item_names[0] = item1l;
+    item_names[1] = item2l;
+    item_names[2] = NULL;
+
+    CREATE_CIF(test_name, cif);
+    CREATE_BLOCK(test_name, cif, block_code, block);
+
+    TEST(cif_container_create_loop(block, NULL, item_names, &loop), CIF_OK, test_name, 1);
+    TEST(cif_packet_create(&packet, item_names), CIF_OK, test_name, 2);
+    TEST(cif_loop_add_packet(loop, packet), CIF_OK, test_name, 3);
+    TEST(cif_loop_add_packet(loop, packet), CIF_OK, test_name, 4);
+
+    /* an item added via the same handle is accepted */
+    TEST(cif_packet_set_item(packet, item3l, NULL), CIF_OK, test_name, 5);
+    TEST(cif_loop_add_packet(loop, packet), CIF_WRONG_LOOP, test_name, 6);
+    TEST(cif_loop_add_item(loop, item3u, NULL), CIF_OK, test_name, 7);
+    TEST(cif_loop_add_packet(loop, packet), CIF_OK, test_name, 8);
+
+    /* an item added via a different handle is accepted */
+    TEST(cif_container_get_item_loop(block, item1l, &loop2), CIF_OK, test_name, 9);
+    TEST(cif_packet_set_item(packet, item4l, NULL), CIF_OK, test_name, 10);
+    TEST(cif_loop_add_item(loop2, item4l, NULL), CIF_OK, test_name, 11);
+    TEST(cif_loop_add_packet(loop, packet), CIF_OK, test_name, 12);
+
+    /* an item removed via the container is rejected */
+    TEST(cif_container_remove_item(block, item3l), CIF_OK, test_name, 13);
+    TEST(cif_loop_add_packet(loop, packet), CIF_WRONG_LOOP, test_name, 14);
+    TEST(cif_packet_remove_item(packet, item3l, NULL), CIF_OK, test_name, 15);
+    TEST(cif_loop_add_packet(loop, packet), CIF_OK, test_name, 16);
+
+    /* an item restored after removal is accepted again */
+    TEST(cif_loop_add_item(loop2, item3l, NULL), CIF_OK, test_name, 17);
+    TEST(cif_packet_set_item(packet, item3l, NULL), CIF_OK, test_name, 18);
+    TEST(cif_loop_add_packet(loop, packet), CIF_OK, test_name, 19);
+
+    /* the destroyed loop's items are rejected by a surviving handle */
+    TEST(cif_loop_destroy(loop2), CIF_OK, test_name, 20);
+    TEST(cif_loop_add_packet(loop, packet), CIF_WRONG_LOOP, test_name, 21);
+
+    cif_packet_free(packet);
+    cif_loop_free(loop);
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+
+    return 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * test_loop_join.c
+ *
+ * Tests iterating over the packets formed by joining two loops on key items, via cif_loop_join().
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+#include "test.h"
+
+#define NUM_ATOMS 4
+#define NUM_BONDS 5
+#define NUM_PAIRS 4
+int main(void) {
+    char test_name[80] = "test_loop_join";
+    cif_tp *cif = NULL;
+    cif_block_tp *block = NULL;
+    cif_block_tp *block2 = NULL;
+    cif_loop_tp *atoms;
+    cif_loop_tp *bonds;
+    cif_loop_tp *atoms2;
+    cif_loop_tp *lengths;
+    cif_pktitr_tp *pktitr;
+    cif_packet_tp *packet;
+    cif_value_tp *value;
+    U_STRING_DECL(block_code, "block", 6);
+    U_STRING_DECL(block_code2, "block2", 7);
+    UChar itemlabel[] = { '_', 'l', 'a', 'b', 'e', 'l', 0 };
+    UChar itemlabelu[] = { '_', 'L', 'A', 'B', 'E', 'L', 0 };
+    UChar itemocc[] = { '_', 'o', 'c', 'c', 0 };
+    UChar itematom1[] = { '_', 'a', 't', 'o', 'm', '1', 0 };
+    UChar itemdist[] = { '_', 'd', 'i', 's', 't', 0 };
+    UChar itemlength[] = { '_', 'l', 'e', 'n', 'g', 't', 'h', 0 };
+    UChar two[] = { '2', '.', '0', 0 };
+    UChar nosuch[] = { '_', 'n', 'o', 's', 'u', 'c', 'h', 0 };
+    UChar invalid[] = { 'x', 0 };
+    UChar *atom_names[3];
+    UChar *bond_names[3];
+    UChar *length_names[2];
+    UChar label[2] = { 0, 0 };
+    UChar *text;
+    /* the bonds' first atoms: C and D are each bonded twice, and X is not among the atoms */
+    char bond_atoms[NUM_BONDS + 1] = "DCXDC";
+    /* the expected joined packets, as (atom, bond) pairs in atom order, then bond order */
+    char expected_atoms[NUM_PAIRS + 1] = "CCDD";
+    int expected_bonds[NUM_PAIRS] = { 1, 4, 0, 3 };
+    int packet_num;
+    double d;
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    U_STRING_INIT(block_code, "block", 6);
+    U_STRING_INIT(block_code2, "block2", 7);
+
+    atom_names[0] = itemlabel;
+    atom_names[1] = itemocc;
+    atom_names[2] = NULL;
+    bond_names[0] = itematom1;
+    bond_names[1] = itemdist;
+    bond_names[2] = NULL;
+    length_names[0] = itemlength;
+    length_names[1] = NULL;
+
+    CREATE_CIF(test_name, cif);
+    CREATE_BLOCK(test_name, cif, block_code, block);
+    CREATE_BLOCK(test_name, cif, block_code2, block2);
+
+    TEST(cif_container_create_loop(block, NULL, atom_names, &atoms), CIF_OK, test_name, 1);
+    TEST(cif_container_create_loop(block, NULL, bond_names, &bonds), CIF_OK, test_name, 2);
+    TEST(cif_container_create_loop(block2, NULL, atom_names, &atoms2), CIF_OK, test_name, 3);
+    TEST(cif_container_create_loop(block2, NULL, length_names, &lengths), CIF_OK, test_name, 4);
+
+    /* The atoms are A, B, C, D, with occupancies 0.00, 0.25, 0.50, 0.75 */
+    TEST(cif_packet_create(&packet, atom_names), CIF_OK, test_name, 5);
+    for (packet_num = 0; packet_num < NUM_ATOMS; packet_num += 1) {
+        TEST(cif_packet_get_item(packet, itemlabel, &value), CIF_OK, test_name, 6);
+        label[0] = (UChar) ('A' + packet_num);
+        TEST(cif_value_copy_char(value, label), CIF_OK, test_name, 7);
+        TEST(cif_packet_get_item(packet, itemocc, &value), CIF_OK, test_name, 8);
+        TEST(cif_value_init_numb(value, 0.25 * packet_num, 0.0, 2, 1), CIF_OK, test_name, 9);
+        TEST(cif_loop_add_packet(atoms, packet), CIF_OK, test_name, 10);
+    }
+    cif_packet_free(packet);
+
+    /* The bond distances are 1.0, 1.5, ... */
+    TEST(cif_packet_create(&packet, bond_names), CIF_OK, test_name, 11);
+    for (packet_num = 0; packet_num < NUM_BONDS; packet_num += 1) {
+        TEST(cif_packet_get_item(packet, itematom1, &value), CIF_OK, test_name, 12);
+        label[0] = (UChar) bond_atoms[packet_num];
+        TEST(cif_value_copy_char(value, label), CIF_OK, test_name, 13);
+        TEST(cif_packet_get_item(packet, itemdist, &value), CIF_OK, test_name, 14);
+        TEST(cif_value_init_numb(value, 1.0 + 0.5 * packet_num, 0.0, 1, 1), CIF_OK, test_name, 15);
+        TEST(cif_loop_add_packet(bonds, packet), CIF_OK, test_name, 16);
+    }
+    cif_packet_free(packet);
+
+    /* Test erroneous arguments */
+    TEST(cif_loop_join(atoms, itemlabel, bonds, itematom1, NULL), CIF_ARGUMENT_ERROR, test_name, 17);
+    TEST(cif_loop_join(atoms, invalid, bonds, itematom1, &pktitr), CIF_INVALID_ITEMNAME, test_name, 18);
+    TEST(cif_loop_join(atoms, itemlabel, bonds, NULL, &pktitr), CIF_INVALID_ITEMNAME, test_name, 19);
+    TEST(cif_loop_join(atoms, nosuch, bonds, itematom1, &pktitr), CIF_WRONG_LOOP, test_name, 20);
+    TEST(cif_loop_join(atoms, itemlabel, bonds, itemlabel, &pktitr), CIF_WRONG_LOOP, test_name, 21);
+    TEST(cif_loop_join(atoms, itemlabel, atoms, itemlabel, &pktitr), CIF_DUP_ITEMNAME, test_name, 22);
+    TEST(cif_loop_join(atoms, itemlabel, atoms2, itemlabel, &pktitr), CIF_DUP_ITEMNAME, test_name, 23);
+
+    /* Join each atom to its bonds, naming the left key in a different case */
+    TEST(cif_loop_join(atoms, itemlabelu, bonds, itematom1, &pktitr), CIF_OK, test_name, 24);
+    packet = NULL;
+    for (packet_num = 0; packet_num < NUM_PAIRS; packet_num += 1) {
+        TEST(cif_pktitr_next_packet(pktitr, &packet), CIF_OK, test_name, 25);
+        label[0] = (UChar) expected_atoms[packet_num];
+        TEST(cif_packet_get_item(packet, itemlabel, &value), CIF_OK, test_name, 26);
+        TEST(cif_value_get_text(value, &text), CIF_OK, test_name, 27);
+        TEST(u_strcmp(text, label), 0, test_name, 28);
+        free(text);
+        TEST(cif_packet_get_item(packet, itematom1, &value), CIF_OK, test_name, 29);
+        TEST(cif_value_get_text(value, &text), CIF_OK, test_name, 30);
+        TEST(u_strcmp(text, label), 0, test_name, 31);
+        free(text);
+        TEST(cif_packet_get_item(packet, itemocc, &value), CIF_OK, test_name, 32);
+        TEST(cif_value_get_number(value, &d), CIF_OK, test_name, 33);
+        TEST(d != 0.25 * (expected_atoms[packet_num] - 'A'), 0, test_name, 34);
+        TEST(cif_packet_get_item(packet, itemdist, &value), CIF_OK, test_name, 35);
+        TEST(cif_value_get_number(value, &d), CIF_OK, test_name, 36);
+        TEST(d != 1.0 + 0.5 * expected_bonds[packet_num], 0, test_name, 37);
+        /* joined packets are read-only */
+        TEST(cif_pktitr_update_packet(pktitr, packet), CIF_NOT_SUPPORTED, test_name, 38);
+        TEST(cif_pktitr_remove_packet(pktitr), CIF_NOT_SUPPORTED, test_name, 39);
+    }
+    cif_packet_free(packet);
+    TEST(cif_pktitr_next_packet(pktitr, NULL), CIF_FINISHED, test_name, 40);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 41);
+
+    /* Numbers never match character values, so joining labels to distances matches nothing */
+    TEST(cif_loop_join(atoms, itemlabel, bonds, itemdist, &pktitr), CIF_OK, test_name, 42);
+    TEST(cif_pktitr_next_packet(pktitr, NULL), CIF_FINISHED, test_name, 43);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 44);
+
+    /* The lengths, in another block, are the numbers 1.50 and 3.0 and the text '2.0' */
+    TEST(cif_packet_create(&packet, length_names), CIF_OK, test_name, 45);
+    TEST(cif_packet_get_item(packet, itemlength, &value), CIF_OK, test_name, 46);
+    TEST(cif_value_init_numb(value, 1.5, 0.0, 2, 1), CIF_OK, test_name, 47);
+    TEST(cif_loop_add_packet(lengths, packet), CIF_OK, test_name, 48);
+    TEST(cif_value_copy_char(value, two), CIF_OK, test_name, 49);
+    TEST(cif_loop_add_packet(lengths, packet), CIF_OK, test_name, 50);
+    TEST(cif_value_init_numb(value, 3.0, 0.0, 1, 1), CIF_OK, test_name, 51);
+    TEST(cif_loop_add_packet(lengths, packet), CIF_OK, test_name, 52);
+    cif_packet_free(packet);
+
+    /* Numbers match by value, regardless of how they are written, and across containers */
+    TEST(cif_loop_join(bonds, itemdist, lengths, itemlength, &pktitr), CIF_OK, test_name, 53);
+    packet = NULL;
+    TEST(cif_pktitr_next_packet(pktitr, &packet), CIF_OK, test_name, 54);
+    TEST(cif_packet_get_item(packet, itemlength, &value), CIF_OK, test_name, 55);
+    TEST((cif_value_get_number(value, &d) != CIF_OK) || (d != 1.5), 0, test_name, 56);
+    TEST(cif_pktitr_next_packet(pktitr, &packet), CIF_OK, test_name, 57);
+    TEST(cif_packet_get_item(packet, itemdist, &value), CIF_OK, test_name, 58);
+    TEST((cif_value_get_number(value, &d) != CIF_OK) || (d != 3.0), 0, test_name, 59);
+    cif_packet_free(packet);
+    TEST(cif_pktitr_next_packet(pktitr, NULL), CIF_FINISHED, test_name, 60);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 61);
+
+    cif_loop_free(lengths);
+    cif_loop_free(atoms2);
+    cif_loop_free(bonds);
+    cif_loop_free(atoms);
+    cif_block_free(block2);
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * test_loop_select.c
+ *
+ * Tests iterating over the packets of a loop that satisfy a predicate, via cif_loop_select().
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+#include "test.h"
+
+#define NUM_PACKETS 5
+int main(void) {
+    char test_name[80] = "test_loop_select";
+    cif_tp *cif = NULL;
+    cif_block_tp *block = NULL;
+    cif_loop_tp *loop;
+    cif_pktitr_tp *pktitr;
+    cif_packet_tp *packet;
+    cif_value_tp *value;
+    cif_value_tp *row[2] = { NULL, NULL };
+    cif_predicate_tp *pred1;
+    cif_predicate_tp *pred2;
+    cif_predicate_tp *pred3;
+    U_STRING_DECL(block_code, "block", 6);
+    U_STRING_DECL(label_c, "C", 2);
+    U_STRING_DECL(label_o, "O", 2);
+    UChar itemlabel[] = { '_', 'l', 'a', 'b', 'e', 'l', 0 };
+    UChar itemoccl[] = { '_', 'o', 'c', 'c', 0 };
+    UChar itemoccu[] = { '_', 'O', 'C', 'C', 0 };
+    UChar nosuch[] = { '_', 'n', 'o', 's', 'u', 'c', 'h', 0 };
+    UChar *item_names[3];
+    UChar label[2] = { 0, 0 };
+    UChar *text;
+    /* occupancies: the last packet's is unknown */
+    double occupancies[NUM_PACKETS] = { 1.0, 0.5, 1.0, 0.25, 0.0 };
+    int packet_num;
+    double d;
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    U_STRING_INIT(block_code, "block", 6);
+    U_STRING_INIT(label_c, "C", 2);
+    U_STRING_INIT(label_o, "O", 2);
+
+    item_names[0] = itemlabel;
+    item_names[1] = itemoccl;
+    item_names[2] = NULL;
+
+    CREATE_CIF(test_name, cif);
+    CREATE_BLOCK(test_name, cif, block_code, block);
+
+    TEST(cif_container_create_loop(block, NULL, item_names, &loop), CIF_OK, test_name, 1);
+
+    /* The labels are A, B, C, D, E */
+    TEST(cif_packet_create(&packet, item_names), CIF_OK, test_name, 2);
+    for (packet_num = 0; packet_num < NUM_PACKETS; packet_num += 1) {
+        TEST(cif_packet_get_item(packet, itemlabel, &value), CIF_OK, test_name, 3);
+        label[0] = (UChar) ('A' + packet_num);
+        TEST(cif_value_copy_char(value, label), CIF_OK, test_name, 4);
+        TEST(cif_packet_get_item(packet, itemoccl, &value), CIF_OK, test_name, 5);
+        if (packet_num == NUM_PACKETS - 1) {
+            cif_value_init(value, CIF_UNK_KIND);
+        } else {
+            TEST(cif_value_init_numb(value, occupancies[packet_num], 0.0, 2, 1), CIF_OK, test_name, 6);
+        }
+        TEST(cif_loop_add_packet(loop, packet), CIF_OK, test_name, 7);
+    }
+    cif_packet_free(packet);
+
+    /* Test erroneous predicates */
+    TEST(cif_predicate_create_numb(&pred1, itemoccl, (cif_compare_tp) 17, 1.0), CIF_ARGUMENT_ERROR, test_name, 8);
+    TEST(cif_predicate_create_char(&pred1, itemlabel, CIF_CMP_EQ, NULL), CIF_ARGUMENT_ERROR, test_name, 9);
+    TEST(cif_predicate_create_numb(&pred1, label_c, CIF_CMP_EQ, 1.0), CIF_INVALID_ITEMNAME, test_name, 10);
+    TEST(cif_loop_select(loop, NULL, &pktitr), CIF_ARGUMENT_ERROR, test_name, 11);
+    TEST(cif_predicate_create_numb(&pred1, nosuch, CIF_CMP_EQ, 1.0), CIF_OK, test_name, 12);
+    TEST(cif_loop_select(loop, pred1, &pktitr), CIF_WRONG_LOOP, test_name, 13);
+    cif_predicate_free(pred1);
+
+    /* Select the partially-occupied sites, naming the item in a different case */
+    TEST(cif_predicate_create_numb(&pred1, itemoccu, CIF_CMP_LT, 1.0), CIF_OK, test_name, 14);
+    TEST(cif_loop_select(loop, pred1, &pktitr), CIF_OK, test_name, 15);
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_OK, test_name, 16);
+    label[0] = 'B';
+    TEST(cif_value_get_text(row[0], &text), CIF_OK, test_name, 17);
+    TEST(u_strcmp(text, label), 0, test_name, 18);
+    free(text);
+    TEST(cif_value_get_number(row[1], &d), CIF_OK, test_name, 19);
+    TEST(d != 0.5, 0, test_name, 20);
+    packet = NULL;
+    TEST(cif_pktitr_next_packet(pktitr, &packet), CIF_OK, test_name, 21);
+    TEST(cif_packet_get_item(packet, itemoccl, &value), CIF_OK, test_name, 22);
+    TEST((cif_value_get_number(value, &d) != CIF_OK) || (d != 0.25), 0, test_name, 23);
+    /* removing a selected packet removes it from the loop */
+    TEST(cif_pktitr_remove_packet(pktitr), CIF_OK, test_name, 24);
+    cif_packet_free(packet);
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_FINISHED, test_name, 25);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 26);
+
+    /* A predicate no packet satisfies yields an iterator that is already finished */
+    TEST(cif_predicate_create_numb(&pred2, itemoccl, CIF_CMP_GT, 1.0), CIF_OK, test_name, 27);
+    TEST(cif_loop_select(loop, pred2, &pktitr), CIF_OK, test_name, 28);
+    TEST(cif_pktitr_next_packet(pktitr, NULL), CIF_FINISHED, test_name, 29);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 30);
+    cif_predicate_free(pred2);
+
+    /* (_occ < 1 or _label > 'C') and _label <> 'O': B and E remain, E only via its label */
+    TEST(cif_predicate_create_char(&pred2, itemlabel, CIF_CMP_GT, label_c), CIF_OK, test_name, 31);
+    TEST(cif_predicate_create_or(&pred3, pred1, pred2), CIF_OK, test_name, 32);
+    TEST(cif_predicate_create_char(&pred1, itemlabel, CIF_CMP_NE, label_o), CIF_OK, test_name, 33);
+    TEST(cif_predicate_create_and(&pred2, pred3, NULL), CIF_ARGUMENT_ERROR, test_name, 34);
+    TEST(cif_predicate_create_and(&pred2, pred3, pred1), CIF_OK, test_name, 35);
+    TEST(cif_loop_select(loop, pred2, &pktitr), CIF_OK, test_name, 36);
+    label[0] = 'B';
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_OK, test_name, 37);
+    TEST(cif_value_get_text(row[0], &text), CIF_OK, test_name, 38);
+    TEST(u_strcmp(text, label), 0, test_name, 39);
+    free(text);
+    label[0] = 'E';
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_OK, test_name, 40);
+    TEST(cif_value_get_text(row[0], &text), CIF_OK, test_name, 41);
+    TEST(u_strcmp(text, label), 0, test_name, 42);
+    free(text);
+    TEST(cif_value_kind(row[1]), CIF_UNK_KIND, test_name, 43);
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_FINISHED, test_name, 44);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 45);
+
+    /* The predicate remains usable after an iteration */
+    TEST(cif_loop_select(loop, pred2, &pktitr), CIF_OK, test_name, 46);
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_OK, test_name, 47);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 48);
+    cif_predicate_free(pred2);
+
+    cif_value_free(row[0]);
+    cif_value_free(row[1]);
+    cif_loop_free(loop);
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * test_open.c
+ *
+ * Tests saving managed CIFs to database files via cif_save_as(), and opening them via cif_open().
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+
+#include "assert_cifs.h"
+#include "test.h"
+
+#define BUFFER_SIZE 512
+int main(void) {
+    char test_name[80] = "test_open";
+    char local_file_name[] = "cif_core.dic";
+    char file_name[BUFFER_SIZE];
+    char db_name[] = "test_open.db";
+    char new_db_name[] = "test_open_new.db";
+    char bad_db_name[] = "test_open_bad.db";
+    FILE * cif_file;
+    struct cif_parse_opts_s *options;
+    cif_tp *cif = NULL;
+    cif_tp *cif_opened = NULL;
+    cif_block_tp *block = NULL;
+    cif_block_tp **block_list = NULL;
+    U_STRING_DECL(block_code, "test_open_block", 16);
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+    U_STRING_INIT(block_code, "test_open_block", 16);
+    remove(db_name);
+    remove(new_db_name);
+    remove(bad_db_name);
+
+    /* construct the test file name and open the file */
+    RESOLVE_DATADIR(file_name, BUFFER_SIZE - strlen(local_file_name));
+    TEST_NOT(file_name[0], 0, test_name, 1);
+    strcat(file_name, local_file_name);
+    cif_file = fopen(file_name, "rb");
+    TEST(cif_file == NULL, 0, test_name, 2);
+
+    /* invalid arguments, and missing files */
+    TEST(cif_open(db_name, CIF_OPEN_CREATE | CIF_OPEN_READONLY, &cif_opened), CIF_ARGUMENT_ERROR, test_name, 3);
+    TEST(cif_open(NULL, 0, &cif_opened), CIF_ARGUMENT_ERROR, test_name, 4);
+    TEST(cif_open(db_name, 0, NULL), CIF_ARGUMENT_ERROR, test_name, 5);
+    TEST(cif_open(db_name, 0, &cif_opened), CIF_ERROR, test_name, 6);
+    TEST(cif_open(db_name, CIF_OPEN_READONLY, &cif_opened), CIF_ERROR, test_name, 7);
+
+    /* parse a reference CIF, and save it */
+    TEST(cif_parse_options_create(&options), CIF_OK, test_name, 8);
+    options->max_frame_depth = -1;
+    TEST(cif_parse(cif_file, options, &cif), CIF_OK, test_name, 9);
+    free(options);
+    TEST(cif_save_as(NULL, db_name), CIF_ARGUMENT_ERROR, test_name, 10);
+    TEST(cif_save_as(cif, NULL), CIF_ARGUMENT_ERROR, test_name, 11);
+    TEST(cif_save_as(cif, db_name), CIF_OK, test_name, 12);
+
+    /* reopen the saved CIF read-only, and compare it with the original */
+    TEST(cif_open(db_name, CIF_OPEN_READONLY, &cif_opened), CIF_OK, test_name, 13);
+    TEST_NOT(assert_cifs_equal(cif, cif_opened), 0, test_name, 14);
+    TEST(cif_create_block(cif_opened, block_code, NULL) == CIF_OK, 0, test_name, 15);
+    DESTROY_CIF(test_name, cif_opened);
+
+    /* modify the saved CIF, and verify that the modification persists */
+    TEST(cif_open(db_name, 0, &cif_opened), CIF_OK, test_name, 16);
+    TEST(cif_create_block(cif_opened, block_code, NULL), CIF_OK, test_name, 17);
+    DESTROY_CIF(test_name, cif_opened);
+    TEST(cif_open(db_name, CIF_OPEN_CREATE, &cif_opened), CIF_OK, test_name, 18);
+    TEST(cif_get_block(cif_opened, block_code, &block), CIF_OK, test_name, 19);
+    TEST(cif_container_destroy(block), CIF_OK, test_name, 20);
+    TEST_NOT(assert_cifs_equal(cif, cif_opened), 0, test_name, 21);
+    DESTROY_CIF(test_name, cif_opened);
+
+    /* create a new, empty database */
+    TEST(cif_open(new_db_name, CIF_OPEN_CREATE, &cif_opened), CIF_OK, test_name, 22);
+    TEST(cif_get_all_blocks(cif_opened, &block_list), CIF_OK, test_name, 23);
+    TEST(*block_list == NULL, 1, test_name, 24);
+    free(block_list);
+    TEST(cif_create_block(cif_opened, block_code, NULL), CIF_OK, test_name, 25);
+    DESTROY_CIF(test_name, cif_opened);
+    TEST(cif_open(new_db_name, 0, &cif_opened), CIF_OK, test_name, 26);
+    TEST(cif_get_block(cif_opened, block_code, NULL), CIF_OK, test_name, 27);
+    DESTROY_CIF(test_name, cif_opened);
+
+    /* files that are not CIF databases are rejected */
+    TEST(cif_open(file_name, CIF_OPEN_READONLY, &cif_opened), CIF_ENVIRONMENT_ERROR, test_name, 28);
+    fclose(fopen(bad_db_name, "wb"));
+    TEST(cif_open(bad_db_name, 0, &cif_opened), CIF_ENVIRONMENT_ERROR, test_name, 29);
+
+    /* clean up */
+    DESTROY_CIF(test_name, cif);
+    fclose(cif_file);  /* ignore any failure here */
+    remove(db_name);
+    remove(new_db_name);
+    remove(bad_db_name);
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * test_parse_buffer.c
+ *
+ * Tests parsing CIFs from in-memory bytes, via cif_parse_buffer().
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+#include "test.h"
+
+int main(void) {
+    char test_name[80] = "test_parse_buffer";
+    cif_tp *cif = NULL;
+    cif_block_tp **block_list = NULL;
+    cif_block_tp *block = NULL;
+    cif_value_tp *value = NULL;
+    UChar *ustr;
+    double d;
+    /* the second block lies beyond the length that will be given */
+    const char cif2[] = "#\\#CIF_2.0\ndata_a\n_x 1.5\n_y [a b]\ndata_b\n";
+    /* a UTF-8 encoded byte order mark, followed by a CIF 2.0 document */
+    const char utf8[] = "\xef\xbb\xbf" "#\\#CIF_2.0\ndata_u _x 2";
+    U_STRING_DECL(code_a,  "a", 2);
+    U_STRING_DECL(code_u,  "u", 2);
+    U_STRING_DECL(name_x,  "_x", 3);
+    U_STRING_DECL(name_y,  "_y", 3);
+
+    U_STRING_INIT(code_a,  "a", 2);
+    U_STRING_INIT(code_u,  "u", 2);
+    U_STRING_INIT(name_x,  "_x", 3);
+    U_STRING_INIT(name_y,  "_y", 3);
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    /* Test erroneous arguments */
+    TEST(cif_parse_buffer(NULL, 1, NULL, &cif), CIF_ARGUMENT_ERROR, test_name, 1);
+
+    /* No bytes yield an empty CIF */
+    TEST(cif_parse_buffer(NULL, 0, NULL, &cif), CIF_OK, test_name, 2);
+    TEST(cif_get_all_blocks(cif, &block_list), CIF_OK, test_name, 3);
+    TEST((*block_list != NULL), 0, test_name, 4);
+    free(block_list);
+    DESTROY_CIF(test_name, cif);
+    cif = NULL;
+
+    /* Only the specified number of bytes is parsed; the CIF 2.0 magic code selects CIF 2.0 syntax */
+    TEST(cif_parse_buffer(cif2, strlen(cif2) - strlen("data_b\n"), NULL, &cif), CIF_OK, test_name, 5);
+    TEST(cif_get_all_blocks(cif, &block_list), CIF_OK, test_name, 6);
+    TEST((*block_list == NULL), 0, test_name, 7);
+    TEST_NOT((*(block_list + 1) == NULL), 0, test_name, 8);
+    block = *block_list;
+    free(block_list);
+    TEST(cif_container_get_code(block, &ustr), CIF_OK, test_name, 9);
+    TEST(u_strcmp(code_a, ustr), 0, test_name, 10);
+    free(ustr);
+    TEST(cif_container_get_value(block, name_x, &value), CIF_OK, test_name, 11);
+    TEST(cif_value_get_number(value, &d), CIF_OK, test_name, 12);
+    TEST_NOT(d == 1.5, 0, test_name, 13);
+    TEST(cif_container_get_value(block, name_y, &value), CIF_OK, test_name, 14);
+    TEST(cif_value_kind(value), CIF_LIST_KIND, test_name, 15);
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+    cif = NULL;
+
+    /* The character encoding is detected from a Unicode signature */
+    TEST(cif_parse_buffer(utf8, strlen(utf8), NULL, &cif), CIF_OK, test_name, 16);
+    TEST(cif_get_all_blocks(cif, &block_list), CIF_OK, test_name, 17);
+    TEST((*block_list == NULL), 0, test_name, 18);
+    TEST_NOT((*(block_list + 1) == NULL), 0, test_name, 19);
+    block = *block_list;
+    free(block_list);
+    TEST(cif_container_get_code(block, &ustr), CIF_OK, test_name, 20);
+    TEST(u_strcmp(code_u, ustr), 0, test_name, 21);
+    free(ustr);
+    TEST(cif_container_get_value(block, name_x, &value), CIF_OK, test_name, 22);
+    TEST(cif_value_get_number(value, &d), CIF_OK, test_name, 23);
+    TEST_NOT(d == 2.0, 0, test_name, 24);
+    cif_value_free(value);
+
+    /* clean up */
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * test_parse_bulk_load.c
+ *
+ * Tests parsing CIF data in bulk-load mode.
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+
+#include "assert_cifs.h"
+#include "test.h"
+
+#define BUFFER_SIZE 512
+int main(void) {
+    char test_name[80] = "test_parse_bulk_load";
+    char local_file_name[] = "cif_core.dic";
+    char file_name[BUFFER_SIZE];
+    FILE * cif_file;
+    struct cif_parse_opts_s *options;
+    cif_tp *cif = NULL;
+    cif_tp *cif_bulk = NULL;
+    cif_block_tp **block_list = NULL;
+    cif_block_tp **block_p;
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    /* construct the test file name and open the file */
+    RESOLVE_DATADIR(file_name, BUFFER_SIZE - strlen(local_file_name));
+    TEST_NOT(file_name[0], 0, test_name, 1);
+    strcat(file_name, local_file_name);
+    cif_file = fopen(file_name, "rb");
+    TEST(cif_file == NULL, 0, test_name, 2);
+
+    /* set parse options */
+    TEST(cif_parse_options_create(&options), CIF_OK, test_name, 3);
+    TEST(options->bulk_load, 0, test_name, 4);
+    options->max_frame_depth = -1;
+
+    /* parse the file normally, as a reference */
+    TEST(cif_parse(cif_file, options, &cif), CIF_OK, test_name, 5);
+
+    /* parse the file again in bulk-load mode, and verify that the results are the same */
+    rewind(cif_file);
+    options->bulk_load = 1;
+    TEST(cif_parse(cif_file, options, &cif_bulk), CIF_OK, test_name, 6);
+    TEST_NOT(assert_cifs_equal(cif, cif_bulk), 0, test_name, 7);
+
+    /* parsing the same data into the same CIF fails for duplicate block codes, and must leave the CIF unchanged */
+    rewind(cif_file);
+    TEST(cif_parse(cif_file, options, &cif_bulk), CIF_DUP_BLOCKCODE, test_name, 8);
+    TEST_NOT(assert_cifs_equal(cif, cif_bulk), 0, test_name, 9);
+
+    /* the CIF must still be modifiable outside bulk-load mode afterward */
+    TEST(cif_get_all_blocks(cif_bulk, &block_list), CIF_OK, test_name, 10);
+    TEST(*block_list == NULL, 0, test_name, 11);
+    TEST(cif_container_destroy(*block_list), CIF_OK, test_name, 12);
+    for (block_p = block_list + 1; *block_p; block_p += 1) {
+        cif_block_free(*block_p);
+    }
+    free(block_list);
+    TEST(cif_get_all_blocks(cif_bulk, &block_list), CIF_OK, test_name, 13);
+    TEST(*block_list == NULL, 1, test_name, 14);
+    free(block_list);
+
+    free(options);
+
+    /* clean up */
+    DESTROY_CIF(test_name, cif_bulk);
+    DESTROY_CIF(test_name, cif);
+    fclose(cif_file);  /* ignore any failure here */
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * test_parse_file.c
+ *
+ * Tests parsing CIFs from files named by path, via cif_parse_file().
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+#include "test.h"
+
+#define BUFFER_SIZE 512
+int main(void) {
+    char test_name[80] = "test_parse_file";
+    char file_name[BUFFER_SIZE];
+    char *local_name;
+    cif_tp *cif = NULL;
+    cif_block_tp **block_list = NULL;
+    cif_block_tp *block = NULL;
+    cif_value_tp *value = NULL;
+    UChar *ustr;
+    double d;
+    U_STRING_DECL(code_simple_data, "simple_data", 12);
+    U_STRING_DECL(name_sq_string,   "_sq_string", 11);
+    U_STRING_DECL(name_numb_plain,  "_numb_plain", 12);
+    U_STRING_DECL(value_sq,         "sq", 3);
+
+    U_STRING_INIT(code_simple_data, "simple_data", 12);
+    U_STRING_INIT(name_sq_string,   "_sq_string", 11);
+    U_STRING_INIT(name_numb_plain,  "_numb_plain", 12);
+    U_STRING_INIT(value_sq,         "sq", 3);
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    RESOLVE_DATADIR(file_name, BUFFER_SIZE - 32);
+    TEST_NOT(file_name[0], 0, test_name, 1);
+    local_name = file_name + strlen(file_name);
+
+    /* Test erroneous arguments */
+    TEST(cif_parse_file(NULL, NULL, &cif), CIF_ARGUMENT_ERROR, test_name, 2);
+    strcpy(local_name, "no_such_file.cif");
+    TEST(cif_parse_file(file_name, NULL, NULL), CIF_ERROR, test_name, 3);
+
+    /* An empty file yields an empty CIF */
+    strcpy(local_name, "empty.cif");
+    TEST(cif_parse_file(file_name, NULL, &cif), CIF_OK, test_name, 4);
+    TEST(cif_get_all_blocks(cif, &block_list), CIF_OK, test_name, 5);
+    TEST((*block_list != NULL), 0, test_name, 6);
+    free(block_list);
+    DESTROY_CIF(test_name, cif);
+    cif = NULL;
+
+    /* A file consisting only of a Unicode signature likewise yields an empty CIF */
+    strcpy(local_name, "bom.cif");
+    TEST(cif_parse_file(file_name, NULL, &cif), CIF_OK, test_name, 7);
+    TEST(cif_get_all_blocks(cif, &block_list), CIF_OK, test_name, 8);
+    TEST((*block_list != NULL), 0, test_name, 9);
+    free(block_list);
+    DESTROY_CIF(test_name, cif);
+    cif = NULL;
+
+    /* A file with content */
+    strcpy(local_name, "simple_data.cif");
+    TEST(cif_parse_file(file_name, NULL, &cif), CIF_OK, test_name, 10);
+    TEST(cif_get_all_blocks(cif, &block_list), CIF_OK, test_name, 11);
+    TEST((*block_list == NULL), 0, test_name, 12);
+    TEST_NOT((*(block_list + 1) == NULL), 0, test_name, 13);
+    block = *block_list;
+    free(block_list);
+    TEST(cif_container_get_code(block, &ustr), CIF_OK, test_name, 14);
+    TEST(u_strcmp(code_simple_data, ustr), 0, test_name, 15);
+    free(ustr);
+
+    TEST(cif_container_get_value(block, name_sq_string, &value), CIF_OK, test_name, 16);
+    TEST(cif_value_get_text(value, &ustr), CIF_OK, test_name, 17);
+    TEST(u_strcmp(ustr, value_sq), 0, test_name, 18);
+    free(ustr);
+
+    TEST(cif_container_get_value(block, name_numb_plain, &value), CIF_OK, test_name, 19);
+    TEST(cif_value_get_number(value, &d), CIF_OK, test_name, 20);
+    TEST_NOT(d == 1250.0, 0, test_name, 21);
+    cif_value_free(value);
+
+    /* clean up */
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+
+    return 0;
+}
@@ -0,0 +1,188 @@
+/*
+ * test_parse_long_tokens.c
+ *
+ * Tests parsing values and whitespace runs long enough to be scanned in multi-character strides, including the
+ * characters that must interrupt such runs.
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+#include "test.h"
+
+static int record_error(int code, size_t line, size_t column, const UChar *text, size_t length, void *data);
+
+/* records the details of the most recent parse error */
+struct error_s {
+    int code;
+    size_t line;
+    size_t column;
+};
+
+int main(void) {
+    char test_name[80] = "test_parse_long_tokens";
+    cif_tp *cif = NULL;
+    struct cif_parse_opts_s *options;
+    struct error_s error = { 0, 0, 0 };
+    cif_block_tp *block = NULL;
+    cif_value_tp *value = NULL;
+    cif_value_tp *element = NULL;
+    UChar *ustr;
+    const char cif2[] = "#\\#CIF_2.0\ndata_d\n"
+            "_l [abcdefghijklmnopqrstuvwxyz 0123456789ABCDEFGHIJ]\n"
+            "_t\n;0123456789;abcdefghij\xc3\xa9klmnopqrstuvwxyz;\n;\n"
+            "_q '''abcdefghijk'lmn''opqrstuvwxyz'''\n"
+            "_c                    'abcdefghijklmnopqr\n";
+    const char cif1[] = "data_e\n_s 'abcdefghij'klmnopqrstuv'\n";
+    const char extra_ws[] = "#\\#CIF_2.0\ndata_f\nloop_ _a _b abcdefghijklm|nopqrstuvwxyz\n";
+    UChar value_t[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', ';', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h',
+            'i', 'j', 0xe9, 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z', ';', 0 };
+    U_STRING_DECL(code_d, "d", 2);
+    U_STRING_DECL(code_e, "e", 2);
+    U_STRING_DECL(code_f, "f", 2);
+    U_STRING_DECL(name_l, "_l", 3);
+    U_STRING_DECL(name_t, "_t", 3);
+    U_STRING_DECL(name_q, "_q", 3);
+    U_STRING_DECL(name_c, "_c", 3);
+    U_STRING_DECL(name_s, "_s", 3);
+    U_STRING_DECL(name_a, "_a", 3);
+    U_STRING_DECL(name_b, "_b", 3);
+    U_STRING_DECL(value_l0, "abcdefghijklmnopqrstuvwxyz", 27);
+    U_STRING_DECL(value_l1, "0123456789ABCDEFGHIJ", 21);
+    U_STRING_DECL(value_q, "abcdefghijk'lmn''opqrstuvwxyz", 30);
+    U_STRING_DECL(value_c, "abcdefghijklmnopqr", 19);
+    U_STRING_DECL(value_s, "abcdefghij'klmnopqrstuv", 24);
+    U_STRING_DECL(value_a, "abcdefghijklm", 14);
+    U_STRING_DECL(value_b, "nopqrstuvwxyz", 14);
+
+    U_STRING_INIT(code_d, "d", 2);
+    U_STRING_INIT(code_e, "e", 2);
+    U_STRING_INIT(code_f, "f", 2);
+    U_STRING_INIT(name_l, "_l", 3);
+    U_STRING_INIT(name_t, "_t", 3);
+    U_STRING_INIT(name_q, "_q", 3);
+    U_STRING_INIT(name_c, "_c", 3);
+    U_STRING_INIT(name_s, "_s", 3);
+    U_STRING_INIT(name_a, "_a", 3);
+    U_STRING_INIT(name_b, "_b", 3);
+    U_STRING_INIT(value_l0, "abcdefghijklmnopqrstuvwxyz", 27);
+    U_STRING_INIT(value_l1, "0123456789ABCDEFGHIJ", 21);
+    U_STRING_INIT(value_q, "abcdefghijk'lmn''opqrstuvwxyz", 30);
+    U_STRING_INIT(value_c, "abcdefghijklmnopqr", 19);
+    U_STRING_INIT(value_s, "abcdefghij'klmnopqrstuv", 24);
+    U_STRING_INIT(value_a, "abcdefghijklm", 14);
+    U_STRING_INIT(value_b, "nopqrstuvwxyz", 14);
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    TEST(cif_parse_options_create(&options), CIF_OK, test_name, 1);
+    options->error_callback = record_error;
+    options->user_data = &error;
+
+    /* The only error in the CIF 2.0 document is the unterminated string at the end */
+    TEST(cif_parse_buffer(cif2, strlen(cif2), options, &cif), CIF_OK, test_name, 2);
+    TEST(error.code, CIF_MISSING_ENDQUOTE, test_name, 3);
+    TEST(error.line, 8, test_name, 4);
+    TEST(error.column, 41, test_name, 5);
+    TEST(cif_get_block(cif, code_d, &block), CIF_OK, test_name, 6);
+
+    /* Unquoted values end at a closing bracket */
+    TEST(cif_container_get_value(block, name_l, &value), CIF_OK, test_name, 7);
+    TEST(cif_value_get_element_at(value, 0, &element), CIF_OK, test_name, 8);
+    TEST(cif_value_get_text(element, &ustr), CIF_OK, test_name, 9);
+    TEST(u_strcmp(ustr, value_l0), 0, test_name, 10);
+    free(ustr);
+    TEST(cif_value_get_element_at(value, 1, &element), CIF_OK, test_name, 11);
+    TEST(cif_value_get_text(element, &ustr), CIF_OK, test_name, 12);
+    TEST(u_strcmp(ustr, value_l1), 0, test_name, 13);
+    free(ustr);
+
+    /* Text fields end only at a semicolon at the start of a line, and may contain non-ASCII characters */
+    TEST(cif_container_get_value(block, name_t, &value), CIF_OK, test_name, 14);
+    TEST(cif_value_get_text(value, &ustr), CIF_OK, test_name, 15);
+    TEST(u_strcmp(ustr, value_t), 0, test_name, 16);
+    free(ustr);
+
+    /* Triple-quoted strings end only at three delimiters */
+    TEST(cif_container_get_value(block, name_q, &value), CIF_OK, test_name, 17);
+    TEST(cif_value_get_text(value, &ustr), CIF_OK, test_name, 18);
+    TEST(u_strcmp(ustr, value_q), 0, test_name, 19);
+    free(ustr);
+
+    /* An unterminated string ends at the end of its line */
+    TEST(cif_container_get_value(block, name_c, &value), CIF_OK, test_name, 20);
+    TEST(cif_value_get_text(value, &ustr), CIF_OK, test_name, 21);
+    TEST(u_strcmp(ustr, value_c), 0, test_name, 22);
+    free(ustr);
+    cif_value_free(value);
+    value = NULL;
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+    cif = NULL;
+
+    /* In CIF 1, a delimiter not followed by whitespace does not end a quoted string */
+    error.code = CIF_OK;
+    TEST(cif_parse_buffer(cif1, strlen(cif1), options, &cif), CIF_OK, test_name, 23);
+    TEST(error.code, CIF_OK, test_name, 24);
+    TEST(cif_get_block(cif, code_e, &block), CIF_OK, test_name, 25);
+    TEST(cif_container_get_value(block, name_s, &value), CIF_OK, test_name, 26);
+    TEST(cif_value_get_text(value, &ustr), CIF_OK, test_name, 27);
+    TEST(u_strcmp(ustr, value_s), 0, test_name, 28);
+    free(ustr);
+    cif_value_free(value);
+    value = NULL;
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+    cif = NULL;
+
+    /* Printable characters designated as whitespace separate values */
+    options->extra_ws_chars = "|";
+    TEST(cif_parse_buffer(extra_ws, strlen(extra_ws), options, &cif), CIF_OK, test_name, 29);
+    TEST(error.code, CIF_OK, test_name, 30);
+    TEST(cif_get_block(cif, code_f, &block), CIF_OK, test_name, 31);
+    TEST(cif_container_get_value(block, name_a, &value), CIF_OK, test_name, 32);
+    TEST(cif_value_get_text(value, &ustr), CIF_OK, test_name, 33);
+    TEST(u_strcmp(ustr, value_a), 0, test_name, 34);
+    free(ustr);
+    TEST(cif_container_get_value(block, name_b, &value), CIF_OK, test_name, 35);
+    TEST(cif_value_get_text(value, &ustr), CIF_OK, test_name, 36);
+    TEST(u_strcmp(ustr, value_b), 0, test_name, 37);
+    free(ustr);
+    cif_value_free(value);
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+    free(options);
+
+    return 0;
+}
+
+static int record_error(int code, size_t line, size_t column, const UChar *text UNUSED, size_t length UNUSED,
+        void *data) {
+    struct error_s *error = (struct error_s *) data;
+
+    error->code = code;
+    error->line = line;
+    error->column = column;
+    return CIF_OK;
+}
@@ -0,0 +1,147 @@
+/*
+ * test_parse_utf8.c
+ *
+ * Tests decoding of UTF-8 input during parsing, including recovery from malformed byte sequences and characters
+ * whose encodings straddle the boundaries of the parser's input buffer.
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+#include "test.h"
+
+static int count_errors(int code, size_t line, size_t column, const UChar *text, size_t length, void *data);
+
+/* the number of bytes the parser initially reads from a stream */
+#define STREAM_BUFFER_SIZE 4096
+int main(void) {
+    char test_name[80] = "test_parse_utf8";
+    cif_tp *cif = NULL;
+    struct cif_parse_opts_s *options;
+    cif_block_tp *block = NULL;
+    cif_value_tp *value = NULL;
+    FILE *stream;
+    UChar *ustr;
+    int error_count = 0;
+    /* an overlong encoding of U+0000 */
+    const char overlong[] = "#\\#CIF_2.0\ndata_a _x a\xc0\x80" "b\n";
+    /* an encoded surrogate, in which only the lead byte is consumed with the first error */
+    const char surrogate[] = "#\\#CIF_2.0\ndata_a _x a\xed\xa0\x80" "b\n";
+    /* a sequence truncated by the end of the input */
+    const char truncated[] = "#\\#CIF_2.0\ndata_a _x a\xe2\x82";
+    /* a euro sign and U+1063E, encoded with three and four bytes, respectively */
+    const char multibyte[] = "\xe2\x82\xac\xf0\x90\x98\xbe'\n";
+    const char header[] = "#\\#CIF_2.0\ndata_a\n";
+    const char item[] = "\n_x '";
+    char *text;
+    size_t fill;
+    size_t index;
+    UChar expected_replaced[] = { 'a', 0xfffd, 0xfffd, 0xfffd, 'b', 0 };
+    UChar expected_multibyte[] = { 0x20ac, 0xd801, 0xde3e, 0 };
+    U_STRING_DECL(code_a, "a", 2);
+    U_STRING_DECL(name_x, "_x", 3);
+
+    U_STRING_INIT(code_a, "a", 2);
+    U_STRING_INIT(name_x, "_x", 3);
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    /* By default, malformed sequences abort the parse */
+    TEST(cif_parse_buffer(overlong, strlen(overlong), NULL, NULL), CIF_INVALID_CHAR, test_name, 1);
+    TEST(cif_parse_buffer(truncated, strlen(truncated), NULL, NULL), CIF_INVALID_CHAR, test_name, 2);
+
+    /* Malformed sequences are otherwise each replaced by one replacement character */
+    TEST(cif_parse_options_create(&options), CIF_OK, test_name, 3);
+    options->error_callback = count_errors;
+    options->user_data = &error_count;
+
+    TEST(cif_parse_buffer(overlong, strlen(overlong), options, &cif), CIF_OK, test_name, 4);
+    TEST(error_count, 2, test_name, 5);
+    TEST(cif_get_block(cif, code_a, &block), CIF_OK, test_name, 6);
+    TEST(cif_container_get_value(block, name_x, &value), CIF_OK, test_name, 7);
+    TEST(cif_value_get_text(value, &ustr), CIF_OK, test_name, 8);
+    expected_replaced[3] = 'b';
+    expected_replaced[4] = 0;
+    TEST(u_strcmp(ustr, expected_replaced), 0, test_name, 9);
+    free(ustr);
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+    cif = NULL;
+
+    error_count = 0;
+    TEST(cif_parse_buffer(surrogate, strlen(surrogate), options, &cif), CIF_OK, test_name, 10);
+    TEST(error_count, 3, test_name, 11);
+    TEST(cif_get_block(cif, code_a, &block), CIF_OK, test_name, 12);
+    TEST(cif_container_get_value(block, name_x, &value), CIF_OK, test_name, 13);
+    TEST(cif_value_get_text(value, &ustr), CIF_OK, test_name, 14);
+    expected_replaced[3] = 0xfffd;
+    expected_replaced[4] = 'b';
+    TEST(u_strcmp(ustr, expected_replaced), 0, test_name, 15);
+    free(ustr);
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+    cif = NULL;
+    free(options);
+
+    /* Characters straddling the end of the first bufferful of a stream are decoded intact */
+    fill = STREAM_BUFFER_SIZE - 1 - strlen(header) - strlen(item);
+    text = (char *) malloc(STREAM_BUFFER_SIZE + sizeof(multibyte));
+    TEST(text == NULL, 0, test_name, 16);
+    strcpy(text, header);
+    /* pad with comment lines of 80 characters */
+    for (index = 0; index < fill; index += 1) {
+        text[strlen(header) + index] = ((index % 80 == 0) ? '#' : ((index % 80 == 79) ? '\n' : 'c'));
+    }
+    text[strlen(header) + fill] = '\0';
+    strcat(text, item);
+    strcat(text, multibyte);
+    TEST(text[STREAM_BUFFER_SIZE - 1], multibyte[0], test_name, 17);
+
+    stream = tmpfile();
+    TEST(stream == NULL, 0, test_name, 18);
+    TEST(fwrite(text, 1, strlen(text), stream) != strlen(text), 0, test_name, 19);
+    rewind(stream);
+    free(text);
+
+    TEST(cif_parse(stream, NULL, &cif), CIF_OK, test_name, 20);
+    fclose(stream);
+    TEST(cif_get_block(cif, code_a, &block), CIF_OK, test_name, 21);
+    TEST(cif_container_get_value(block, name_x, &value), CIF_OK, test_name, 22);
+    TEST(cif_value_get_text(value, &ustr), CIF_OK, test_name, 23);
+    TEST(u_strcmp(ustr, expected_multibyte), 0, test_name, 24);
+    free(ustr);
+    cif_value_free(value);
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+
+    return 0;
+}
+
+static int count_errors(int code, size_t line UNUSED, size_t column UNUSED, const UChar *text UNUSED,
+        size_t length UNUSED, void *data) {
+    if (code == CIF_INVALID_CHAR) {
+        *((int *) data) += 1;
+    }
+    return CIF_OK;
+}
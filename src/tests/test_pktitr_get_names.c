@@ -0,0 +1,168 @@
+/*
+ * test_pktitr_get_names.c
+ *
+ * Tests retrieving the names of the items provided by packet iterators of each kind via cif_pktitr_get_names().
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+#include "test.h"
+
+int main(void) {
+    char test_name[80] = "test_pktitr_get_names";
+    cif_tp *cif = NULL;
+    cif_block_tp *block = NULL;
+    cif_loop_tp *left;
+    cif_loop_tp *right;
+    cif_pktitr_tp *pktitr;
+    cif_packet_tp *packet;
+    cif_value_tp *value;
+    cif_value_tp *row[5] = { NULL, NULL, NULL, NULL, NULL };
+    U_STRING_DECL(block_code, "block", 6);
+    UChar itemal[] = { '_', 'a', 0 };
+    UChar itembu[] = { '_', 'B', 0 };
+    UChar itembl[] = { '_', 'b', 0 };
+    UChar itemcl[] = { '_', 'c', 0 };
+    UChar itemkl[] = { '_', 'k', 0 };
+    UChar itemxl[] = { '_', 'x', 0 };
+    UChar *left_names[4];
+    UChar *right_names[3];
+    UChar *selected_names[3];
+    /* the normalized names in the expected row order of each kind of iterator */
+    UChar *all_expected[4];
+    UChar *selected_expected[3];
+    UChar *joined_expected[6];
+    /* the expected values of each item, parallel to joined_expected */
+    double joined_values[5] = { 2.0, 1.0, 3.0, 4.0, 1.0 };
+    const UChar **names;
+    int index;
+    int mismatches;
+    double d;
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    U_STRING_INIT(block_code, "block", 6);
+
+    /* the items are deliberately not declared in their name order */
+    left_names[0] = itembu;
+    left_names[1] = itemal;
+    left_names[2] = itemcl;
+    left_names[3] = NULL;
+    right_names[0] = itemxl;
+    right_names[1] = itemkl;
+    right_names[2] = NULL;
+    selected_names[0] = itemcl;
+    selected_names[1] = itembu;
+    selected_names[2] = NULL;
+
+    all_expected[0] = itembl;
+    all_expected[1] = itemal;
+    all_expected[2] = itemcl;
+    all_expected[3] = NULL;
+    selected_expected[0] = itembl;
+    selected_expected[1] = itemcl;
+    selected_expected[2] = NULL;
+    joined_expected[0] = itembl;
+    joined_expected[1] = itemal;
+    joined_expected[2] = itemcl;
+    joined_expected[3] = itemxl;
+    joined_expected[4] = itemkl;
+    joined_expected[5] = NULL;
+
+    CREATE_CIF(test_name, cif);
+    CREATE_BLOCK(test_name, cif, block_code, block);
+
+    /* The left loop's packet has _B = 2, _a = 1, _c = 3; the right loop's has _x = 4, _k = 1 */
+    TEST(cif_container_create_loop(block, NULL, left_names, &left), CIF_OK, test_name, 1);
+    TEST(cif_packet_create(&packet, left_names), CIF_OK, test_name, 2);
+    for (index = 0; index < 3; index += 1) {
+        TEST(cif_packet_get_item(packet, left_names[index], &value), CIF_OK, test_name, 3);
+        TEST(cif_value_init_numb(value, joined_values[index], 0.0, 0, 1), CIF_OK, test_name, 4);
+    }
+    TEST(cif_loop_add_packet(left, packet), CIF_OK, test_name, 5);
+    cif_packet_free(packet);
+    TEST(cif_container_create_loop(block, NULL, right_names, &right), CIF_OK, test_name, 6);
+    TEST(cif_packet_create(&packet, right_names), CIF_OK, test_name, 7);
+    for (index = 0; index < 2; index += 1) {
+        TEST(cif_packet_get_item(packet, right_names[index], &value), CIF_OK, test_name, 8);
+        TEST(cif_value_init_numb(value, joined_values[3 + index], 0.0, 0, 1), CIF_OK, test_name, 9);
+    }
+    TEST(cif_loop_add_packet(right, packet), CIF_OK, test_name, 10);
+    cif_packet_free(packet);
+
+    /* An iterator over all items provides the loop's items in declaration order */
+    TEST(cif_loop_get_packets(left, &pktitr), CIF_OK, test_name, 11);
+    TEST(cif_pktitr_get_names(pktitr, NULL), CIF_ARGUMENT_ERROR, test_name, 12);
+    TEST(cif_pktitr_get_names(pktitr, &names), CIF_OK, test_name, 13);
+    for (mismatches = 0, index = 0; all_expected[index] != NULL; index += 1) {
+        mismatches += ((names[index] == NULL) || (u_strcmp(names[index], all_expected[index]) != 0));
+    }
+    TEST(mismatches, 0, test_name, 14);
+    TEST(names[index] != NULL, 0, test_name, 15);
+    free(names);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 16);
+
+    /* An iterator over selected items provides only those, in declaration order */
+    TEST(cif_loop_get_packets_for(left, selected_names, &pktitr), CIF_OK, test_name, 17);
+    TEST(cif_pktitr_get_names(pktitr, &names), CIF_OK, test_name, 18);
+    for (mismatches = 0, index = 0; selected_expected[index] != NULL; index += 1) {
+        mismatches += ((names[index] == NULL) || (u_strcmp(names[index], selected_expected[index]) != 0));
+    }
+    TEST(mismatches, 0, test_name, 19);
+    TEST(names[index] != NULL, 0, test_name, 20);
+    free(names);
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_OK, test_name, 21);
+    TEST(cif_value_get_number(row[0], &d), CIF_OK, test_name, 22);
+    TEST(d != 2.0, 0, test_name, 23);
+    TEST(cif_value_get_number(row[1], &d), CIF_OK, test_name, 24);
+    TEST(d != 3.0, 0, test_name, 25);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 26);
+
+    /* A join iterator provides the left loop's items followed by the right loop's */
+    TEST(cif_loop_join(left, itemal, right, itemkl, &pktitr), CIF_OK, test_name, 27);
+    TEST(cif_pktitr_get_names(pktitr, &names), CIF_OK, test_name, 28);
+    for (mismatches = 0, index = 0; joined_expected[index] != NULL; index += 1) {
+        mismatches += ((names[index] == NULL) || (u_strcmp(names[index], joined_expected[index]) != 0));
+    }
+    TEST(mismatches, 0, test_name, 29);
+    TEST(names[index] != NULL, 0, test_name, 30);
+    free(names);
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_OK, test_name, 31);
+    for (mismatches = 0, index = 0; index < 5; index += 1) {
+        mismatches += ((cif_value_get_number(row[index], &d) != CIF_OK) || (d != joined_values[index]));
+    }
+    TEST(mismatches, 0, test_name, 32);
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_FINISHED, test_name, 33);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 34);
+
+    for (index = 0; index < 5; index += 1) {
+        cif_value_free(row[index]);
+    }
+    cif_loop_free(right);
+    cif_loop_free(left);
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+
+    return 0;
+}
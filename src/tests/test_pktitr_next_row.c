@@ -0,0 +1,157 @@
+/*
+ * test_pktitr_next_row.c
+ *
+ * Tests iterating over a loop's packets via cif_pktitr_next_row().
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+#include "test.h"
+
+#define NUM_PACKETS 4
+int main(void) {
+    char test_name[80] = "test_pktitr_next_row";
+    cif_tp *cif = NULL;
+    cif_block_tp *block = NULL;
+    cif_loop_tp *loop;
+    cif_pktitr_tp *pktitr;
+    cif_packet_tp *packet;
+    cif_value_tp *value;
+    cif_value_tp *row[3] = { NULL, NULL, NULL };
+    cif_value_tp *first_values[3];
+    U_STRING_DECL(block_code, "block", 6);
+    UChar itemal[] = { '_', 'a', 0 };
+    UChar itembl[] = { '_', 'b', 0 };
+    UChar itemcl[] = { '_', 'c', 0 };
+    UChar text[] = { 't', 'e', 'x', 't', 0 };
+    UChar *item_names[4];
+    UChar **names;
+    UChar *text_out;
+    int index_a = -1;
+    int index_b = -1;
+    int index_c = -1;
+    int index;
+    int packet_num;
+    int mismatches;
+    double d;
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    U_STRING_INIT(block_code, "block", 6);
+
+    /* the items are deliberately not named in their ID order */
+    item_names[0] = itembl;
+    item_names[1] = itemcl;
+    item_names[2] = itemal;
+    item_names[3] = NULL;
+
+    CREATE_CIF(test_name, cif);
+    CREATE_BLOCK(test_name, cif, block_code, block);
+
+    TEST(cif_container_create_loop(block, NULL, item_names, &loop), CIF_OK, test_name, 1);
+
+    /* Each packet has _a = its number, _b = 'text', and _c unknown for even packets, else inapplicable */
+    TEST(cif_packet_create(&packet, item_names), CIF_OK, test_name, 2);
+    TEST(cif_packet_get_item(packet, itembl, &value), CIF_OK, test_name, 3);
+    TEST(cif_value_copy_char(value, text), CIF_OK, test_name, 4);
+    for (packet_num = 0; packet_num < NUM_PACKETS; packet_num += 1) {
+        TEST(cif_packet_get_item(packet, itemal, &value), CIF_OK, test_name, 5);
+        TEST(cif_value_init_numb(value, (double) packet_num, 0.0, 0, 1), CIF_OK, test_name, 6);
+        TEST(cif_packet_get_item(packet, itemcl, &value), CIF_OK, test_name, 7);
+        TEST(cif_value_init(value, (packet_num % 2) ? CIF_NA_KIND : CIF_UNK_KIND), CIF_OK, test_name, 8);
+        TEST(cif_loop_add_packet(loop, packet), CIF_OK, test_name, 9);
+    }
+    cif_packet_free(packet);
+
+    /* Determine the row positions of the items */
+    TEST(cif_loop_get_names(loop, &names), CIF_OK, test_name, 10);
+    for (index = 0; names[index] != NULL; index += 1) {
+        if (u_strcmp(names[index], itemal) == 0) {
+            index_a = index;
+        } else if (u_strcmp(names[index], itembl) == 0) {
+            index_b = index;
+        } else if (u_strcmp(names[index], itemcl) == 0) {
+            index_c = index;
+        }
+        free(names[index]);
+    }
+    free(names);
+    TEST(index, 3, test_name, 11);
+    TEST((index_a < 0) || (index_b < 0) || (index_c < 0), 0, test_name, 12);
+
+    /* Read the packets, reusing the same row */
+    TEST(cif_loop_get_packets(loop, &pktitr), CIF_OK, test_name, 13);
+    TEST(cif_pktitr_next_row(pktitr, NULL), CIF_ARGUMENT_ERROR, test_name, 14);
+    for (mismatches = 0, packet_num = 0; packet_num < NUM_PACKETS; packet_num += 1) {
+        TEST(cif_pktitr_next_row(pktitr, row), CIF_OK, test_name, 15 + 5 * packet_num);
+        if (packet_num == 0) {
+            first_values[0] = row[0];
+            first_values[1] = row[1];
+            first_values[2] = row[2];
+        } else {
+            mismatches += ((row[0] != first_values[0]) || (row[1] != first_values[1])
+                    || (row[2] != first_values[2]));
+        }
+        TEST(cif_value_get_number(row[index_a], &d), CIF_OK, test_name, 16 + 5 * packet_num);
+        TEST(d != (double) packet_num, 0, test_name, 17 + 5 * packet_num);
+        TEST(cif_value_get_text(row[index_b], &text_out), CIF_OK, test_name, 18 + 5 * packet_num);
+        mismatches += (u_strcmp(text_out, text) != 0);
+        free(text_out);
+        TEST(cif_value_kind(row[index_c]), (packet_num % 2) ? CIF_NA_KIND : CIF_UNK_KIND, test_name,
+                19 + 5 * packet_num);
+        if (packet_num == 1) {
+            /* the row's packet is the iterator's current packet */
+            TEST(cif_packet_create(&packet, NULL), CIF_OK, test_name, 40);
+            TEST(cif_packet_set_item(packet, itembl, NULL), CIF_OK, test_name, 41);
+            TEST(cif_pktitr_update_packet(pktitr, packet), CIF_OK, test_name, 42);
+            cif_packet_free(packet);
+        }
+    }
+    TEST(mismatches, 0, test_name, 43);
+    TEST(cif_pktitr_next_row(pktitr, row), CIF_FINISHED, test_name, 44);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 45);
+
+    /* Verify the update via packet iteration */
+    TEST(cif_loop_get_packets(loop, &pktitr), CIF_OK, test_name, 46);
+    for (mismatches = 0, packet_num = 0; packet_num < NUM_PACKETS; packet_num += 1) {
+        packet = NULL;
+        TEST(cif_pktitr_next_packet(pktitr, &packet), CIF_OK, test_name, 47 + 3 * packet_num);
+        TEST(cif_packet_get_item(packet, itemal, &value), CIF_OK, test_name, 48 + 3 * packet_num);
+        TEST(cif_value_get_number(value, &d), CIF_OK, test_name, 49 + 3 * packet_num);
+        TEST(cif_packet_get_item(packet, itembl, &value), CIF_OK, test_name, 60);
+        mismatches += ((cif_value_kind(value) == CIF_UNK_KIND) != (d == 1.0));
+        cif_packet_free(packet);
+    }
+    TEST(mismatches, 0, test_name, 61);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 62);
+
+    for (index = 0; index < 3; index += 1) {
+        cif_value_free(row[index]);
+    }
+    cif_loop_free(loop);
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+
+    return 0;
+}
@@ -0,0 +1,226 @@
+/*
+ * test_reader.c
+ *
+ * Tests reading CIFs as sequences of events, via cif_reader_open(), cif_reader_next(), and cif_reader_close().
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+#include "test.h"
+
+static int record_error(int code, size_t line, size_t column, const UChar *text, size_t length, void *data);
+static int text_differs(const UChar *text, size_t length, const char *expected);
+
+int main(void) {
+    char test_name[80] = "test_reader";
+    struct cif_parse_opts_s *options;
+    cif_reader_tp *reader = NULL;
+    cif_event_tp event;
+    FILE *stream;
+    size_t count;
+    int error_code = CIF_OK;
+    const char text[] = "#\\#CIF_2.0\ndata_a\n_x 1.5\n_y ?\n_z .\n_l [a [b c]]\n_t\n;line 1\nline 2\n;\n"
+            "save_f\n_q 'quoted'\nsave_\nloop_ _p _r\n1 2 3\n_w {'k':v}\ndata_b\n";
+    const char table_text[] = "#\\#CIF_2.0\ndata_c\n_u {'k1':v1 'k2':[v2]}\n";
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    /* Test erroneous arguments */
+    TEST(cif_reader_open(NULL, NULL, &reader), CIF_ARGUMENT_ERROR, test_name, 1);
+    TEST(cif_reader_next(NULL, &event), CIF_ARGUMENT_ERROR, test_name, 2);
+    TEST(cif_reader_close(NULL), CIF_OK, test_name, 3);
+
+    /* An empty stream yields no events */
+    stream = tmpfile();
+    TEST(stream == NULL, 0, test_name, 4);
+    TEST(cif_reader_open(stream, NULL, &reader), CIF_OK, test_name, 5);
+    TEST(cif_reader_next(reader, NULL), CIF_ARGUMENT_ERROR, test_name, 6);
+    TEST(cif_reader_next(reader, &event), CIF_FINISHED, test_name, 7);
+    TEST(cif_reader_close(reader), CIF_OK, test_name, 8);
+    fclose(stream);
+
+    stream = tmpfile();
+    TEST(stream == NULL, 0, test_name, 9);
+    TEST(fwrite(text, 1, strlen(text), stream) != strlen(text), 0, test_name, 10);
+    rewind(stream);
+
+    TEST(cif_parse_options_create(&options), CIF_OK, test_name, 11);
+    options->error_callback = record_error;
+    options->user_data = &error_code;
+    TEST(cif_reader_open(stream, options, &reader), CIF_OK, test_name, 12);
+    /* the options need not outlive the opening of the reader */
+    free(options);
+
+    /* Data block header */
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 13);
+    TEST(event.kind, CIF_BLOCK_EVENT, test_name, 14);
+    TEST(text_differs(event.name, u_strlen(event.name), "a"), 0, test_name, 15);
+
+    /* Simple values: unquoted text is presented as read, without numeric interpretation */
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 16);
+    TEST(event.kind, CIF_ITEM_EVENT, test_name, 17);
+    TEST(text_differs(event.name, u_strlen(event.name), "_x"), 0, test_name, 18);
+    TEST(event.value_kind, CIF_CHAR_KIND, test_name, 19);
+    TEST(event.quoted, CIF_NOT_QUOTED, test_name, 20);
+    TEST(text_differs(event.text, event.text_length, "1.5"), 0, test_name, 21);
+
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 22);
+    TEST(event.kind, CIF_ITEM_EVENT, test_name, 23);
+    TEST(text_differs(event.name, u_strlen(event.name), "_y"), 0, test_name, 24);
+    TEST(event.value_kind, CIF_UNK_KIND, test_name, 25);
+
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 26);
+    TEST(event.kind, CIF_ITEM_EVENT, test_name, 27);
+    TEST(text_differs(event.name, u_strlen(event.name), "_z"), 0, test_name, 28);
+    TEST(event.value_kind, CIF_NA_KIND, test_name, 29);
+
+    /* Lists are presented as value objects */
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 30);
+    TEST(event.kind, CIF_ITEM_EVENT, test_name, 31);
+    TEST(text_differs(event.name, u_strlen(event.name), "_l"), 0, test_name, 32);
+    TEST(event.value_kind, CIF_LIST_KIND, test_name, 33);
+    TEST(event.value == NULL, 0, test_name, 34);
+    TEST(cif_value_get_element_count(event.value, &count), CIF_OK, test_name, 35);
+    TEST(count, 2, test_name, 36);
+
+    /* Text fields are decoded */
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 37);
+    TEST(event.kind, CIF_ITEM_EVENT, test_name, 38);
+    TEST(text_differs(event.name, u_strlen(event.name), "_t"), 0, test_name, 39);
+    TEST(event.value_kind, CIF_CHAR_KIND, test_name, 40);
+    TEST(event.quoted, CIF_QUOTED, test_name, 41);
+    TEST(text_differs(event.text, event.text_length, "line 1\nline 2"), 0, test_name, 42);
+
+    /* Save frames are opened and closed */
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 43);
+    TEST(event.kind, CIF_FRAME_EVENT, test_name, 44);
+    TEST(text_differs(event.name, u_strlen(event.name), "f"), 0, test_name, 45);
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 46);
+    TEST(event.kind, CIF_ITEM_EVENT, test_name, 47);
+    TEST(text_differs(event.name, u_strlen(event.name), "_q"), 0, test_name, 48);
+    TEST(event.quoted, CIF_QUOTED, test_name, 49);
+    TEST(text_differs(event.text, event.text_length, "quoted"), 0, test_name, 50);
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 51);
+    TEST(event.kind, CIF_FRAME_END_EVENT, test_name, 52);
+
+    /* Loops present their header, then each packet's values in order */
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 53);
+    TEST(event.kind, CIF_LOOP_START_EVENT, test_name, 54);
+    TEST(event.item_names == NULL, 0, test_name, 55);
+    TEST(text_differs(event.item_names[0], u_strlen(event.item_names[0]), "_p"), 0, test_name, 56);
+    TEST(text_differs(event.item_names[1], u_strlen(event.item_names[1]), "_r"), 0, test_name, 57);
+    TEST(event.item_names[2] != NULL, 0, test_name, 58);
+
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 59);
+    TEST(event.kind, CIF_PACKET_EVENT, test_name, 60);
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 61);
+    TEST(event.kind, CIF_ITEM_EVENT, test_name, 62);
+    TEST(text_differs(event.name, u_strlen(event.name), "_p"), 0, test_name, 63);
+    TEST(text_differs(event.text, event.text_length, "1"), 0, test_name, 64);
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 65);
+    TEST(event.kind, CIF_ITEM_EVENT, test_name, 66);
+    TEST(text_differs(event.name, u_strlen(event.name), "_r"), 0, test_name, 67);
+    TEST(text_differs(event.text, event.text_length, "2"), 0, test_name, 68);
+
+    /* A partial final packet is completed with an unknown value */
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 69);
+    TEST(event.kind, CIF_PACKET_EVENT, test_name, 70);
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 71);
+    TEST(event.kind, CIF_ITEM_EVENT, test_name, 72);
+    TEST(text_differs(event.text, event.text_length, "3"), 0, test_name, 73);
+    TEST(error_code, CIF_OK, test_name, 74);
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 75);
+    TEST(error_code, CIF_PARTIAL_PACKET, test_name, 76);
+    TEST(event.kind, CIF_ITEM_EVENT, test_name, 77);
+    TEST(text_differs(event.name, u_strlen(event.name), "_r"), 0, test_name, 78);
+    TEST(event.value_kind, CIF_UNK_KIND, test_name, 79);
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 80);
+    TEST(event.kind, CIF_LOOP_END_EVENT, test_name, 81);
+
+    /* Items after a loop belong to the enclosing container; tables are presented as value objects */
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 82);
+    TEST(event.kind, CIF_ITEM_EVENT, test_name, 83);
+    TEST(text_differs(event.name, u_strlen(event.name), "_w"), 0, test_name, 84);
+    TEST(event.value_kind, CIF_TABLE_KIND, test_name, 85);
+    TEST(cif_value_get_element_count(event.value, &count), CIF_OK, test_name, 86);
+    TEST(count, 1, test_name, 87);
+
+    /* A data block ends where another begins */
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 88);
+    TEST(event.kind, CIF_BLOCK_EVENT, test_name, 89);
+    TEST(text_differs(event.name, u_strlen(event.name), "b"), 0, test_name, 90);
+
+    /* The end of the input is reported repeatedly */
+    TEST(cif_reader_next(reader, &event), CIF_FINISHED, test_name, 91);
+    TEST(cif_reader_next(reader, &event), CIF_FINISHED, test_name, 92);
+
+    /* clean up */
+    TEST(cif_reader_close(reader), CIF_OK, test_name, 93);
+    fclose(stream);
+
+    /* A table is presented correctly even when it is the first composite value read */
+    stream = tmpfile();
+    TEST(stream == NULL, 0, test_name, 94);
+    TEST(fwrite(table_text, 1, strlen(table_text), stream) != strlen(table_text), 0, test_name, 95);
+    rewind(stream);
+    TEST(cif_reader_open(stream, NULL, &reader), CIF_OK, test_name, 96);
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 97);
+    TEST(event.kind, CIF_BLOCK_EVENT, test_name, 98);
+    TEST(cif_reader_next(reader, &event), CIF_OK, test_name, 99);
+    TEST(event.kind, CIF_ITEM_EVENT, test_name, 100);
+    TEST(text_differs(event.name, u_strlen(event.name), "_u"), 0, test_name, 101);
+    TEST(event.value_kind, CIF_TABLE_KIND, test_name, 102);
+    TEST(event.value == NULL, 0, test_name, 103);
+    TEST(cif_value_kind(event.value), CIF_TABLE_KIND, test_name, 104);
+    TEST(cif_value_get_element_count(event.value, &count), CIF_OK, test_name, 105);
+    TEST(count, 2, test_name, 106);
+    TEST(cif_reader_next(reader, &event), CIF_FINISHED, test_name, 107);
+    TEST(cif_reader_close(reader), CIF_OK, test_name, 108);
+    fclose(stream);
+
+    return 0;
+}
+
+static int record_error(int code, size_t line UNUSED, size_t column UNUSED, const UChar *text UNUSED,
+        size_t length UNUSED, void *data) {
+    *((int *) data) = code;
+    return CIF_OK;
+}
+
+/* compares the specified Unicode text with the specified ASCII string; returns zero if they are equal */
+static int text_differs(const UChar *text, size_t length, const char *expected) {
+    size_t index;
+
+    if (length != strlen(expected)) {
+        return 1;
+    }
+    for (index = 0; index < length; index += 1) {
+        if (text[index] != (UChar) expected[index]) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
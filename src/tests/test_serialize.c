@@ -0,0 +1,117 @@
+/*
+ * test_serialize.c
+ *
+ * Tests recording managed CIFs as memory images via cif_serialize(), and restoring them via cif_deserialize().
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+
+#include "assert_cifs.h"
+#include "test.h"
+
+#define BUFFER_SIZE 512
+int main(void) {
+    char test_name[80] = "test_serialize";
+    char local_file_name[] = "cif_core.dic";
+    char file_name[BUFFER_SIZE];
+    FILE * cif_file;
+    struct cif_parse_opts_s *options;
+    cif_tp *cif = NULL;
+    cif_tp *cif_loaded = NULL;
+    cif_tp *cif_reloaded = NULL;
+    cif_block_tp *block = NULL;
+    unsigned char *image = NULL;
+    unsigned char *image2 = NULL;
+    size_t length = 0;
+    size_t length2 = 0;
+    int result;
+    U_STRING_DECL(block_code, "test_serialize_block", 21);
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+    U_STRING_INIT(block_code, "test_serialize_block", 21);
+
+    /* construct the test file name and open the file */
+    RESOLVE_DATADIR(file_name, BUFFER_SIZE - strlen(local_file_name));
+    TEST_NOT(file_name[0], 0, test_name, 1);
+    strcat(file_name, local_file_name);
+    cif_file = fopen(file_name, "rb");
+    TEST(cif_file == NULL, 0, test_name, 2);
+
+    /* parse a reference CIF */
+    TEST(cif_parse_options_create(&options), CIF_OK, test_name, 3);
+    options->max_frame_depth = -1;
+    TEST(cif_parse(cif_file, options, &cif), CIF_OK, test_name, 4);
+    free(options);
+
+    /* invalid arguments */
+    TEST(cif_serialize(NULL, &image, &length), CIF_ARGUMENT_ERROR, test_name, 5);
+    TEST(cif_serialize(cif, NULL, &length), CIF_ARGUMENT_ERROR, test_name, 6);
+    TEST(cif_serialize(cif, &image, NULL), CIF_ARGUMENT_ERROR, test_name, 7);
+    TEST(cif_deserialize(NULL, 0, &cif_loaded), CIF_ARGUMENT_ERROR, test_name, 8);
+
+    /* the SQLite library in use might have been built without serialization support */
+    result = cif_serialize(cif, &image, &length);
+    if (result == CIF_NOT_SUPPORTED) {
+        DESTROY_CIF(test_name, cif);
+        fclose(cif_file);
+        return SKIP;
+    }
+
+    /* serialize the CIF, restore it, and compare the result with the original */
+    TEST(result, CIF_OK, test_name, 9);
+    TEST(image == NULL, 0, test_name, 10);
+    TEST(length == 0, 0, test_name, 11);
+    TEST(cif_deserialize(image, length, NULL), CIF_ARGUMENT_ERROR, test_name, 12);
+    TEST(cif_deserialize(image, length, &cif_loaded), CIF_OK, test_name, 13);
+    TEST_NOT(assert_cifs_equal(cif, cif_loaded), 0, test_name, 14);
+
+    /* the restored CIF is independent of the image, and can be modified */
+    memset(image, 0, length);
+    TEST(cif_create_block(cif_loaded, block_code, &block), CIF_OK, test_name, 15);
+    TEST(cif_container_destroy(block), CIF_OK, test_name, 16);
+    TEST_NOT(assert_cifs_equal(cif, cif_loaded), 0, test_name, 17);
+
+    /* an image of the restored CIF can itself be restored */
+    TEST(cif_serialize(cif_loaded, &image2, &length2), CIF_OK, test_name, 18);
+    TEST(cif_deserialize(image2, length2, &cif_reloaded), CIF_OK, test_name, 19);
+    TEST_NOT(assert_cifs_equal(cif, cif_reloaded), 0, test_name, 20);
+    DESTROY_CIF(test_name, cif_reloaded);
+
+    /* images that are not CIF databases are rejected */
+    TEST(cif_deserialize(image, length, &cif_reloaded), CIF_ENVIRONMENT_ERROR, test_name, 21);
+    TEST(cif_deserialize(image, 0, &cif_reloaded), CIF_ENVIRONMENT_ERROR, test_name, 22);
+    TEST(cif_deserialize((const unsigned char *) file_name, strlen(file_name), &cif_reloaded), CIF_ENVIRONMENT_ERROR,
+            test_name, 23);
+
+    /* clean up */
+    free(image2);
+    free(image);
+    DESTROY_CIF(test_name, cif_loaded);
+    DESTROY_CIF(test_name, cif);
+    fclose(cif_file);  /* ignore any failure here */
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+/*
+ * test_transaction.c
+ *
+ * Tests grouping modifications to a managed CIF into user transactions via cif_begin(), cif_commit(), and
+ * cif_rollback().
+ *
+ * Copyright 2014, 2015 John C. Bollinger
+ *
+ *
+ * This file is part of the CIF API.
+ *
+ * The CIF API is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The CIF API is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with the CIF API.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unicode/ustring.h>
+#include "../cif.h"
+#include "test.h"
+
+int main(void) {
+    char test_name[80] = "test_transaction";
+    cif_tp *cif = NULL;
+    cif_block_tp *block = NULL;
+    cif_block_tp *block2 = NULL;
+    cif_loop_tp *loop;
+    cif_pktitr_tp *pktitr;
+    cif_pktitr_tp *pktitr2 = NULL;
+    cif_packet_tp *packet;
+    cif_packet_tp *packet2 = NULL;
+    cif_value_tp *value = NULL;
+    U_STRING_DECL(block_code, "block", 6);
+    U_STRING_DECL(block_code2, "block2", 7);
+    UChar item1l[] = { '_', 'i', 't', 'e', 'm', '1', 0 };
+    UChar item2l[] = { '_', 'i', 't', 'e', 'm', '2', 0 };
+    UChar item3l[] = { '_', 'i', 't', 'e', 'm', '3', 0 };
+    UChar *item_names[2];
+    double d;
+
+    /* Initialize data and prepare the test fixture */
+    TESTHEADER(test_name);
+
+    U_STRING_INIT(block_code, "block", 6);
+    U_STRING_INIT(block_code2, "block2", 7);
+
+    item_names[0] = item1l;
+    item_names[1] = NULL;
+
+    CREATE_CIF(test_name, cif);
+
+    /* Transactions must be properly paired */
+    TEST(cif_commit(cif), CIF_MISUSE, test_name, 1);
+    TEST(cif_rollback(cif), CIF_MISUSE, test_name, 2);
+    TEST(cif_begin(cif), CIF_OK, test_name, 3);
+    TEST(cif_begin(cif), CIF_MISUSE, test_name, 4);
+    TEST(cif_commit(cif), CIF_OK, test_name, 5);
+    TEST(cif_commit(cif), CIF_MISUSE, test_name, 6);
+
+    /* Rolled-back changes are discarded */
+    TEST(cif_begin(cif), CIF_OK, test_name, 7);
+    TEST(cif_create_block(cif, block_code, &block), CIF_OK, test_name, 8);
+    TEST(cif_container_set_value(block, item2l, NULL), CIF_OK, test_name, 9);
+    cif_block_free(block);
+    TEST(cif_rollback(cif), CIF_OK, test_name, 10);
+    TEST(cif_get_block(cif, block_code, NULL), CIF_NOSUCH_BLOCK, test_name, 11);
+
+    /* Committed changes are retained, and a failing function does not disturb the enclosing transaction */
+    TEST(cif_begin(cif), CIF_OK, test_name, 12);
+    TEST(cif_create_block(cif, block_code, &block), CIF_OK, test_name, 13);
+    TEST(cif_create_block(cif, block_code, &block2), CIF_DUP_BLOCKCODE, test_name, 14);
+    TEST(cif_container_create_loop(block, NULL, item_names, &loop), CIF_OK, test_name, 15);
+    TEST(cif_packet_create(&packet, item_names), CIF_OK, test_name, 16);
+    TEST(cif_packet_get_item(packet, item1l, &value), CIF_OK, test_name, 17);
+    cif_value_init_numb(value, 1.0, 0.0, 0, 1);
+    TEST(cif_loop_add_packet(loop, packet), CIF_OK, test_name, 18);
+    TEST(cif_commit(cif), CIF_OK, test_name, 19);
+    TEST(cif_get_block(cif, block_code, &block2), CIF_OK, test_name, 20);
+    value = NULL;
+    TEST(cif_container_get_value(block2, item1l, &value), CIF_OK, test_name, 21);
+    TEST(cif_value_get_number(value, &d), CIF_OK, test_name, 22);
+    TEST(d != 1.0, 0, test_name, 23);
+    cif_value_free(value);
+    cif_block_free(block2);
+
+    /* Loop items added in a rolled-back transaction are no longer recognized via existing loop handles */
+    TEST(cif_begin(cif), CIF_OK, test_name, 24);
+    TEST(cif_loop_add_item(loop, item3l, NULL), CIF_OK, test_name, 25);
+    TEST(cif_packet_set_item(packet, item3l, NULL), CIF_OK, test_name, 26);
+    TEST(cif_loop_add_packet(loop, packet), CIF_OK, test_name, 27);
+    TEST(cif_rollback(cif), CIF_OK, test_name, 28);
+    TEST(cif_loop_add_packet(loop, packet), CIF_WRONG_LOOP, test_name, 29);
+    TEST(cif_packet_remove_item(packet, item3l, NULL), CIF_OK, test_name, 30);
+
+    /* Packet iterators join the transaction, and must be closed before it ends */
+    TEST(cif_begin(cif), CIF_OK, test_name, 31);
+    TEST(cif_loop_add_packet(loop, packet), CIF_OK, test_name, 32);
+    TEST(cif_loop_get_packets(loop, &pktitr), CIF_OK, test_name, 33);
+    TEST(cif_commit(cif), CIF_MISUSE, test_name, 34);
+    TEST(cif_rollback(cif), CIF_MISUSE, test_name, 35);
+    TEST(cif_pktitr_next_packet(pktitr, NULL), CIF_OK, test_name, 36);
+    TEST(cif_pktitr_remove_packet(pktitr), CIF_OK, test_name, 37);
+    TEST(cif_pktitr_abort(pktitr), CIF_OK, test_name, 38);
+    TEST(cif_loop_get_packets(loop, &pktitr), CIF_OK, test_name, 39);
+    TEST(cif_pktitr_next_packet(pktitr, NULL), CIF_OK, test_name, 40);
+    TEST(cif_pktitr_remove_packet(pktitr), CIF_OK, test_name, 41);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 42);
+    TEST(cif_commit(cif), CIF_OK, test_name, 43);
+
+    /* one of the two packets was removed */
+    TEST(cif_loop_get_packets(loop, &pktitr), CIF_OK, test_name, 44);
+    TEST(cif_begin(cif), CIF_MISUSE, test_name, 45);
+    TEST(cif_pktitr_next_packet(pktitr, NULL), CIF_OK, test_name, 46);
+    TEST(cif_pktitr_next_packet(pktitr, NULL), CIF_FINISHED, test_name, 47);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 48);
+
+    /* Only one iterator may be open at a time, so that ending one cannot end another's savepoint */
+    TEST(cif_begin(cif), CIF_OK, test_name, 49);
+    TEST(cif_loop_get_packets(loop, &pktitr), CIF_OK, test_name, 50);
+    TEST(cif_loop_get_packets(loop, &pktitr2), CIF_MISUSE, test_name, 51);
+    TEST(cif_loop_get_packets_for(loop, item_names, &pktitr2), CIF_MISUSE, test_name, 52);
+    TEST(pktitr2 != NULL, 0, test_name, 53);
+    TEST(cif_pktitr_next_packet(pktitr, NULL), CIF_OK, test_name, 54);
+    TEST(cif_pktitr_remove_packet(pktitr), CIF_OK, test_name, 55);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 56);
+    TEST(cif_loop_add_packet(loop, packet), CIF_OK, test_name, 57);
+    TEST(cif_loop_get_packets(loop, &pktitr2), CIF_OK, test_name, 58);
+    TEST(cif_pktitr_abort(pktitr2), CIF_OK, test_name, 59);
+    TEST(cif_commit(cif), CIF_OK, test_name, 60);
+
+    /* the first iterator's removal and the later addition were both retained */
+    TEST(cif_loop_get_packets(loop, &pktitr), CIF_OK, test_name, 61);
+    TEST(cif_pktitr_next_packet(pktitr, &packet2), CIF_OK, test_name, 62);
+    TEST(cif_pktitr_next_packet(pktitr, NULL), CIF_FINISHED, test_name, 63);
+    TEST(cif_pktitr_close(pktitr), CIF_OK, test_name, 64);
+    TEST(cif_packet_get_item(packet2, item1l, &value), CIF_OK, test_name, 65);
+    TEST(cif_value_get_number(value, &d), CIF_OK, test_name, 66);
+    TEST(d != 1.0, 0, test_name, 67);
+    cif_packet_free(packet2);
+
+    /* Destroying the CIF rolls back any open transaction */
+    TEST(cif_begin(cif), CIF_OK, test_name, 68);
+
+    cif_packet_free(packet);
+    cif_loop_free(loop);
+    cif_block_free(block);
+    DESTROY_CIF(test_name, cif);
+
+    return 0;
+}
@@ -45,6 +45,13 @@ int main(void) {
     U_STRING_DECL(val_str2, "1742E+02", 9);
     U_STRING_DECL(val_str3, "1 ", 4);
     char test_name[80] = "test_value_get_number";
+    /* numbers whose conversion lies inside, at the edges of, and just beyond the range of exact fast conversion */
+    const char *numb_strings[] = {
+        "0.1", "-10.250", "3.14159265358979", "0.000012345", "1e22", "1e-22", "9007199254740992",
+        "9007199254740993", "123456e30", "1.5e38", "0.30000000000000004", "1e23", "7e-23",
+        "90071992547409.93", NULL
+    };
+    const char **numb_string;
     cif_value_tp *value;
     cif_value_tp *value2;
     UChar *tmp;
@@ -122,6 +129,47 @@ int main(void) {
     cif_value_free(value);
     cif_value_free(value2);
 
+    /* Test conversion accuracy; each of these should be converted to the nearest double, as by strtod() */
+    for (numb_string = numb_strings; *numb_string; numb_string += 1) {
+        int subtest = 43 + 5 * (int) (numb_string - numb_strings);
+        size_t len = strlen(*numb_string);
+
+        tmp = (UChar *) malloc((len + 1) * sizeof(UChar));
+        TEST(tmp == NULL, 0, test_name, subtest);
+        u_uastrcpy(tmp, *numb_string);
+        TEST(cif_value_create(CIF_UNK_KIND, &value), CIF_OK, test_name, subtest + 1);
+        TEST(cif_value_parse_numb(value, tmp), CIF_OK, test_name, subtest + 2); /* responsibility for tmp passes */
+        TEST(cif_value_get_number(value, &d), CIF_OK, test_name, subtest + 3);
+        TEST(d != strtod(*numb_string, NULL), 0, test_name, subtest + 4);
+        cif_value_free(value);
+    }
+
+    /* Test that the number and su reflect changes to the value after they have been computed once */
+    TEST(cif_value_create(CIF_UNK_KIND, &value), CIF_OK, test_name, 110);
+    TEST(cif_value_init_numb(value, 1.5, 0.25, 2, 5), CIF_OK, test_name, 111);
+    TEST(cif_value_get_number(value, &d), CIF_OK, test_name, 112);
+    TEST(d != 1.5, 0, test_name, 113);
+    TEST(cif_value_get_su(value, &d), CIF_OK, test_name, 114);
+    TEST(d != 0.25, 0, test_name, 115);
+    TEST(cif_value_init_numb(value, -2.75, 0.5, 2, 5), CIF_OK, test_name, 116);
+    TEST(cif_value_get_number(value, &d), CIF_OK, test_name, 117);
+    TEST(d != -2.75, 0, test_name, 118);
+    TEST(cif_value_get_su(value, &d), CIF_OK, test_name, 119);
+    TEST(d != 0.5, 0, test_name, 120);
+    value2 = NULL;
+    TEST(cif_value_clone(value, &value2), CIF_OK, test_name, 121);
+    TEST(cif_value_get_number(value2, &d), CIF_OK, test_name, 122);
+    TEST(d != -2.75, 0, test_name, 123);
+    tmp = u_strdup(val_str2);
+    TEST(tmp == NULL, 0, test_name, 124);
+    TEST(cif_value_parse_numb(value, tmp), CIF_OK, test_name, 125); /* responsibility for tmp passes to value */
+    TEST(cif_value_get_number(value, &d), CIF_OK, test_name, 126);
+    TEST(d != 174200.0, 0, test_name, 127);
+    TEST(cif_value_get_su(value, &d), CIF_OK, test_name, 128);
+    TEST(d != 0.0, 0, test_name, 129);
+    cif_value_free(value);
+    cif_value_free(value2);
+
     return 0;
 }
 
@@ -81,6 +81,40 @@ int fegetround(void);
  */
 #define DEFAULT_MAX_LEAD_ZEROES 5
 
+/**
+ * @brief The floating-point evaluation method in effect, as C99's @c FLT_EVAL_METHOD would express it, or -1 if
+ * it cannot be determined.
+ */
+#if defined(FLT_EVAL_METHOD)
+#define CIF_FLT_EVAL_METHOD FLT_EVAL_METHOD
+#elif defined(__FLT_EVAL_METHOD__)
+#define CIF_FLT_EVAL_METHOD __FLT_EVAL_METHOD__
+#else
+#define CIF_FLT_EVAL_METHOD (-1)
+#endif
+
+/**
+ * @brief Defined if type @c double is an IEEE-754 binary64 whose arithmetic is evaluated in that format, so that a
+ * single multiplication or division of exactly-represented operands is correctly rounded.
+ */
+#if (FLT_RADIX == 2) && (DBL_MANT_DIG == 53) && (CIF_FLT_EVAL_METHOD == 0)
+#define EXACT_DOUBLE_ARITHMETIC
+#endif
+
+/**
+ * @brief The largest power of ten that is exactly representable as a @c double , and the largest number of
+ * significand digits that may form an integer not exceeding 2^53, for use by @c to_double_fast() .
+ */
+#define MAX_EXACT_POWER_OF_TEN 22
+#define MAX_EXACT_DIGITS 16
+
+/**
+ * @brief The largest scale handled by @c to_digits_fast() , chosen so that the product of a double's integer mantissa
+ * and the corresponding power of five fits in 128 bits; and the size of the digit buffer it requires.
+ */
+#define MAX_FAST_DIGITS_SCALE 22
+#define FAST_DIGITS_BUFFER_SIZE 21
+
 /**
  * @brief Determines the index of the most significant decimal digit of the argument.
  *
@@ -428,6 +462,22 @@ static int cif_table_deserialize(struct table_value_s *table, read_buffer_tp *bu
  */
 static char *to_digits(double d, int scale);
 
+/**
+ * @brief produces the same digit string as @c to_digits() would do, via fixed-width integer arithmetic, for the
+ *     common combinations of value and scale for which that is possible.
+ *
+ * The value is scaled by the requested power of ten exactly, as a 128-bit integer product of its binary mantissa and
+ * a power of five, and then rounded by a single shift.  Only positive values, non-negative scales up to
+ * @c MAX_FAST_DIGITS_SCALE , results that are nonzero and fit in 64 bits, and the round-to-nearest mode are handled.
+ *
+ * @param[in] d the double value for which a digit string representation is requested; must be positive and finite
+ * @param[in] scale the index of the least-significant decimal digit in the result string, as for @c to_digits()
+ * @param[out] buffer a buffer of at least @c FAST_DIGITS_BUFFER_SIZE characters in which to record the digit string
+ * @return nonzero if the digit string was recorded in @p buffer , or zero if the caller must fall back to
+ *     @c to_digits()
+ */
+static int to_digits_fast(double d, int scale, char *buffer);
+
 /**
  * @brief produces an appropriately-rounded type-double representation of the specified digit string, as interpreted
  *     scale according to the specified scale.
@@ -448,6 +498,23 @@ static char *to_digits(double d, int scale);
  */
 static double to_double(const char *ddigits, int scale);
 
+/**
+ * @brief computes the @c double value represented by the specified digit string and scale exactly, if that is
+ *     possible with a single correctly-rounded floating-point operation.
+ *
+ * This is Clinger's fast path: when the significant digits, as an integer, and the needed power of ten are both
+ * exactly representable then their product or quotient is the correctly-rounded result.  It covers most numbers
+ * that appear in practice, and is much cheaper than the general algorithm of @c to_double() .
+ *
+ * @param[in] ddigits a C string containing the decimal digits to convert, from most- to least-significant, without
+ *         leading zeroes; must contain at least one digit
+ * @param[in] scale the number of digits in @p ddigits that follow the implied decimal point, as for @c to_double()
+ * @param[out] result the location where the result should be recorded if the fast path applies
+ * @return nonzero if the fast path applied and a result has been recorded, or zero if the caller must fall back to
+ *         the general algorithm
+ */
+static int to_double_fast(const char *ddigits, int scale, double *result);
+
 /**
  * @brief Formats the text representation of a number value, in plain decimal form
  *
@@ -591,6 +658,9 @@ static int cif_value_clone_numb(struct numb_value_s *value, struct numb_value_s
             /* all needed allocations are successful; copy the rest of the properties */
             clone->sign = value->sign;
             clone->scale = value->scale;
+            clone->d_value = value->d_value;
+            clone->d_su = value->d_su;
+            clone->cached = value->cached;
             clone->kind = CIF_NUMB_KIND;
             clone->quoted = value->quoted;
 
@@ -1142,8 +1212,121 @@ static uintmax_t round_to_int(uintmax_t round_value, uint32_t *digits, int units
     return round_value + ((lsd < work_digit) ? 0 : round_it(0, 0, *work_digit, work_digit, lsd));
 }
 
+/*
+ * Computes the full 128-bit product of two 64-bit unsigned integers.
+ */
+static void multiply_64(uint64_t a, uint64_t b, uint64_t *high, uint64_t *low) {
+    const uint64_t mask = (((uint64_t) 1) << 32) - 1;
+    uint64_t a_lo = a & mask;
+    uint64_t a_hi = a >> 32;
+    uint64_t b_lo = b & mask;
+    uint64_t b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo;
+    uint64_t hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi;
+    uint64_t cross = (lo_lo >> 32) + (hi_lo & mask) + lo_hi;
+
+    *low = (cross << 32) | (lo_lo & mask);
+    *high = (a_hi * b_hi) + (hi_lo >> 32) + (cross >> 32);
+}
+
+static int to_digits_fast(double d, int scale, char *buffer) {
+#if (FLT_RADIX == 2) && (DBL_MANT_DIG <= 53)
+    uint64_t mantissa;
+    uint64_t power_of_five = 1;
+    uint64_t high;
+    uint64_t low;
+    uint64_t rounded;
+    char digits[FAST_DIGITS_BUFFER_SIZE];
+    char *digit;
+    int exponent;
+    int shift;
+    int i;
+
+#ifdef HAVE_FEGETROUND
+    /* only the default rounding mode is handled here */
+    if (fegetround() != FE_TONEAREST) {
+        return 0;
+    }
+#endif
+    if ((scale < 0) || (scale > MAX_FAST_DIGITS_SCALE)) {
+        return 0;
+    }
+
+    /* d == mantissa * 2^exponent, exactly; assumes frexp() and ldexp() introduce no rounding error */
+    mantissa = (uint64_t) ldexp(frexp(d, &exponent), DBL_MANT_DIG);
+    exponent -= DBL_MANT_DIG;
+
+    /* d * 10^scale == (mantissa * 5^scale) * 2^(exponent + scale), where the product needs at most 105 bits */
+    for (i = 0; i < scale; i += 1) {
+        power_of_five *= 5;
+    }
+    multiply_64(mantissa, power_of_five, &high, &low);
+    shift = -(exponent + scale);
+
+    if (shift <= 0) {
+        /* the scaled value is an integer, which must fit in 64 bits */
+        if ((high != 0) || (shift <= -64) || ((shift < 0) && ((low >> (64 + shift)) != 0))) {
+            return 0;
+        }
+        rounded = low << -shift;
+    } else {
+        /* divide by 2^shift, keeping the round bit and noting whether any bits below it are set */
+        int round_bit;
+        int sticky;
+
+        if (shift < 64) {
+            if ((high >> shift) != 0) {
+                return 0;
+            }
+            rounded = (high << (64 - shift)) | (low >> shift);
+            round_bit = (int) ((low >> (shift - 1)) & 1);
+            sticky = ((low & ((((uint64_t) 1) << (shift - 1)) - 1)) != 0);
+        } else if (shift < 128) {
+            rounded = (shift == 64) ? high : (high >> (shift - 64));
+            if (shift == 64) {
+                round_bit = (int) (low >> 63);
+                sticky = ((low << 1) != 0);
+            } else {
+                round_bit = (int) ((high >> (shift - 65)) & 1);
+                sticky = ((low != 0) || ((high & ((((uint64_t) 1) << (shift - 65)) - 1)) != 0));
+            }
+        } else {
+            return 0;
+        }
+
+        /* round half to even */
+        if (round_bit && (sticky || (rounded & 1))) {
+            rounded += 1;
+            if (rounded == 0) {
+                return 0;
+            }
+        }
+    }
+
+    if (rounded == 0) {
+        /* leave the representation of values that round to zero to the general algorithm */
+        return 0;
+    }
+
+    /* generate the digits, least-significant first; assumes the 'C' locale or one sufficiently similar */
+    digit = digits + FAST_DIGITS_BUFFER_SIZE;
+    *(--digit) = '\0';
+    do {
+        *(--digit) = (char) ('0' + (int) (rounded % 10));
+        rounded /= 10;
+    } while (rounded > 0);
+    memcpy(buffer, digit, (digits + FAST_DIGITS_BUFFER_SIZE) - digit);
+
+    return 1;
+#else
+    return 0;
+#endif
+}
+
 static char *to_digits(double d, int scale) {
     int negative;
+    char fast_digits[FAST_DIGITS_BUFFER_SIZE];
 
     if (d < 0) {
         negative = 1;
@@ -1154,6 +1337,8 @@ static char *to_digits(double d, int scale) {
 
     if (d == 0.0) {
         return strdup("0");
+    } else if (to_digits_fast(d, scale, fast_digits)) {
+        return strdup(fast_digits);
     } else {
         uint32_t digits[DIG_PER_DBL + 1];
 
@@ -1349,14 +1534,75 @@ static char *to_digits(double d, int scale) {
     }
 }
 
+static int to_double_fast(const char *ddigits, int scale, double *result) {
+#ifdef EXACT_DOUBLE_ARITHMETIC
+    static const double powers_of_ten[MAX_EXACT_POWER_OF_TEN + 1] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    /* 2^53, the limit of the integers exactly representable in an IEEE double */
+    const uint64_t max_exact_integer = ((uint64_t) 1) << 53;
+    const char *end;
+    int exponent = -scale;
+    /* accumulated as an integer, because accumulating in a double would round before the range check */
+    uint64_t significand = 0;
+
+    /* ignore trailing zeroes, adjusting the exponent instead */
+    for (end = ddigits; *end != '\0'; end += 1) ;
+    while (*(end - 1) == '0') {
+        end -= 1;
+        exponent += 1;
+    }
+
+    if ((end - ddigits) > MAX_EXACT_DIGITS) {
+        return 0;
+    }
+    for (; ddigits < end; ddigits += 1) {
+        significand = (significand * 10) + (uint64_t) (*ddigits - '0');
+    }
+    if (significand > max_exact_integer) {
+        return 0;
+    }
+
+    if (exponent < 0) {
+        if (exponent < -MAX_EXACT_POWER_OF_TEN) {
+            return 0;
+        }
+        *result = (double) significand / powers_of_ten[-exponent];
+    } else {
+        if (exponent > MAX_EXACT_POWER_OF_TEN) {
+            /* a small significand may absorb part of a large exponent exactly */
+            if (exponent > MAX_EXACT_POWER_OF_TEN + MAX_EXACT_DIGITS) {
+                return 0;
+            }
+            for (; exponent > MAX_EXACT_POWER_OF_TEN; exponent -= 1) {
+                if (significand > max_exact_integer / 10) {
+                    return 0;
+                }
+                significand *= 10;
+            }
+        }
+        *result = (double) significand * powers_of_ten[exponent];
+    }
+
+    return 1;
+#else
+    return 0;
+#endif
+}
+
 /* FIXME: parts of the following assume DBL_MANT_DIG is not more than 64 and that FLT_RADIX is 2 */
 static double to_double(const char *ddigits, int scale) {
+    double fast_result;
+
     /* skip leading zeroes: */
     while (*ddigits == '0') ddigits++;
 
     if (*ddigits == '\0') {
         /* all digits are zero */
         return 0.0;
+    } else if (to_double_fast(ddigits, scale, &fast_result)) {
+        return fast_result;
     } else {
         /* the least-significant decimal place in the input */
         int lsp = -scale;
@@ -2127,6 +2373,7 @@ int cif_value_parse_numb(cif_value_tp *n, UChar *text) {
         numb->digits = n_temp.digits;
         numb->su_digits = n_temp.su_digits;
         numb->scale = n_temp.scale;
+        numb->cached = 0;
 
         return CIF_OK;
     }
@@ -2230,6 +2477,7 @@ int cif_value_init_numb(cif_value_tp *n, double val, double su, int scale, int m
                     numb->digits = digit_buf;
                     numb->su_digits = su_buf;
                     numb->scale = scale;
+                    numb->cached = 0;
 
                     /* restore the original locale */
                     setlocale(LC_NUMERIC, locale);
@@ -2436,12 +2684,20 @@ int cif_value_get_number(cif_value_tp *n, double *val) {
     }
 
     numb = &(n->as_numb);
-    d = to_double(numb->digits, numb->scale);
-    *val = ((numb->sign < 0) ? -d : d);
+    if (!(numb->cached & NUMB_VALUE_CACHED)) {
+        d = to_double(numb->digits, numb->scale);
+        numb->d_value = ((numb->sign < 0) ? -d : d);
+        numb->cached |= NUMB_VALUE_CACHED;
+    }
+    *val = numb->d_value;
 
     return CIF_OK;
 }
 
+double cif_digits_to_double(const char *digits, int scale) {
+    return to_double(digits, scale);
+}
+
 int cif_value_get_su(cif_value_tp *n, double *su) {
     struct numb_value_s *numb;
 
@@ -2457,9 +2713,13 @@ int cif_value_get_su(cif_value_tp *n, double *su) {
     }
 
     numb = &(n->as_numb);
-    *su = (numb->su_digits == NULL)
-            ? 0.0
-            : to_double(numb->su_digits, numb->scale);
+    if (!(numb->cached & NUMB_SU_CACHED)) {
+        numb->d_su = (numb->su_digits == NULL)
+                ? 0.0
+                : to_double(numb->su_digits, numb->scale);
+        numb->cached |= NUMB_SU_CACHED;
+    }
+    *su = numb->d_su;
 
     return CIF_OK;
 }